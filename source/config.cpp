@@ -29,6 +29,7 @@ namespace Config
 	creator<Glass::DisplayServer, EventQueue &>::pointer const DisplayServer =
 		creator<Glass::DisplayServer>::impl<X11XCB_DisplayServer>::create;
 
+	// Set to nullptr for no input listener.  It isn't started when the display server handles the input bindings itself.
 	creator<Glass::InputListener, EventQueue &>::pointer const InputListener =
 		creator<Glass::InputListener>::impl<X11XCB_InputListener>::create;
 
@@ -38,6 +39,20 @@ namespace Config
 
 	// Implementation settings ================================================
 
+	#ifdef GLASS_DISPLAYSERVER_X11XCB_DISPLAYSERVER
+		// Grab the input bindings on the display server's own connection and look them up in its event loop, instead of
+		// in a separate input listener.  Input then reaches the window manager through one socket and one thread, in order
+		// with everything else.  The InputListener isn't started while this is on, as only one connection can grab the bindings.
+		// Either way, bound input is timed from when it's read off the X connection, so the latencies of the bound commands
+		// dumped on SIGUSR1 compare the two setups.
+		bool const DisplayServerInputBindings = false;
+
+		// Draw decorations into images in memory shared with the X server, so each finished frame crosses the socket as one
+		// small request instead of every fill and glyph being sent.  Ignored where the server can't share memory with us.
+		bool const DisplayServerSharedMemory = true;
+	#endif
+
+
 	#ifdef GLASS_INPUTLISTENER_X11XCB_INPUTLISTENER
 		// User input bindings
 		namespace Keys
@@ -46,38 +61,38 @@ namespace Config
 			Input::Modifier const CommandModifier = Input::Modifier::SUPER;
 		}
 
-		std::vector<std::pair<Event const *, Input>> const InputBindings = {
+		std::vector<std::pair<EventRecord, Input>> const InputBindings = {
 
-			{ new WindowClose_Event,										 Input(Input::Type::KEYBOARD, Input::Value::KEY_Q,		Keys::CommandModifier) },
+			{ WindowClose_Event(),										 Input(Input::Type::KEYBOARD, Input::Value::KEY_Q,		Keys::CommandModifier) },
 
-			{ new FloatingToggle_Event,										 Input(Input::Type::KEYBOARD, Input::Value::KEY_RETURN, Keys::CommandModifier) },
-			{ new FloatingRaise_Event,										 Input(Input::Type::KEYBOARD, Keys::CommandKey,			Input::Modifier::NONE) },
-			{ new SwitchTabbed_Event,										 Input(Input::Type::KEYBOARD, Input::Value::KEY_TAB,	Keys::CommandModifier) },
+			{ FloatingToggle_Event(),									 Input(Input::Type::KEYBOARD, Input::Value::KEY_RETURN, Keys::CommandModifier) },
+			{ FloatingRaise_Event(),									 Input(Input::Type::KEYBOARD, Keys::CommandKey,			Input::Modifier::NONE) },
+			{ SwitchTabbed_Event(),										 Input(Input::Type::KEYBOARD, Input::Value::KEY_TAB,	Keys::CommandModifier) },
 
-			{ new FocusCycle_Event(FocusCycle_Event::Direction::LEFT),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_LEFT,	Keys::CommandModifier) },
-			{ new FocusCycle_Event(FocusCycle_Event::Direction::RIGHT),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_RIGHT,	Keys::CommandModifier) },
+			{ FocusCycle_Event(FocusCycle_Event::Direction::LEFT),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_LEFT,	Keys::CommandModifier) },
+			{ FocusCycle_Event(FocusCycle_Event::Direction::RIGHT),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_RIGHT,	Keys::CommandModifier) },
 
-			{ new LevelToggle_Event(LevelToggle_Event::Mode::RAISE),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_UP,		Keys::CommandModifier) },
-			{ new LevelToggle_Event(LevelToggle_Event::Mode::LOWER),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_DOWN,	Keys::CommandModifier) },
+			{ LevelToggle_Event(LevelToggle_Event::Mode::RAISE),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_UP,		Keys::CommandModifier) },
+			{ LevelToggle_Event(LevelToggle_Event::Mode::LOWER),		 Input(Input::Type::KEYBOARD, Input::Value::KEY_DOWN,	Keys::CommandModifier) },
 
-			{ new LayoutCycle_Event(LayoutCycle_Event::Direction::FORWARD),	 Input(Input::Type::KEYBOARD, Input::Value::KEY_RIGHT,	Keys::CommandModifier | Input::Modifier::CONTROL) },
-			{ new LayoutCycle_Event(LayoutCycle_Event::Direction::BACKWARD), Input(Input::Type::KEYBOARD, Input::Value::KEY_LEFT,	Keys::CommandModifier | Input::Modifier::CONTROL) },
+			{ LayoutCycle_Event(LayoutCycle_Event::Direction::FORWARD),	 Input(Input::Type::KEYBOARD, Input::Value::KEY_RIGHT,	Keys::CommandModifier | Input::Modifier::CONTROL) },
+			{ LayoutCycle_Event(LayoutCycle_Event::Direction::BACKWARD), Input(Input::Type::KEYBOARD, Input::Value::KEY_LEFT,	Keys::CommandModifier | Input::Modifier::CONTROL) },
 
-			{ new SpawnCommand_Event({ "xterm" }),							 Input(Input::Type::KEYBOARD, Input::Value::KEY_T,		Keys::CommandModifier) },
-			{ new SpawnCommand_Event({ "gedit" }),							 Input(Input::Type::KEYBOARD, Input::Value::KEY_E,		Keys::CommandModifier) },
-			{ new SpawnCommand_Event({ "firefox" }),						 Input(Input::Type::KEYBOARD, Input::Value::KEY_B,		Keys::CommandModifier) },
-			{ new SpawnCommand_Event({ "dbus-launch", "thunar" }),			 Input(Input::Type::KEYBOARD, Input::Value::KEY_F,		Keys::CommandModifier) },
-			{ new SpawnCommand_Event({ "dmenu_run" }),						 Input(Input::Type::KEYBOARD, Input::Value::KEY_SPACE,	Keys::CommandModifier) },
+			{ SpawnCommand_Event({ "xterm" }),							 Input(Input::Type::KEYBOARD, Input::Value::KEY_T,		Keys::CommandModifier) },
+			{ SpawnCommand_Event({ "gedit" }),							 Input(Input::Type::KEYBOARD, Input::Value::KEY_E,		Keys::CommandModifier) },
+			{ SpawnCommand_Event({ "firefox" }),						 Input(Input::Type::KEYBOARD, Input::Value::KEY_B,		Keys::CommandModifier) },
+			{ SpawnCommand_Event({ "dbus-launch", "thunar" }),			 Input(Input::Type::KEYBOARD, Input::Value::KEY_F,		Keys::CommandModifier) },
+			{ SpawnCommand_Event({ "dmenu_run" }),						 Input(Input::Type::KEYBOARD, Input::Value::KEY_SPACE,	Keys::CommandModifier) },
 
-			{ new FullscreenToggle_Event,									 Input(Input::Type::KEYBOARD, Input::Value::KEY_M,		Keys::CommandModifier) },
+			{ FullscreenToggle_Event(),									 Input(Input::Type::KEYBOARD, Input::Value::KEY_M,		Keys::CommandModifier) },
 
-			{ new ManagerQuit_Event,										 Input(Input::Type::KEYBOARD, Input::Value::KEY_Q,		Keys::CommandModifier | Input::Modifier::SHIFT) },
+			{ ManagerQuit_Event(),										 Input(Input::Type::KEYBOARD, Input::Value::KEY_Q,		Keys::CommandModifier | Input::Modifier::SHIFT) },
 
 
 			// Modal move/resize keys
 			#define MODAL_KEY(EventType, InputType, InputValue, InputModifier) \
-			{ new EventType(WindowModal_Event::Mode::BEGIN), Input(InputType, InputValue, InputModifier, Input::State::PRESSED) },\
-			{ new EventType(WindowModal_Event::Mode::END),	 Input(InputType, InputValue, InputModifier, Input::State::RELEASED) }
+			{ EventType(WindowModal_Event::Mode::BEGIN), Input(InputType, InputValue, InputModifier, Input::State::PRESSED) },\
+			{ EventType(WindowModal_Event::Mode::END),	 Input(InputType, InputValue, InputModifier, Input::State::RELEASED) }
 
 			MODAL_KEY(WindowMoveModal_Event,   Input::Type::MOUSE, Input::Value::BUTTON_1, Keys::CommandModifier),
 			MODAL_KEY(WindowResizeModal_Event, Input::Type::MOUSE, Input::Value::BUTTON_3, Keys::CommandModifier),
@@ -91,10 +106,10 @@ namespace Config
 			#define TAG_CLIENT_MODIFIER Input::Modifier::CONTROL
 
 			#define TAG_KEY(TagNumber, InputType, InputValue) \
-			{ new TagDisplay_Event(TagDisplay_Event::Target::ROOT,	 TagDisplay_Event::Mode::SET,	 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER) },\
-			{ new TagDisplay_Event(TagDisplay_Event::Target::ROOT,	 TagDisplay_Event::Mode::TOGGLE, 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_TOGGLE_MODIFIER) },\
-			{ new TagDisplay_Event(TagDisplay_Event::Target::CLIENT, TagDisplay_Event::Mode::SET,	 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_CLIENT_MODIFIER) },\
-			{ new TagDisplay_Event(TagDisplay_Event::Target::CLIENT, TagDisplay_Event::Mode::TOGGLE, 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_TOGGLE_MODIFIER | TAG_CLIENT_MODIFIER) }
+			{ TagDisplay_Event(TagDisplay_Event::Target::ROOT,	 TagDisplay_Event::Mode::SET,	 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER) },\
+			{ TagDisplay_Event(TagDisplay_Event::Target::ROOT,	 TagDisplay_Event::Mode::TOGGLE, 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_TOGGLE_MODIFIER) },\
+			{ TagDisplay_Event(TagDisplay_Event::Target::CLIENT, TagDisplay_Event::Mode::SET,	 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_CLIENT_MODIFIER) },\
+			{ TagDisplay_Event(TagDisplay_Event::Target::CLIENT, TagDisplay_Event::Mode::TOGGLE, 0x01 << TagNumber), Input(InputType, InputValue, TAG_MODIFIER | TAG_TOGGLE_MODIFIER | TAG_CLIENT_MODIFIER) }
 
 			TAG_KEY(0, Input::Type::KEYBOARD, Input::Value::KEY_1),
 			TAG_KEY(1, Input::Type::KEYBOARD, Input::Value::KEY_2),
@@ -170,5 +185,20 @@ namespace Config
 		std::vector<Dynamic_WindowManager::Rule> const ClientRules = {
 			{ { new Class_Condition("Steam") }, { new Floating_Effect(true) } }
 		};
+
+
+		// Event batching - Waiting events are handled together, with a single display server sync per batch.
+		// A batch ends after this many events, or once it has run for this many milliseconds.
+		unsigned short const EventBatchSize = 64;
+		unsigned short const EventBatchTime = 8;
 	#endif
+
+
+	// Diagnostics ============================================================
+
+	// Flight recorder - The most recent events are kept in this file, which can be played back with glass-replay.
+	// The capacity is in events; each takes 64 bytes.  Leave the path empty to disable recording.  A relative path is
+	// placed in $XDG_RUNTIME_DIR, or in a directory in /tmp private to the user.
+	std::string const  FlightRecorderPath = "glass-flightrecorder";
+	unsigned int const FlightRecorderCapacity = 65536;
 }
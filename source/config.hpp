@@ -20,6 +20,7 @@
 #ifndef GLASS_CONFIGURATION
 #define GLASS_CONFIGURATION
 
+#include <string>
 #include <vector>
 
 #include "glass/core/Color.hpp"
@@ -59,8 +60,14 @@ namespace Config
 
 	// Implementation settings ================================================
 
+	#ifdef GLASS_DISPLAYSERVER_X11XCB_DISPLAYSERVER
+		extern bool const DisplayServerInputBindings;
+		extern bool const DisplayServerSharedMemory;
+	#endif
+
+
 	#ifdef GLASS_INPUTLISTENER_X11XCB_INPUTLISTENER
-		extern std::vector<std::pair<Event const *, Input>> const InputBindings;
+		extern std::vector<std::pair<EventRecord, Input>> const InputBindings;
 	#endif
 
 
@@ -90,7 +97,16 @@ namespace Config
 		extern std::vector<std::string> const TagNames;
 
 		extern std::vector<Dynamic_WindowManager::Rule> const ClientRules;
+
+		extern unsigned short const EventBatchSize;
+		extern unsigned short const EventBatchTime;
 	#endif
+
+
+	// Diagnostics ============================================================
+
+	extern std::string const  FlightRecorderPath;
+	extern unsigned int const FlightRecorderCapacity;
 }
 
 #endif
@@ -20,7 +20,11 @@
 #ifndef GLASS_CORE_EVENT
 #define GLASS_CORE_EVENT
 
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "glass/core/Input.hpp"
@@ -29,6 +33,10 @@
 
 namespace Glass
 {
+	// Events are plain values, and almost all of them are trivially copyable.  The few that carry something of unbounded
+	// size, like a window name, share it through a std::shared_ptr made when the event is, so copying them never
+	// allocates and the value is freed along with the last copy.  See EventRecord below for how they're stored.
+
 	struct Event
 	{
 		enum class Type { // Server
@@ -59,24 +67,59 @@ namespace Glass
 						  TAG_DISPLAY,
 						  MANAGER_QUIT };
 
-		virtual ~Event() { }
-
-		virtual Type GetType() const = 0;
+		static size_t const TypeCount = static_cast<size_t>(Type::MANAGER_QUIT) + 1;
+
+		Type GetType() const { return this->EventType; }
+
+		static char const *GetTypeName(Type Value)
+		{
+			static char const * const Names[] = { "Root Create",
+												  "Client Create",
+												  "Client Destroy",
+												  "Client Geometry Change Request",
+												  "Client Iconified Request",
+												  "Client Urgency Change",
+												  "Client Fullscreen Request",
+												  "Primary Name Change",
+												  "Pointer Move",
+												  "Window Enter",
+												  "Input",
+												  "Window Move Modal",
+												  "Window Resize Modal",
+												  "Window Close",
+												  "Floating Toggle",
+												  "Floating Raise",
+												  "Switch Tabbed",
+												  "Focus Cycle",
+												  "Level Toggle",
+												  "Layout Cycle",
+												  "Spawn Command",
+												  "Fullscreen Toggle",
+												  "Tag Display",
+												  "Manager Quit" };
+
+			static_assert(sizeof(Names) / sizeof(Names[0]) == TypeCount, "Every event type needs a name");
+
+			return Names[static_cast<size_t>(Value)];
+		}
+
+	protected:
+		Event(Type EventType) :
+			EventType(EventType)
+		{ }
 
-		virtual Event *Copy() const = 0;
+	private:
+		Type EventType;
 	};
 
 
 	struct RootCreate_Event : public Event
 	{
 		RootCreate_Event(Glass::RootWindow &RootWindow) :
+			Event(Type::ROOT_CREATE),
 			RootWindow(RootWindow)
 		{ }
 
-		Type GetType() const { return Type::ROOT_CREATE; }
-
-		Event *Copy() const { return new RootCreate_Event(this->RootWindow); }
-
 		Glass::RootWindow &RootWindow;
 	};
 
@@ -84,16 +127,11 @@ namespace Glass
 	struct Client_Event : public Event
 	{
 		Client_Event(Glass::ClientWindow &ClientWindow, Event::Type Type) :
-			ClientWindow(ClientWindow),
-			Type(Type)
+			Event(Type),
+			ClientWindow(ClientWindow)
 		{ }
 
-		Event::Type GetType() const { return this->Type; }
-
 		Glass::ClientWindow &ClientWindow;
-
-	private:
-		Event::Type const Type;
 	};
 
 
@@ -102,8 +140,6 @@ namespace Glass
 		ClientCreate_Event(Glass::ClientWindow &ClientWindow) :
 			Client_Event(ClientWindow, Event::Type::CLIENT_CREATE)
 		{ }
-
-		Event *Copy() const { return new ClientCreate_Event(this->ClientWindow); }
 	};
 
 
@@ -112,8 +148,6 @@ namespace Glass
 		ClientDestroy_Event(Glass::ClientWindow &ClientWindow) :
 			Client_Event(ClientWindow, Event::Type::CLIENT_DESTROY)
 		{ }
-
-		Event *Copy() const { return new ClientDestroy_Event(this->ClientWindow); }
 	};
 
 
@@ -133,9 +167,6 @@ namespace Glass
 			Size(Size)
 		{ }
 
-		Event *Copy() const { return new ClientGeometryChangeRequest_Event(this->ClientWindow, this->ValueMask, this->Position,
-																												this->Size); }
-
 		unsigned char ValueMask;
 		Vector const  Position;
 		Vector const  Size;
@@ -149,8 +180,6 @@ namespace Glass
 			State(State)
 		{ }
 
-		Event *Copy() const { return new ClientIconifiedRequest_Event(this->ClientWindow, this->State); }
-
 		bool const State;
 	};
 
@@ -162,8 +191,6 @@ namespace Glass
 			State(State)
 		{ }
 
-		Event *Copy() const { return new ClientUrgencyChange_Event(this->ClientWindow, this->State); }
-
 		bool const State;
 	};
 
@@ -179,8 +206,6 @@ namespace Glass
 			EventMode(EventMode)
 		{ }
 
-		Event *Copy() const { return new ClientFullscreenRequest_Event(this->ClientWindow, this->EventMode); }
-
 		Mode const EventMode;
 	};
 
@@ -188,29 +213,23 @@ namespace Glass
 	struct PrimaryNameChange_Event : public Event
 	{
 		PrimaryNameChange_Event(Glass::PrimaryWindow &PrimaryWindow, std::string const &NewName) :
+			Event(Type::PRIMARY_NAME_CHANGE),
 			PrimaryWindow(PrimaryWindow),
-			NewName(NewName)
+			NewName(std::make_shared<std::string const>(NewName))
 		{ }
 
-		Type GetType() const { return Type::PRIMARY_NAME_CHANGE; }
-
-		Event *Copy() const { return new PrimaryNameChange_Event(this->PrimaryWindow, this->NewName); }
-
-		Glass::PrimaryWindow &PrimaryWindow;
-		std::string const NewName;
+		Glass::PrimaryWindow					   &PrimaryWindow;
+		std::shared_ptr<std::string const> const	NewName;
 	};
 
 
 	struct PointerMove_Event : public Event
 	{
 		PointerMove_Event(Vector const &Position) :
+			Event(Type::POINTER_MOVE),
 			Position(Position)
 		{ }
 
-		Type GetType() const { return Type::POINTER_MOVE; }
-
-		Event *Copy() const { return new PointerMove_Event(this->Position); }
-
 		Vector const Position;
 	};
 
@@ -218,14 +237,11 @@ namespace Glass
 	struct WindowEnter_Event : public Event
 	{
 		WindowEnter_Event(Glass::Window &Window, Vector const &Position) :
+			Event(Type::WINDOW_ENTER),
 			Window(Window),
 			Position(Position)
 		{ }
 
-		Type GetType() const { return Type::WINDOW_ENTER; }
-
-		Event *Copy() const { return new WindowEnter_Event(this->Window, this->Position); }
-
 		Glass::Window  &Window;
 		Vector const	Position;
 	};
@@ -234,15 +250,12 @@ namespace Glass
 	struct Input_Event : public Event
 	{
 		Input_Event(Glass::Window &Window, Glass::Input const &Input, Vector const &Position) :
+			Event(Type::INPUT),
 			Window(Window),
 			Input(Input),
 			Position(Position)
 		{ }
 
-		Type GetType() const { return Type::INPUT; }
-
-		Event *Copy() const { return new Input_Event(this->Window, this->Input, this->Position); }
-
 		Glass::Window	   &Window;
 		Glass::Input const	Input;
 		Vector const		Position;
@@ -252,13 +265,8 @@ namespace Glass
 	struct UserCommand_Event : public Event
 	{
 		UserCommand_Event(Event::Type Type) :
-			Type(Type)
+			Event(Type)
 		{ }
-
-		Event::Type GetType() const { return this->Type; }
-
-	private:
-		Event::Type const Type;
 	};
 
 
@@ -281,8 +289,6 @@ namespace Glass
 		WindowMoveModal_Event(WindowModal_Event::Mode Mode) :
 			WindowModal_Event(Event::Type::WINDOW_MOVE_MODAL, Mode)
 		{ }
-
-		Event *Copy() const { return new WindowMoveModal_Event(this->EventMode); }
 	};
 
 
@@ -291,8 +297,6 @@ namespace Glass
 		WindowResizeModal_Event(WindowModal_Event::Mode Mode) :
 			WindowModal_Event(Event::Type::WINDOW_RESIZE_MODAL, Mode)
 		{ }
-
-		Event *Copy() const { return new WindowResizeModal_Event(this->EventMode); }
 	};
 
 
@@ -301,8 +305,6 @@ namespace Glass
 		WindowClose_Event() :
 			UserCommand_Event(Event::Type::WINDOW_CLOSE)
 		{ }
-
-		Event *Copy() const { return new WindowClose_Event; }
 	};
 
 
@@ -311,8 +313,6 @@ namespace Glass
 		FloatingToggle_Event() :
 			UserCommand_Event(Event::Type::FLOATING_TOGGLE)
 		{ }
-
-		Event *Copy() const { return new FloatingToggle_Event; }
 	};
 
 
@@ -321,8 +321,6 @@ namespace Glass
 		FloatingRaise_Event() :
 			UserCommand_Event(Event::Type::FLOATING_RAISE)
 		{ }
-
-		Event *Copy() const { return new FloatingRaise_Event; }
 	};
 
 
@@ -331,8 +329,6 @@ namespace Glass
 		SwitchTabbed_Event() :
 			UserCommand_Event(Event::Type::SWITCH_TABBED)
 		{ }
-
-		Event *Copy() const { return new SwitchTabbed_Event; }
 	};
 
 
@@ -346,8 +342,6 @@ namespace Glass
 			CycleDirection(CycleDirection)
 		{ }
 
-		Event *Copy() const { return new FocusCycle_Event(this->CycleDirection); }
-
 		Direction const CycleDirection;
 	};
 
@@ -362,8 +356,6 @@ namespace Glass
 			EventMode(EventMode)
 		{ }
 
-		Event *Copy() const { return new LevelToggle_Event(this->EventMode); }
-
 		Mode const EventMode;
 	};
 
@@ -378,8 +370,6 @@ namespace Glass
 			CycleDirection(CycleDirection)
 		{ }
 
-		Event *Copy() const { return new LayoutCycle_Event(this->CycleDirection); }
-
 		Direction const CycleDirection;
 	};
 
@@ -388,12 +378,10 @@ namespace Glass
 	{
 		SpawnCommand_Event(std::vector<std::string> const &Command) :
 			UserCommand_Event(Event::Type::SPAWN_COMMAND),
-			Command(Command)
+			Command(std::make_shared<std::vector<std::string> const>(Command))
 		{ }
 
-		Event *Copy() const { return new SpawnCommand_Event(this->Command); }
-
-		std::vector<std::string> const Command;
+		std::shared_ptr<std::vector<std::string> const> const Command;
 	};
 
 
@@ -402,8 +390,6 @@ namespace Glass
 		FullscreenToggle_Event() :
 			UserCommand_Event(Event::Type::FULLSCREEN_TOGGLE)
 		{ }
-
-		Event *Copy() const { return new FullscreenToggle_Event; }
 	};
 
 
@@ -424,8 +410,6 @@ namespace Glass
 			EventTagMask(EventTagMask)
 		{ }
 
-		Event *Copy() const { return new TagDisplay_Event(this->EventTarget, this->EventMode, this->EventTagMask); }
-
 		Target const  EventTarget;
 		Mode const	  EventMode;
 		TagMask const EventTagMask;
@@ -437,9 +421,156 @@ namespace Glass
 		ManagerQuit_Event() :
 			UserCommand_Event(Event::Type::MANAGER_QUIT)
 		{ }
+	};
+
+
+	// Fixed-size container that holds any event by value, so events can be queued and copied without allocating.
+	// Events don't have virtual functions and only use single inheritance, so the Event base sits at the start of the storage.
+	// EventQueue stamps each record with its place in the queue's order and the time it arrived (see EventQueue::SetArrivalTime).
+	//
+	// Trivially copyable events are copied bytewise.  The others get a manager that copies and destroys them properly,
+	// which for the shared values they hold only means adjusting a reference count.
+
+	class EventRecord
+	{
+	public:
+		// The largest event, Input_Event, takes 40 bytes; the rest is room for events to grow
+		static size_t const StorageSize = 48;
+
+
+		EventRecord() :
+			Manager(nullptr),
+			Sequence(0),
+			Time(0)
+		{ }
+
+
+		template <typename T>
+		EventRecord(T const &Event) :
+			Manager(std::is_trivially_copyable<T>::value ? nullptr : &EventRecord::Manage<T>),
+			Sequence(0),
+			Time(0)
+		{
+			static_assert(std::is_base_of<Glass::Event, T>::value,				"EventRecord can only hold events");
+			static_assert(std::is_nothrow_copy_constructible<T>::value,			"Copying an event must not throw");
+			static_assert(sizeof(T) <= sizeof(EventRecord::Storage),			"Event is too large for EventRecord");
+			static_assert(alignof(T) <= alignof(decltype(EventRecord::Storage)),	"Event is too strictly aligned for EventRecord");
+
+			new (&this->Storage) T(Event);
+		}
+
+
+		EventRecord(EventRecord const &Other) :
+			Manager(Other.Manager),
+			Sequence(Other.Sequence),
+			Time(Other.Time)
+		{
+			this->CopyStorage(Other);
+		}
+
+
+		// Leaves Other empty, so whatever its event shared is let go of now rather than whenever Other is overwritten
+		EventRecord(EventRecord &&Other) :
+			EventRecord(static_cast<EventRecord const &>(Other))
+		{
+			Other.Release();
+		}
+
+
+		~EventRecord()
+		{
+			this->Release();
+		}
+
+
+		EventRecord &operator=(EventRecord const &Other)
+		{
+			if (this == &Other)
+				return *this;
+
+			this->Release();
+
+			this->Manager = Other.Manager;
+			this->Sequence = Other.Sequence;
+			this->Time = Other.Time;
+
+			this->CopyStorage(Other);
+
+			return *this;
+		}
+
 
-		Event *Copy() const { return new ManagerQuit_Event; }
+		EventRecord &operator=(EventRecord &&Other)
+		{
+			if (this == &Other)
+				return *this;
+
+			*this = static_cast<EventRecord const &>(Other);
+			Other.Release();
+
+			return *this;
+		}
+
+
+		Glass::Event const &operator*() const
+		{
+			return *this->operator->();
+		}
+
+
+		Glass::Event const *operator->() const
+		{
+			return reinterpret_cast<Glass::Event const *>(&this->Storage);
+		}
+
+		uint64_t GetSequence() const	{ return this->Sequence; }
+		uint64_t GetTime() const		{ return this->Time; } // Nanoseconds on the steady clock
+
+	private:
+		friend class EventQueue;
+
+		// Copies Source's event into Destination's storage, or destroys Destination's event if Source is nullptr
+		typedef void (*ManagerFunction)(EventRecord *Destination, EventRecord const *Source);
+
+		template <typename T>
+		static void Manage(EventRecord *Destination, EventRecord const *Source)
+		{
+			if (Source != nullptr)
+				new (&Destination->Storage) T(*reinterpret_cast<T const *>(&Source->Storage));
+			else
+				reinterpret_cast<T *>(&Destination->Storage)->~T();
+		}
+
+
+		void Release()
+		{
+			if (this->Manager != nullptr)
+				this->Manager(this, nullptr);
+
+			this->Manager = nullptr;
+		}
+
+
+		void CopyStorage(EventRecord const &Other)
+		{
+			if (this->Manager != nullptr)
+				this->Manager(this, &Other);
+			else
+				this->Storage = Other.Storage;
+		}
+
+		std::aligned_storage<StorageSize, alignof(void *)>::type Storage;
+		ManagerFunction Manager;
+
+		uint64_t Sequence;
+		uint64_t Time;
 	};
+
+
+	// Checked here as well as where events are recorded, so an event that outgrows the storage fails at its definition
+	static_assert(sizeof(Input_Event) <= EventRecord::StorageSize,						"Input_Event is too large for EventRecord");
+	static_assert(sizeof(ClientGeometryChangeRequest_Event) <= EventRecord::StorageSize,	"ClientGeometryChangeRequest_Event is too large for EventRecord");
+	static_assert(sizeof(PrimaryNameChange_Event) <= EventRecord::StorageSize,			"PrimaryNameChange_Event is too large for EventRecord");
 }
 
 #endif
@@ -17,32 +17,303 @@
 * Copyright 2014-2015 Chris Foster
 */
 
-#include <condition_variable>
-#include <mutex>
-#include <queue>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include "glass/core/Event.hpp"
 #include "glass/core/EventQueue.hpp"
+#include "glass/core/FlightRecorder.hpp"
+#include "glass/core/Log.hpp"
+#include "util/timestamp.hpp"
 
 using namespace Glass;
 
-struct EventQueue::Implementation
+// Bounded multi-producer, single-consumer ring.  Each cell carries a sequence number that tells
+// producers and the consumer whose turn it is to touch it, so neither side ever takes a lock.
+
+namespace
 {
-	~Implementation()
+	struct Ring
+	{
+		static size_t const Capacity = 1024; // Must be a power of two
+
+		struct Cell
+		{
+			std::atomic<size_t>	Sequence;
+			EventRecord			Value;
+		};
+
+		Ring();
+
+		bool				Push(EventRecord const &Event);
+		bool				Pop(EventRecord &Event);
+		EventRecord const  *Peek() const; // The event Pop would return, or nullptr
+		EventRecord const  *PeekAt(size_t Position) const; // The event at Position, Tail or later, once it's been published
+		bool				IsEmpty() const;
+
+		Cell				Cells[Capacity];
+
+		// Padded onto separate cache lines, as producers and the consumer hammer them from different threads
+		std::atomic<size_t>	Head;
+		char				HeadPadding[64 - sizeof(std::atomic<size_t>)];
+		size_t				Tail;
+		char				TailPadding[64 - sizeof(size_t)];
+	};
+
+
+	Ring::Ring() :
+		Head(0),
+		Tail(0)
 	{
-		while (!this->Events.empty())
+		for (size_t i = 0; i < Capacity; i++)
+			this->Cells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+
+	bool Ring::Push(EventRecord const &Event)
+	{
+		size_t Position = this->Head.load(std::memory_order_relaxed);
+
+		while (true)
 		{
-			delete this->Events.front();
-			this->Events.pop();
+			Cell &Cell = this->Cells[Position & (Capacity - 1)];
+			size_t const Sequence = Cell.Sequence.load(std::memory_order_acquire);
+			intptr_t const Difference = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+
+			if (Difference == 0)
+			{
+				// The cell is free; try to claim it
+				if (this->Head.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					Cell.Value = Event;
+					Cell.Sequence.store(Position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (Difference < 0)
+				return false; // Full
+			else
+				Position = this->Head.load(std::memory_order_relaxed);
 		}
 	}
 
-	std::queue<Event const *>	Events;
-	std::mutex					EventsMutex;
-	std::condition_variable		EventAdded;
+
+	bool Ring::Pop(EventRecord &Event)
+	{
+		Cell &Cell = this->Cells[this->Tail & (Capacity - 1)];
+		size_t const Sequence = Cell.Sequence.load(std::memory_order_acquire);
+
+		if (Sequence != this->Tail + 1)
+			return false; // Empty, or the producer hasn't finished writing the cell yet
+
+		Event = std::move(Cell.Value);
+		Cell.Sequence.store(this->Tail + Capacity, std::memory_order_release);
+		this->Tail++;
+
+		return true;
+	}
+
+
+	EventRecord const *Ring::Peek() const
+	{
+		return this->PeekAt(this->Tail);
+	}
+
+
+	EventRecord const *Ring::PeekAt(size_t Position) const
+	{
+		Cell const &Cell = this->Cells[Position & (Capacity - 1)];
+
+		if (Cell.Sequence.load(std::memory_order_acquire) != Position + 1)
+			return nullptr;
+
+		return &Cell.Value;
+	}
+
+
+	bool Ring::IsEmpty() const
+	{
+		Cell const &Cell = this->Cells[this->Tail & (Capacity - 1)];
+
+		return Cell.Sequence.load(std::memory_order_acquire) != this->Tail + 1;
+	}
+}
+
+
+// Set by SetArrivalTime; zero means events are stamped when they're added
+static thread_local uint64_t LocalArrivalTime = 0;
+
+
+// Events are split into lanes by priority, each of which is FIFO.  User commands, input and pointer motion go
+// in the urgent lane, so a flood of server bookkeeping can't hold them up.  Between the lanes, events still
+// keep the order they were queued in where it matters:
+//  - Commands and input act on the focus or on a window, so they wait for windows entered or created before them.
+//  - A ClientDestroy_Event frees its window, so it never goes ahead of an urgent event queued before it.
+
+struct EventQueue::Implementation
+{
+	enum Lane { URGENT,
+				NORMAL,
+				LANE_COUNT };
+
+	// After this many urgent events in a row, a waiting normal event goes next
+	static unsigned int const MaxUrgentStreak = 16;
+
+	Implementation();
+	~Implementation();
+
+	static Lane GetLane(Event::Type Type);
+	static bool IsBarrier(Event::Type Type);	// Urgent events that act on windows wait for these
+	static bool IsWaiting(Event::Type Type);	// Those urgent events
+
+	void NoteBarriers();
+	bool Pop(EventRecord &Event);
+
+	void Wake();
+	void Sleep();
+
+	Ring					Lanes[LANE_COUNT];
+	unsigned int			UrgentStreak;
+
+	// The sequences of the barriers published in the normal lane, oldest first.  Only the consumer touches these, noting
+	// barriers as it finds them in the ring and dropping them as they're popped.
+	uint64_t				Barriers[Ring::Capacity];
+	size_t					BarriersBegin;
+	size_t					BarriersEnd;
+	size_t					BarriersScanned; // The normal lane's position up to which barriers have been noted
+
+	std::atomic<uint64_t>	NextSequence;
+	FlightRecorder		   *Recorder;
+
+	// Set by the consumer before it blocks, so producers only pay for a wakeup when one is needed
+	std::atomic_bool		Sleeping;
+	int						WakeDescriptor;
 };
 
 
+EventQueue::Implementation::Implementation() :
+	UrgentStreak(0),
+	BarriersBegin(0),
+	BarriersEnd(0),
+	BarriersScanned(0),
+	NextSequence(1),
+	Recorder(nullptr),
+	Sleeping(false),
+	WakeDescriptor(eventfd(0, EFD_CLOEXEC))
+{
+	if (this->WakeDescriptor < 0)
+		LOG_ERROR << "Could not create an eventfd for the event queue!" << std::endl;
+}
+
+
+EventQueue::Implementation::~Implementation()
+{
+	if (this->WakeDescriptor >= 0)
+		close(this->WakeDescriptor);
+}
+
+
+EventQueue::Implementation::Lane EventQueue::Implementation::GetLane(Event::Type Type)
+{
+	if (Type == Event::Type::POINTER_MOVE || IsWaiting(Type))
+		return URGENT;
+
+	return NORMAL;
+}
+
+
+bool EventQueue::Implementation::IsBarrier(Event::Type Type)
+{
+	return Type == Event::Type::WINDOW_ENTER || Type == Event::Type::CLIENT_CREATE;
+}
+
+
+bool EventQueue::Implementation::IsWaiting(Event::Type Type)
+{
+	return Type == Event::Type::INPUT || Type >= Event::Type::WINDOW_MOVE_MODAL;
+}
+
+
+void EventQueue::Implementation::NoteBarriers()
+{
+	Ring const &Normal = this->Lanes[NORMAL];
+
+	// Stops at the first cell a producer hasn't finished with; it's noted on a later pop
+	while (EventRecord const * const Event = Normal.PeekAt(this->BarriersScanned))
+	{
+		if (IsBarrier((*Event)->GetType()))
+			this->Barriers[this->BarriersEnd++ & (Ring::Capacity - 1)] = Event->GetSequence();
+
+		this->BarriersScanned++;
+	}
+}
+
+
+bool EventQueue::Implementation::Pop(EventRecord &Event)
+{
+	this->NoteBarriers();
+
+	EventRecord const * const Urgent = this->Lanes[URGENT].Peek();
+	EventRecord const * const Normal = this->Lanes[NORMAL].Peek();
+
+	bool UrgentFirst = Normal == nullptr || (Urgent != nullptr && this->UrgentStreak < MaxUrgentStreak);
+
+	if (Urgent != nullptr && Normal != nullptr)
+	{
+		bool const BarrierWaiting = this->BarriersBegin != this->BarriersEnd &&
+									this->Barriers[this->BarriersBegin & (Ring::Capacity - 1)] < Urgent->GetSequence();
+
+		if (IsWaiting((*Urgent)->GetType()) && BarrierWaiting)
+			UrgentFirst = false;
+		else if ((*Normal)->GetType() == Event::Type::CLIENT_DESTROY && Normal->GetSequence() > Urgent->GetSequence())
+			UrgentFirst = true;
+	}
+
+	if (UrgentFirst)
+	{
+		if (!this->Lanes[URGENT].Pop(Event))
+			return false;
+
+		this->UrgentStreak++;
+		return true;
+	}
+
+	this->Lanes[NORMAL].Pop(Event);
+	this->UrgentStreak = 0;
+
+	// The normal lane is popped in the order it was scanned, so this is the oldest barrier noted
+	if (IsBarrier(Event->GetType()))
+		this->BarriersBegin++;
+
+	return true;
+}
+
+
+void EventQueue::Implementation::Wake()
+{
+	// Pairs with the fence in DrainEvents, so either we see the consumer sleeping or it sees our event
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!this->Sleeping.exchange(false))
+		return;
+
+	uint64_t const Value = 1;
+	while (write(this->WakeDescriptor, &Value, sizeof(Value)) < 0 && errno == EINTR);
+}
+
+
+void EventQueue::Implementation::Sleep()
+{
+	uint64_t Value;
+	while (read(this->WakeDescriptor, &Value, sizeof(Value)) < 0 && errno == EINTR);
+}
+
+
 EventQueue::EventQueue() :
 	Data(new Implementation)
 {
@@ -64,48 +335,101 @@ EventQueue::~EventQueue()
 }
 
 
-void EventQueue::AddEvent(Event const &Event)
+void EventQueue::AddEvent(EventRecord const &Event)
 {
-	{
-		std::unique_lock<std::mutex> Lock(this->Data->EventsMutex);
+	EventRecord Stamped(Event);
+	Stamped.Sequence = this->Data->NextSequence.fetch_add(1, std::memory_order_relaxed);
+	Stamped.Time = LocalArrivalTime != 0 ? LocalArrivalTime : timestamp();
 
-		this->Data->Events.push(&Event);
-	}
+	// Before the event is published, while anything it refers to is still only in the producer's hands
+	if (this->Data->Recorder != nullptr)
+		this->Data->Recorder->RecordEnqueued(Stamped);
+
+	Ring &Lane = this->Data->Lanes[Implementation::GetLane(Event->GetType())];
 
-	this->Data->EventAdded.notify_one();
+	// Never drop events; if the consumer has fallen this far behind, wait for it to catch up
+	while (!Lane.Push(Stamped))
+		std::this_thread::yield();
+
+	this->Data->Wake();
 }
 
 
 bool EventQueue::IsEmpty() const
 {
-	std::unique_lock<std::mutex> Lock(this->Data->EventsMutex);
+	for (auto const &Lane : this->Data->Lanes)
+		if (!Lane.IsEmpty())
+			return false;
 
-	return this->Data->Events.empty();
+	return true;
 }
 
 
-Event const *EventQueue::PollForEvent()
+bool EventQueue::PollForEvent(EventRecord &Event)
 {
-	std::unique_lock<std::mutex> Lock(this->Data->EventsMutex);
+	return this->Data->Pop(Event);
+}
 
-	if (this->Data->Events.empty())
-		return nullptr;
 
-	Event const *NextEvent = this->Data->Events.front();
-	this->Data->Events.pop();
+EventRecord EventQueue::WaitForEvent()
+{
+	EventRecord NextEvent;
+
+	this->DrainEvents(&NextEvent, 1);
 
 	return NextEvent;
 }
 
 
-Event const *EventQueue::WaitForEvent()
+size_t EventQueue::DrainEvents(EventRecord *Events, size_t MaxEvents)
 {
-	std::unique_lock<std::mutex> Lock(this->Data->EventsMutex);
+	size_t Count = 0;
 
-	this->Data->EventAdded.wait(Lock, [this]{ return !this->Data->Events.empty(); });
+	while (Count == 0)
+	{
+		while (Count < MaxEvents && this->Data->Pop(Events[Count]))
+		{
+			// A newer pointer position replaces one still waiting directly before it
+			if (Count > 0 && Events[Count]->GetType() == Event::Type::POINTER_MOVE &&
+							 Events[Count - 1]->GetType() == Event::Type::POINTER_MOVE)
+				Events[Count - 1] = Events[Count];
+			else
+				Count++;
+		}
 
-	Event const *NextEvent = this->Data->Events.front();
-	this->Data->Events.pop();
+		if (Count > 0)
+			break;
 
-	return NextEvent;
+		this->Data->Sleeping.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		// Check again, in case an event arrived before the producer could see us sleeping
+		if (this->Data->Pop(Events[Count]))
+		{
+			this->Data->Sleeping.store(false);
+			Count++;
+		}
+		else
+			this->Data->Sleep();
+	}
+
+	return Count;
+}
+
+
+void EventQueue::SetArrivalTime(uint64_t Time)
+{
+	LocalArrivalTime = Time;
+}
+
+
+void EventQueue::SetRecorder(FlightRecorder *Recorder)
+{
+	this->Data->Recorder = Recorder;
+}
+
+
+FlightRecorder *EventQueue::GetRecorder() const
+{
+	return this->Data->Recorder;
 }
@@ -20,11 +20,17 @@
 #ifndef GLASS_CORE_EVENTQUEUE
 #define GLASS_CORE_EVENTQUEUE
 
+#include <cstddef>
+#include <cstdint>
+
 namespace Glass
 {
-	class Event;
+	class EventRecord;
+	class FlightRecorder;
 
-	// FIFO queue for events
+	// Lock-free queue for events.  Any number of threads may add events, but only one may remove them.
+	// Events are copied into the queue by value, so adding and removing them never allocates.
+	// User commands and pointer motion are removed ahead of other events; order is kept within each group.
 
 	class EventQueue
 	{
@@ -35,14 +41,24 @@ namespace Glass
 
 		~EventQueue();
 
-		// EventQueue takes ownership of added events
-		void			AddEvent(Event const &Add);
+		void			AddEvent(EventRecord const &Add);
 
 		bool			IsEmpty() const;
 
-		// EventQueue gives ownership of returned events
-		Event const	   *WaitForEvent();
-		Event const	   *PollForEvent();
+		EventRecord		WaitForEvent();
+		bool			PollForEvent(EventRecord &Event);
+
+		// Waits for at least one event, then removes up to MaxEvents events into Events and returns how many were removed.
+		// Back-to-back pointer moves are merged into the newest one.
+		size_t			DrainEvents(EventRecord *Events, size_t MaxEvents);
+
+		// Events this thread adds from now on are stamped as having arrived at Time, a util/timestamp.hpp timestamp,
+		// instead of when they're added.  Display servers call this when they receive something that becomes events.
+		static void		SetArrivalTime(uint64_t Time);
+
+		// Every event added from then on is written to Recorder, if it isn't nullptr.  Set this before any events are added.
+		void			SetRecorder(FlightRecorder *Recorder);
+		FlightRecorder *GetRecorder() const;
 
 	private:
 		struct Implementation;
@@ -0,0 +1,410 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <stdio.h> // rename
+#include <stdlib.h> // getenv, mkostemp
+#include <string.h> // memcmp, memcpy, memset, strerror
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "glass/core/Event.hpp"
+#include "glass/core/FlightRecorder.hpp"
+#include "glass/core/Log.hpp"
+
+using namespace Glass;
+
+static_assert(sizeof(FlightRecorder::Record) == 64, "Flight recorder records should fill exactly one cache line");
+static_assert(std::numeric_limits<decltype(Vector::x)>::min() >= std::numeric_limits<int16_t>::min() &&
+			  std::numeric_limits<decltype(Vector::x)>::max() <= std::numeric_limits<int16_t>::max(), "Records hold positions and sizes in 16 bits");
+
+namespace
+{
+	char const	   Magic[8] = { 'G', 'L', 'A', 'S', 'S', 'F', 'R', '\0' };
+	uint32_t const Version = 1;
+
+
+	bool RecordOrder(FlightRecorder::Record const &A, FlightRecorder::Record const &B)
+	{
+		if (A.Sequence != B.Sequence)
+			return A.Sequence < B.Sequence;
+
+		return A.Kind < B.Kind;
+	}
+}
+
+
+// Start of the file, followed by Capacity records
+struct FlightRecorder::Header
+{
+	char					Magic[8];
+	uint32_t				Version;
+	uint32_t				RecordSize;
+	uint64_t				Capacity;
+	std::atomic<uint64_t>	WriteIndex; // Total records ever written; the next one goes in slot WriteIndex % Capacity
+	char					Padding[32];
+};
+
+
+std::string FlightRecorder::ResolvePath(std::string const &Path)
+{
+	if (Path.empty() || Path[0] == '/')
+		return Path;
+
+	char const * const RuntimeDirectory = getenv("XDG_RUNTIME_DIR");
+	if (RuntimeDirectory != nullptr && RuntimeDirectory[0] == '/')
+		return std::string(RuntimeDirectory) + "/" + Path;
+
+	std::string const Directory = "/tmp/glass-" + std::to_string(getuid());
+
+	// Anyone can create it first, so make sure it's a real directory that's ours alone
+	struct stat DirectoryStatus;
+	if ((mkdir(Directory.c_str(), 0700) != 0 && errno != EEXIST) ||
+		lstat(Directory.c_str(), &DirectoryStatus) != 0 ||
+		!S_ISDIR(DirectoryStatus.st_mode) || DirectoryStatus.st_uid != getuid() || (DirectoryStatus.st_mode & 077) != 0)
+	{
+		LOG_ERROR << "\"" << Directory << "\" is not a private directory!" << std::endl;
+		return std::string();
+	}
+
+	return Directory + "/" + Path;
+}
+
+
+FlightRecorder::FlightRecorder(std::string const &Path, size_t Capacity) :
+	Mapping(nullptr),
+	Records(nullptr),
+	Capacity(std::max<size_t>(Capacity, 1)),
+	MappingSize(sizeof(Header) + this->Capacity * sizeof(Record))
+{
+	// The recording is made in a new file of our own, which then replaces whatever is at Path.  Opening Path itself could
+	// follow a link someone else left there.
+	std::string TemporaryPath = Path + ".XXXXXX";
+
+	int const File = mkostemp(&TemporaryPath[0], O_CLOEXEC);
+	if (File < 0)
+	{
+		LOG_ERROR << "Could not create the flight recorder file \"" << TemporaryPath << "\": " << strerror(errno) << std::endl;
+		return;
+	}
+
+	// The new file reads as zeros, so slots that haven't been written yet are RecordKind::NONE
+	if (ftruncate(File, this->MappingSize) == 0)
+	{
+		void * const Mapping = mmap(nullptr, this->MappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+
+		if (Mapping != MAP_FAILED)
+		{
+			this->Mapping = new (Mapping) Header;
+			this->Records = reinterpret_cast<Record *>(static_cast<char *>(Mapping) + sizeof(Header));
+
+			memcpy(this->Mapping->Magic, ::Magic, sizeof(::Magic));
+			this->Mapping->Version = ::Version;
+			this->Mapping->RecordSize = sizeof(Record);
+			this->Mapping->Capacity = this->Capacity;
+			this->Mapping->WriteIndex.store(0);
+		}
+	}
+
+	if (this->Mapping != nullptr && rename(TemporaryPath.c_str(), Path.c_str()) != 0)
+	{
+		LOG_ERROR << "Could not move the flight recorder file to \"" << Path << "\": " << strerror(errno) << std::endl;
+
+		munmap(this->Mapping, this->MappingSize);
+		this->Mapping = nullptr;
+		this->Records = nullptr;
+	}
+	else if (this->Mapping == nullptr)
+		LOG_ERROR << "Could not map the flight recorder file \"" << TemporaryPath << "\"!" << std::endl;
+
+	if (this->Mapping == nullptr)
+		unlink(TemporaryPath.c_str());
+
+	// The mapping keeps the file alive
+	close(File);
+}
+
+
+FlightRecorder::~FlightRecorder()
+{
+	if (this->Mapping != nullptr)
+		munmap(this->Mapping, this->MappingSize);
+}
+
+
+bool FlightRecorder::IsOpen() const
+{
+	return this->Mapping != nullptr;
+}
+
+
+// EventQueue records events before publishing them, so the state of a window that's just been created is read while
+// only the thread creating it can see it.  Other events are recorded from their own values.
+void FlightRecorder::RecordEnqueued(EventRecord const &Event)
+{
+	if (this->Mapping == nullptr)
+		return;
+
+	Record NewRecord;
+	memset(&NewRecord, 0, sizeof(NewRecord));
+
+	NewRecord.Time = Event.GetTime();
+	NewRecord.Sequence = Event.GetSequence();
+	NewRecord.Kind = RecordKind::ENQUEUED;
+	NewRecord.EventType = static_cast<uint8_t>(Event->GetType());
+
+	Glass::Window *Target = nullptr;
+	Vector Position;
+	Vector Size;
+
+	switch (Event->GetType())
+	{
+	case Glass::Event::Type::ROOT_CREATE:
+		{
+			RootCreate_Event const &EventCast = static_cast<RootCreate_Event const &>(*Event);
+
+			Target = &EventCast.RootWindow;
+			Position = EventCast.RootWindow.GetPosition();
+			Size = EventCast.RootWindow.GetSize();
+		}
+		break;
+
+	case Glass::Event::Type::CLIENT_CREATE:
+		{
+			ClientCreate_Event const &EventCast = static_cast<ClientCreate_Event const &>(*Event);
+
+			Target = &EventCast.ClientWindow;
+			Position = EventCast.ClientWindow.GetPosition();
+			Size = EventCast.ClientWindow.GetSize();
+
+			NewRecord.RelatedWindow = reinterpret_cast<uintptr_t>(EventCast.ClientWindow.GetTransientFor());
+			NewRecord.Value = static_cast<uint32_t>(EventCast.ClientWindow.GetType());
+			NewRecord.Flags = (EventCast.ClientWindow.GetFullscreen() ? CLIENT_FULLSCREEN : 0) |
+							  (EventCast.ClientWindow.GetUrgent() ? CLIENT_URGENT : 0) |
+							  (EventCast.ClientWindow.GetVisibility() ? CLIENT_VISIBLE : 0);
+		}
+		break;
+
+	case Glass::Event::Type::CLIENT_DESTROY:
+		Target = &static_cast<Client_Event const &>(*Event).ClientWindow;
+		break;
+
+	case Glass::Event::Type::CLIENT_GEOMETRY_CHANGE_REQUEST:
+		{
+			ClientGeometryChangeRequest_Event const &EventCast = static_cast<ClientGeometryChangeRequest_Event const &>(*Event);
+
+			Target = &EventCast.ClientWindow;
+			Position = EventCast.Position;
+			Size = EventCast.Size;
+			NewRecord.Value = EventCast.ValueMask;
+		}
+		break;
+
+	case Glass::Event::Type::CLIENT_ICONIFIED_REQUEST:
+		Target = &static_cast<Client_Event const &>(*Event).ClientWindow;
+		NewRecord.Value = static_cast<ClientIconifiedRequest_Event const &>(*Event).State;
+		break;
+
+	case Glass::Event::Type::CLIENT_URGENCY_CHANGE:
+		Target = &static_cast<Client_Event const &>(*Event).ClientWindow;
+		NewRecord.Value = static_cast<ClientUrgencyChange_Event const &>(*Event).State;
+		break;
+
+	case Glass::Event::Type::CLIENT_FULLSCREEN_REQUEST:
+		Target = &static_cast<Client_Event const &>(*Event).ClientWindow;
+		NewRecord.Value = static_cast<uint32_t>(static_cast<ClientFullscreenRequest_Event const &>(*Event).EventMode);
+		break;
+
+	case Glass::Event::Type::PRIMARY_NAME_CHANGE:
+		{
+			PrimaryNameChange_Event const &EventCast = static_cast<PrimaryNameChange_Event const &>(*Event);
+
+			// Names don't fit in a record, but a hash is enough to tell them apart
+			Target = &EventCast.PrimaryWindow;
+			NewRecord.Value = static_cast<uint32_t>(std::hash<std::string>()(*EventCast.NewName));
+		}
+		break;
+
+	case Glass::Event::Type::POINTER_MOVE:
+		Position = static_cast<PointerMove_Event const &>(*Event).Position;
+		break;
+
+	case Glass::Event::Type::WINDOW_ENTER:
+		Target = &static_cast<WindowEnter_Event const &>(*Event).Window;
+		Position = static_cast<WindowEnter_Event const &>(*Event).Position;
+		break;
+
+	case Glass::Event::Type::INPUT:
+		{
+			Input_Event const &EventCast = static_cast<Input_Event const &>(*Event);
+
+			Target = &EventCast.Window;
+			Position = EventCast.Position;
+			NewRecord.Value = static_cast<uint32_t>(EventCast.Input.GetValue()) | (EventCast.Input.GetModifier() << 16);
+			NewRecord.Flags = (EventCast.Input.GetType() == Input::Type::KEYBOARD ? INPUT_KEYBOARD : 0) |
+							  (EventCast.Input.GetState() == Input::State::RELEASED ? INPUT_RELEASED : 0);
+		}
+		break;
+
+	case Glass::Event::Type::WINDOW_MOVE_MODAL:
+	case Glass::Event::Type::WINDOW_RESIZE_MODAL:
+		NewRecord.Value = static_cast<uint32_t>(static_cast<WindowModal_Event const &>(*Event).EventMode);
+		break;
+
+	case Glass::Event::Type::FOCUS_CYCLE:
+		NewRecord.Value = static_cast<uint32_t>(static_cast<FocusCycle_Event const &>(*Event).CycleDirection);
+		break;
+
+	case Glass::Event::Type::LEVEL_TOGGLE:
+		NewRecord.Value = static_cast<uint32_t>(static_cast<LevelToggle_Event const &>(*Event).EventMode);
+		break;
+
+	case Glass::Event::Type::LAYOUT_CYCLE:
+		NewRecord.Value = static_cast<uint32_t>(static_cast<LayoutCycle_Event const &>(*Event).CycleDirection);
+		break;
+
+	case Glass::Event::Type::TAG_DISPLAY:
+		{
+			TagDisplay_Event const &EventCast = static_cast<TagDisplay_Event const &>(*Event);
+
+			NewRecord.Value = EventCast.EventTagMask;
+			NewRecord.Flags = (EventCast.EventTarget == TagDisplay_Event::Target::CLIENT ? TAG_CLIENT : 0) |
+							  (EventCast.EventMode == TagDisplay_Event::Mode::TOGGLE ? TAG_TOGGLE : 0);
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (Target != nullptr)
+	{
+		NewRecord.Window = reinterpret_cast<uintptr_t>(Target);
+
+		switch (Target->GetKind())
+		{
+		case Window::Kind::ROOT:
+			NewRecord.TargetKind = WindowKind::ROOT;
+			break;
+		case Window::Kind::CLIENT:
+			NewRecord.TargetKind = WindowKind::CLIENT;
+			break;
+		case Window::Kind::FRAME:
+		case Window::Kind::UTILITY:
+			NewRecord.TargetKind = Target->GetKind() == Window::Kind::FRAME ? WindowKind::FRAME : WindowKind::UTILITY;
+			NewRecord.RelatedWindow = reinterpret_cast<uintptr_t>(&static_cast<AuxiliaryWindow *>(Target)->GetPrimaryWindow());
+			break;
+		}
+	}
+
+	NewRecord.Position[0] = Position.x;
+	NewRecord.Position[1] = Position.y;
+	NewRecord.Size[0] = Size.x;
+	NewRecord.Size[1] = Size.y;
+
+	this->Write(NewRecord);
+}
+
+
+void FlightRecorder::RecordHandled(EventRecord const &Event, uint64_t Duration)
+{
+	if (this->Mapping == nullptr)
+		return;
+
+	Record NewRecord;
+	memset(&NewRecord, 0, sizeof(NewRecord));
+
+	NewRecord.Time = Event.GetTime();
+	NewRecord.Sequence = Event.GetSequence();
+	NewRecord.Duration = Duration;
+	NewRecord.Kind = RecordKind::HANDLED;
+	NewRecord.EventType = static_cast<uint8_t>(Event->GetType());
+
+	this->Write(NewRecord);
+}
+
+
+bool FlightRecorder::Read(std::string const &Path, std::vector<Record> &Records)
+{
+	int const File = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (File < 0)
+		return false;
+
+	struct stat FileStatus;
+	if (fstat(File, &FileStatus) != 0 || static_cast<size_t>(FileStatus.st_size) < sizeof(Header))
+	{
+		close(File);
+		return false;
+	}
+
+	size_t const MappingSize = FileStatus.st_size;
+	void * const Mapping = mmap(nullptr, MappingSize, PROT_READ, MAP_PRIVATE, File, 0);
+	close(File);
+
+	if (Mapping == MAP_FAILED)
+		return false;
+
+	Header const * const FileHeader = static_cast<Header const *>(Mapping);
+	Record const * const FileRecords = reinterpret_cast<Record const *>(static_cast<char const *>(Mapping) + sizeof(Header));
+
+	bool const Valid = memcmp(FileHeader->Magic, ::Magic, sizeof(::Magic)) == 0 &&
+					   FileHeader->Version == ::Version &&
+					   FileHeader->RecordSize == sizeof(Record) &&
+					   FileHeader->Capacity > 0 &&
+					   FileHeader->Capacity <= (MappingSize - sizeof(Header)) / sizeof(Record);
+
+	if (Valid)
+	{
+		uint64_t const WriteIndex = FileHeader->WriteIndex.load();
+		uint64_t const Count = std::min<uint64_t>(WriteIndex, FileHeader->Capacity);
+
+		Records.clear();
+		Records.reserve(Count);
+
+		for (uint64_t Index = WriteIndex - Count; Index < WriteIndex; Index++)
+		{
+			Record const &FileRecord = FileRecords[Index % FileHeader->Capacity];
+
+			// Skip slots that were claimed but never filled in
+			if (FileRecord.Kind != RecordKind::NONE)
+				Records.push_back(FileRecord);
+		}
+
+		// Threads claim slots in a slightly different order than they queue events
+		std::stable_sort(Records.begin(), Records.end(), RecordOrder);
+	}
+
+	munmap(Mapping, MappingSize);
+
+	return Valid;
+}
+
+
+void FlightRecorder::Write(Record const &Record)
+{
+	uint64_t const Index = this->Mapping->WriteIndex.fetch_add(1, std::memory_order_relaxed);
+
+	this->Records[Index % this->Capacity] = Record;
+}
@@ -0,0 +1,107 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_CORE_FLIGHTRECORDER
+#define GLASS_CORE_FLIGHTRECORDER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Glass
+{
+	class EventRecord;
+
+	// Keeps the most recent events that passed through an EventQueue in a memory-mapped ring file, so a
+	// recording survives the process crashing or being killed.  Any number of threads may record at once.
+
+	class FlightRecorder
+	{
+	public:
+		enum class RecordKind : uint8_t { NONE,
+										  ENQUEUED,
+										  HANDLED };
+
+		enum class WindowKind : uint8_t { NONE,
+										  ROOT,
+										  CLIENT,
+										  FRAME,
+										  UTILITY };
+
+		// Meaning of Record::Flags, by event type
+		enum RecordFlags { CLIENT_FULLSCREEN = 0x01,
+						   CLIENT_URGENT =	   0x02,
+						   CLIENT_VISIBLE =	   0x04,
+
+						   INPUT_KEYBOARD =	   0x01,
+						   INPUT_RELEASED =	   0x02,
+
+						   TAG_CLIENT =		   0x01,
+						   TAG_TOGGLE =		   0x02 };
+
+		// Windows are identified by their address, which is only unique while the window is alive
+		struct Record
+		{
+			uint64_t	Time;			// Nanoseconds on the steady clock, when the event arrived
+			uint64_t	Sequence;		// Order in which the event was queued
+			uint64_t	Duration;		// Nanoseconds spent handling the event, in HANDLED records
+			uint64_t	Window;
+			uint64_t	RelatedWindow;	// The primary window of an auxiliary window, or what a new client is transient for
+			int16_t		Position[2];
+			int16_t		Size[2];
+			uint32_t	Value;			// Event specific; a mask, mode, state, or input
+			RecordKind	Kind;
+			uint8_t		EventType;
+			WindowKind	TargetKind;
+			uint8_t		Flags;			// Event specific
+			uint8_t		Reserved[8];
+		};
+
+		// Whatever is at Path is replaced, not written through
+		FlightRecorder(std::string const &Path, size_t Capacity);
+		FlightRecorder(FlightRecorder const &Other) = delete;
+
+		~FlightRecorder();
+
+		bool IsOpen() const;
+
+		void RecordEnqueued(EventRecord const &Event);
+		void RecordHandled(EventRecord const &Event, uint64_t Duration);
+
+		// Places a relative path in $XDG_RUNTIME_DIR, or without one, in a directory in /tmp that only we can use.
+		// Returns an empty string if there's nowhere safe to put the file.
+		static std::string ResolvePath(std::string const &Path);
+
+		// Reads what's left in a recording, oldest first.  Returns false if the file isn't a recording.
+		static bool Read(std::string const &Path, std::vector<Record> &Records);
+
+	private:
+		struct Header;
+
+		void Write(Record const &Record);
+
+		Header *Mapping;
+		Record *Records;
+		size_t	Capacity;
+		size_t	MappingSize;
+	};
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "glass/core/LatencyHistogram.hpp"
+
+using namespace Glass;
+
+LatencyHistogram::LatencyHistogram()
+{
+	this->Reset();
+}
+
+
+void LatencyHistogram::Record(uint64_t Value)
+{
+	this->Buckets[LatencyHistogram::GetBucket(Value)].fetch_add(1, std::memory_order_relaxed);
+	this->Count.fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t Maximum = this->Maximum.load(std::memory_order_relaxed);
+	while (Value > Maximum && !this->Maximum.compare_exchange_weak(Maximum, Value, std::memory_order_relaxed));
+}
+
+
+void LatencyHistogram::Reset()
+{
+	for (auto &Bucket : this->Buckets)
+		Bucket.store(0, std::memory_order_relaxed);
+
+	this->Count.store(0, std::memory_order_relaxed);
+	this->Maximum.store(0, std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::GetCount() const
+{
+	return this->Count.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::GetMaximum() const
+{
+	return this->Maximum.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::GetPercentile(double Percentile) const
+{
+	uint64_t const Count = this->GetCount();
+	if (Count == 0)
+		return 0;
+
+	uint64_t const Target = std::max<uint64_t>(std::ceil(Count * std::min(Percentile, 100.0) / 100.0), 1);
+	uint64_t Seen = 0;
+
+	for (size_t Bucket = 0; Bucket < LatencyHistogram::BucketCount; Bucket++)
+	{
+		Seen += this->Buckets[Bucket].load(std::memory_order_relaxed);
+
+		if (Seen >= Target)
+			return std::min(LatencyHistogram::GetBucketValue(Bucket), this->GetMaximum());
+	}
+
+	return this->GetMaximum();
+}
+
+
+// Values below twice the sub-bucket count get a bucket each.  Above that, a value's bucket is its power of two
+// and its next SubBucketBits most significant bits.
+size_t LatencyHistogram::GetBucket(uint64_t Value)
+{
+	if (Value < 2 * LatencyHistogram::SubBucketCount)
+		return Value;
+
+	unsigned int const Shift = 63 - __builtin_clzll(Value) - LatencyHistogram::SubBucketBits;
+
+	return Shift * LatencyHistogram::SubBucketCount + (Value >> Shift);
+}
+
+
+// The largest value that falls in Bucket
+uint64_t LatencyHistogram::GetBucketValue(size_t Bucket)
+{
+	if (Bucket < 2 * LatencyHistogram::SubBucketCount)
+		return Bucket;
+
+	unsigned int const Shift = Bucket / LatencyHistogram::SubBucketCount - 1;
+	uint64_t const SubBucket = Bucket % LatencyHistogram::SubBucketCount + LatencyHistogram::SubBucketCount;
+
+	return ((SubBucket + 1) << Shift) - 1;
+}
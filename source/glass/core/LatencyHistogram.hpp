@@ -0,0 +1,62 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_CORE_LATENCYHISTOGRAM
+#define GLASS_CORE_LATENCYHISTOGRAM
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Glass
+{
+	// Log-linear histogram of durations.  Every power of two is split into 16 buckets, so any value can be
+	// recorded in constant time and space, and percentiles are accurate to within about 6%.
+	// Values may be recorded and read from any thread.
+
+	class LatencyHistogram
+	{
+	public:
+		LatencyHistogram();
+		LatencyHistogram(LatencyHistogram const &Other) = delete;
+
+		void Record(uint64_t Value);
+		void Reset();
+
+		uint64_t GetCount() const;
+		uint64_t GetMaximum() const;
+
+		// The smallest value that Percentile percent of the recorded values are at or below
+		uint64_t GetPercentile(double Percentile) const;
+
+	private:
+		static unsigned int const SubBucketBits = 4;
+		static size_t const		  SubBucketCount = 1 << SubBucketBits;
+		static size_t const		  BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+		static size_t	GetBucket(uint64_t Value);
+		static uint64_t GetBucketValue(size_t Bucket);
+
+		std::atomic<uint64_t> Buckets[BucketCount];
+		std::atomic<uint64_t> Count;
+		std::atomic<uint64_t> Maximum;
+	};
+}
+
+#endif
@@ -25,8 +25,9 @@
 
 using namespace Glass;
 
-Window::Window(Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
+Window::Window(Kind KindValue, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
 	DisplayServer(DisplayServer),
+	KindValue(KindValue),
 	Position(Position),
 	Size(Size),
 	Visible(Visible)
@@ -41,6 +42,12 @@ Window::~Window()
 }
 
 
+Window::Kind Window::GetKind() const
+{
+	return this->KindValue;
+}
+
+
 Vector	Window::GetPosition() const		{ return this->Position; }
 Vector	Window::GetSize() const			{ return this->Size; }
 
@@ -103,8 +110,8 @@ bool Window::ContainsPoint(Vector const &Point) const
 }
 
 
-PrimaryWindow::PrimaryWindow(std::string const &Name, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
-	Window(DisplayServer, Position, Size, Visible),
+PrimaryWindow::PrimaryWindow(Kind KindValue, std::string const &Name, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
+	Window(KindValue, DisplayServer, Position, Size, Visible),
 	Name(Name),
 	DecoratedPosition(Position),
 	DecoratedSize(Size)
@@ -186,7 +193,7 @@ void PrimaryWindow::SetVisibility(bool Visible)
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if ((dynamic_cast<FrameWindow *>(AuxiliaryWindow) != nullptr) == Visible)
+			if ((AuxiliaryWindow->GetKind() == Window::Kind::FRAME) == Visible)
 				AuxiliaryWindow->SetVisibility(Visible);
 		}
 	}
@@ -198,7 +205,7 @@ void PrimaryWindow::SetVisibility(bool Visible)
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if ((dynamic_cast<FrameWindow *>(AuxiliaryWindow) == nullptr) == Visible)
+			if ((AuxiliaryWindow->GetKind() != Window::Kind::FRAME) == Visible)
 				AuxiliaryWindow->SetVisibility(Visible);
 		}
 	}
@@ -214,7 +221,7 @@ void PrimaryWindow::Raise()
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if (dynamic_cast<FrameWindow *>(AuxiliaryWindow))
+			if (AuxiliaryWindow->GetKind() == Window::Kind::FRAME)
 				AuxiliaryWindow->Raise();
 		}
 	}
@@ -226,7 +233,7 @@ void PrimaryWindow::Raise()
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if (!dynamic_cast<FrameWindow *>(AuxiliaryWindow))
+			if (AuxiliaryWindow->GetKind() != Window::Kind::FRAME)
 				AuxiliaryWindow->Raise();
 		}
 	}
@@ -242,7 +249,7 @@ void PrimaryWindow::Lower()
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if (!dynamic_cast<FrameWindow *>(AuxiliaryWindow))
+			if (AuxiliaryWindow->GetKind() != Window::Kind::FRAME)
 				AuxiliaryWindow->Lower();
 		}
 	}
@@ -254,7 +261,7 @@ void PrimaryWindow::Lower()
 
 		for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
 		{
-			if (dynamic_cast<FrameWindow *>(AuxiliaryWindow))
+			if (AuxiliaryWindow->GetKind() == Window::Kind::FRAME)
 				AuxiliaryWindow->Lower();
 		}
 	}
@@ -302,7 +309,7 @@ void PrimaryWindow::DeleteAuxiliaryWindows()
 ClientWindow::ClientWindow(std::string const &Name, std::string const &Class, Type TypeValue, Vector const &BaseSize,
 						   bool Iconified, bool Fullscreen, bool Urgent, ClientWindow *TransientFor,
 						   Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
-	PrimaryWindow(Name, DisplayServer, Position, Size, Visible),
+	PrimaryWindow(Kind::CLIENT, Name, DisplayServer, Position, Size, Visible),
 	Class(Class),
 	TypeValue(TypeValue),
 	Iconified(Iconified),
@@ -427,7 +434,7 @@ void ClientWindow::SetRootWindow(Glass::RootWindow *RootWindow)
 
 
 RootWindow::RootWindow(std::string const &Name, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size) :
-	PrimaryWindow(Name, DisplayServer, Position, Size, true),
+	PrimaryWindow(Kind::ROOT, Name, DisplayServer, Position, Size, true),
 	ActiveClientWindow(nullptr),
 	ClientWindows(*this)
 {
@@ -560,9 +567,9 @@ void RootWindow::ClientWindowList::remove(value_type const &val)
 }
 
 
-AuxiliaryWindow::AuxiliaryWindow(Glass::PrimaryWindow &PrimaryWindow, std::string const &Name,
+AuxiliaryWindow::AuxiliaryWindow(Kind KindValue, Glass::PrimaryWindow &PrimaryWindow, std::string const &Name,
 								 Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible) :
-	Window(DisplayServer, Position, Size, Visible),
+	Window(KindValue, DisplayServer, Position, Size, Visible),
 	PrimaryWindow(PrimaryWindow),
 	Name(Name)
 {
@@ -588,7 +595,7 @@ void AuxiliaryWindow::SetName(std::string const &Name)
 
 FrameWindow::FrameWindow(Glass::ClientWindow &ClientWindow, std::string const &Name,
 						 Glass::DisplayServer &DisplayServer, Vector const &ULOffset, Vector const &LROffset, bool Visible) :
-	AuxiliaryWindow(ClientWindow, Name, DisplayServer,
+	AuxiliaryWindow(Kind::FRAME, ClientWindow, Name, DisplayServer,
 					ClientWindow.GetPosition() + ULOffset, ClientWindow.GetSize() - ULOffset + LROffset,
 					Visible),
 	ULOffset(ULOffset),
@@ -676,7 +683,7 @@ void FrameWindow::Update()
 
 UtilityWindow::UtilityWindow(Glass::PrimaryWindow &PrimaryWindow, std::string const &Name,
 							 Glass::DisplayServer &DisplayServer, Vector const &LocalPosition, Vector const &Size, bool Visible) :
-	AuxiliaryWindow(PrimaryWindow, Name, DisplayServer, PrimaryWindow.GetPosition() + LocalPosition, Size, Visible),
+	AuxiliaryWindow(Kind::UTILITY, PrimaryWindow, Name, DisplayServer, PrimaryWindow.GetPosition() + LocalPosition, Size, Visible),
 	LocalPosition(LocalPosition)
 {
 
@@ -711,9 +718,9 @@ void UtilityWindow::HandleEvent(Event const &Event)
 
 void UtilityWindow::Update()
 {
-	if (ClientWindow *PrimaryWindowCast = dynamic_cast<ClientWindow *>(&this->GetPrimaryWindow()))
+	if (this->GetPrimaryWindow().GetKind() == Window::Kind::CLIENT)
 	{
-		if (PrimaryWindowCast->GetFullscreen() == true)
+		if (static_cast<ClientWindow &>(this->GetPrimaryWindow()).GetFullscreen() == true)
 			AuxiliaryWindow::SetVisibility(false);
 	}
 
@@ -726,9 +733,9 @@ void UtilityWindow::Update()
 
 void UtilityWindow::SetVisibility(bool Visible)
 {
-	if (ClientWindow *PrimaryWindowCast = dynamic_cast<ClientWindow *>(&this->GetPrimaryWindow()))
+	if (this->GetPrimaryWindow().GetKind() == Window::Kind::CLIENT)
 	{
-		if (Visible && PrimaryWindowCast->GetFullscreen() == true)
+		if (Visible && static_cast<ClientWindow &>(this->GetPrimaryWindow()).GetFullscreen() == true)
 			return;
 	}
 
@@ -37,11 +37,19 @@ namespace Glass
 	class Window
 	{
 	public:
-		Window(Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible);
+		// What a window is, so callers can static_cast to it without going through RTTI
+		enum class Kind { ROOT,
+						  CLIENT,
+						  FRAME,
+						  UTILITY };
+
+		Window(Kind KindValue, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible);
 		Window(Window const &Other) = delete;
 
 		virtual ~Window();
 
+		Kind GetKind() const;
+
 		virtual Vector	GetPosition() const;
 		virtual Vector	GetSize() const;
 		virtual bool	GetVisibility() const;
@@ -60,6 +68,8 @@ namespace Glass
 	protected:
 		Glass::DisplayServer &DisplayServer;
 
+		Kind const KindValue;
+
 		Vector Position;
 		Vector Size;
 
@@ -75,7 +85,7 @@ namespace Glass
 	class PrimaryWindow : public Window
 	{
 	public:
-		PrimaryWindow(std::string const &Name, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible);
+		PrimaryWindow(Kind KindValue, std::string const &Name, Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible);
 		PrimaryWindow(PrimaryWindow const &Other) = delete;
 
 		~PrimaryWindow();
@@ -260,7 +270,7 @@ namespace Glass
 	class AuxiliaryWindow : public Window
 	{
 	public:
-		AuxiliaryWindow(Glass::PrimaryWindow &PrimaryWindow, std::string const &Name,
+		AuxiliaryWindow(Kind KindValue, Glass::PrimaryWindow &PrimaryWindow, std::string const &Name,
 						Glass::DisplayServer &DisplayServer, Vector const &Position, Vector const &Size, bool Visible);
 		AuxiliaryWindow(AuxiliaryWindow const &Other) = delete;
 
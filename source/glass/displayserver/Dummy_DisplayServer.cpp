@@ -0,0 +1,142 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include "glass/displayserver/Dummy_DisplayServer.hpp"
+
+using namespace Glass;
+
+Dummy_DisplayServer::Dummy_DisplayServer(EventQueue &OutgoingEventQueue) :
+	DisplayServer(OutgoingEventQueue)
+{
+
+}
+
+
+Dummy_DisplayServer::~Dummy_DisplayServer()
+{
+	this->DeleteWindows();
+}
+
+
+RootWindow *Dummy_DisplayServer::CreateRootWindow(Vector const &Position, Vector const &Size)
+{
+	RootWindow *NewRootWindow = new RootWindow("Root", *this, Position, Size);
+
+	{
+		auto RootWindowsAccessor = this->GetRootWindows();
+
+		RootWindowsAccessor->push_back(NewRootWindow);
+	}
+
+	return NewRootWindow;
+}
+
+
+ClientWindow *Dummy_DisplayServer::CreateClientWindow(std::string const &Name, ClientWindow::Type Type, Vector const &Position, Vector const &Size,
+													  bool Fullscreen, bool Urgent, ClientWindow *TransientFor, bool Visible)
+{
+	ClientWindow *NewClientWindow = new ClientWindow(Name, "", Type, Size, false, Fullscreen, Urgent, TransientFor,
+													 *this, Position, Size, Visible);
+
+	{
+		auto ClientWindowsAccessor = this->GetClientWindows();
+
+		ClientWindowsAccessor->push_back(NewClientWindow);
+	}
+
+	return NewClientWindow;
+}
+
+
+void Dummy_DisplayServer::Sync()
+{
+
+}
+
+
+Vector Dummy_DisplayServer::GetMousePosition()
+{
+	std::lock_guard<std::mutex> Lock(this->MousePositionMutex);
+
+	return this->MousePosition;
+}
+
+
+void Dummy_DisplayServer::SetMousePosition(Vector const &Position)
+{
+	std::lock_guard<std::mutex> Lock(this->MousePositionMutex);
+
+	this->MousePosition = Position;
+}
+
+
+void Dummy_DisplayServer::SetWindowGeometry(Window &Window, Vector const &Position, Vector const &Size) { }
+void Dummy_DisplayServer::SetWindowVisibility(Window &Window, bool Visible) { }
+
+
+void Dummy_DisplayServer::RaiseWindow(Window const &Window) { }
+void Dummy_DisplayServer::LowerWindow(Window const &Window) { }
+
+
+void Dummy_DisplayServer::FocusPrimaryWindow(PrimaryWindow const &PrimaryWindow) { }
+
+
+void Dummy_DisplayServer::SetClientWindowIconified(ClientWindow &ClientWindow, bool Value) { }
+void Dummy_DisplayServer::SetClientWindowFullscreen(ClientWindow &ClientWindow, bool Value) { }
+void Dummy_DisplayServer::SetClientWindowUrgent(ClientWindow &ClientWindow, bool Value) { }
+
+
+void Dummy_DisplayServer::CloseClientWindow(ClientWindow const &ClientWindow) { }
+void Dummy_DisplayServer::KillClientWindow(ClientWindow const &ClientWindow) { }
+
+
+void Dummy_DisplayServer::ClearWindow(AuxiliaryWindow &AuxiliaryWindow, Color const &ClearColor) { }
+void Dummy_DisplayServer::FlushWindow(AuxiliaryWindow &AuxiliaryWindow) { }
+
+
+void Dummy_DisplayServer::DrawRectangle(AuxiliaryWindow &AuxiliaryWindow, Vector const &Position, Vector const &Size, float LineWidth, Color const &Color, DrawMode Mode) { }
+void Dummy_DisplayServer::FillRectangle(AuxiliaryWindow &AuxiliaryWindow, Vector const &Position, Vector const &Size, Color const &Color, DrawMode Mode) { }
+
+
+void Dummy_DisplayServer::DrawRoundedRectangle(AuxiliaryWindow &AuxiliaryWindow, Vector const &Position, Vector const &Size, float Radius, float LineWidth, Color const &Color, DrawMode Mode) { }
+void Dummy_DisplayServer::FillRoundedRectangle(AuxiliaryWindow &AuxiliaryWindow, Vector const &Position, Vector const &Size, float Radius, Color const &Color, DrawMode Mode) { }
+
+
+void Dummy_DisplayServer::DrawShape(AuxiliaryWindow &AuxiliaryWindow, Shape const &Shape, float LineWidth, Color const &Color, bool CloseShape, DrawMode Mode) { }
+void Dummy_DisplayServer::FillShape(AuxiliaryWindow &AuxiliaryWindow, Shape const &Shape, Color const &Color, DrawMode Mode) { }
+
+
+void Dummy_DisplayServer::DrawText(AuxiliaryWindow &AuxiliaryWindow, std::string const &FontFace, std::string const &Text, Vector const &Position, Color const &Color, float Size, DrawMode Mode) { }
+
+
+// Rough metrics, so decorations still lay text out the way they would on a real server
+float Dummy_DisplayServer::GetTextWidth(std::string const &FontFace, std::string const &Text, float Size)
+{
+	return Text.size() * Size * 0.6f;
+}
+
+
+float Dummy_DisplayServer::GetTextHeight(std::string const &FontFace, std::string const &Text, float Size)
+{
+	return Size * 1.2f;
+}
+
+
+void Dummy_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWindow) { }
+void Dummy_DisplayServer::DeactivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWindow) { }
@@ -17,6 +17,7 @@
 * Copyright 2014-2015 Chris Foster
 */
 
+#include <algorithm>
 #include <cmath>
 #include <set>
 #include <sstream>
@@ -39,6 +40,7 @@
 #include "glass/displayserver/x11xcb_displayserver/EventHandler.hpp"
 #include "glass/displayserver/x11xcb_displayserver/GeometryChange.hpp"
 #include "glass/displayserver/x11xcb_displayserver/Implementation.hpp"
+#include "glass/displayserver/x11xcb_displayserver/PointerTracker.hpp"
 #include "util/scoped_free.hpp"
 
 using namespace Glass;
@@ -65,8 +67,28 @@ X11XCB_DisplayServer::X11XCB_DisplayServer(EventQueue &OutgoingEventQueue) :
 	this->Data->XScreen = xcb_aux_get_screen(this->Data->XConnection, DefaultScreenIndex);
 
 
-	// Delete pre-existing events, displaying any errors
-	xcb_aux_sync(this->Data->XConnection);
+	// Get atoms from the server
+	Atoms::Initialize(this->Data->XConnection);
+
+
+	// Test for the presence of another window manager.  This is the one request we have to wait on.
+	{
+		uint32_t const EventMask = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
+
+		// Attempt to set substructure redirect on the root window
+		xcb_void_cookie_t const Cookie = xcb_change_window_attributes_checked(this->Data->XConnection, this->Data->XScreen->root, XCB_CW_EVENT_MASK, &EventMask);
+
+		if (xcb_generic_error_t * const Error = xcb_request_check(this->Data->XConnection, Cookie))
+		{
+			free(Error);
+
+			LOG_FATAL << "Could not set substructure redirect.  Is another window manager running?" << std::endl;
+			exit(1);
+		}
+	}
+
+
+	// Delete pre-existing events, displaying any errors.  Everything sent so far has been handled by the check above.
 	{
 		xcb_generic_event_t *Event = nullptr;
 
@@ -88,27 +110,6 @@ X11XCB_DisplayServer::X11XCB_DisplayServer(EventQueue &OutgoingEventQueue) :
 	}
 
 
-	// Get atoms from the server
-	Atoms::Initialize(this->Data->XConnection);
-
-
-	// Test for the presence of another window manager
-	{
-		uint32_t const EventMask = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
-
-		// Attempt to set substructure redirect on the root window
-		xcb_change_window_attributes(this->Data->XConnection, this->Data->XScreen->root, XCB_CW_EVENT_MASK, &EventMask);
-		xcb_aux_sync(this->Data->XConnection);
-
-		// Any resulting event must be an error
-		if (xcb_poll_for_event(this->Data->XConnection) != nullptr)
-		{
-			LOG_FATAL << "Could not set substructure redirect.  Is another window manager running?" << std::endl;
-			exit(1);
-		}
-	}
-
-
 	// Setup the visual and colormap.  Use a 32-bit visual for transparency if available.
 	this->Data->XVisual =	   xcb_aux_find_visual_by_id(this->Data->XScreen, this->Data->XScreen->root_visual);
 	this->Data->XVisualDepth = this->Data->XScreen->root_depth;
@@ -124,12 +125,22 @@ X11XCB_DisplayServer::X11XCB_DisplayServer(EventQueue &OutgoingEventQueue) :
 	}
 
 
+	// Draw through shared memory if the server can use it
+	if (Config::DisplayServerSharedMemory)
+	{
+		this->Data->SharedMemory = this->Data->ProbeSharedMemory();
+
+		if (!this->Data->SharedMemory)
+			LOG_INFO << "MIT-SHM is unavailable; auxiliary windows will be drawn through the server." << std::endl;
+	}
+
+
 	// Initialize the root window(s)
 	{
 		RootWindowList RootWindows = this->Data->CreateRootWindows({ this->Data->XScreen->root });
 
 		for (auto &RootWindow : RootWindows)
-			this->OutgoingEventQueue.AddEvent(*(new RootCreate_Event(*RootWindow)));
+			this->OutgoingEventQueue.AddEvent(RootCreate_Event(*RootWindow));
 	}
 
 
@@ -250,13 +261,13 @@ X11XCB_DisplayServer::X11XCB_DisplayServer(EventQueue &OutgoingEventQueue) :
 		ClientWindowList ClientWindows = this->Data->CreateClientWindows(ConnectedWindowIDs);
 
 		for (auto &ClientWindow : ClientWindows)
-			this->OutgoingEventQueue.AddEvent(*(new ClientCreate_Event(*ClientWindow)));
+			this->OutgoingEventQueue.AddEvent(ClientCreate_Event(*ClientWindow));
 	}
 
 
 	// Allow new events to come in
 	xcb_ungrab_server(this->Data->XConnection);
-	xcb_aux_sync(this->Data->XConnection);
+	xcb_flush(this->Data->XConnection);
 
 
 	// Create event handler
@@ -267,6 +278,7 @@ X11XCB_DisplayServer::X11XCB_DisplayServer(EventQueue &OutgoingEventQueue) :
 X11XCB_DisplayServer::~X11XCB_DisplayServer()
 {
 	LOG_DEBUG_INFO << "Closing X11XCB_DisplayServer..." << std::endl;
+	LOG_DEBUG_INFO << "The pointer position was queried from the server " << this->GetPointerQueryCount() << " times." << std::endl;
 
 	// Destroy event handler
 	delete this->Data->Handler;
@@ -295,61 +307,106 @@ void EnableEvents(xcb_connection_t *XConnection, xcb_window_t WindowID, uint32_t
 }
 
 
-void ConfigureWindow(xcb_connection_t *XConnection, ClientWindowData *WindowData,
-					 Vector const &Position, Vector const &Size)
+// Only the fields that differ from what the server already has are sent.  Returns the fields that were.
+uint16_t ConfigureWindow(xcb_connection_t *XConnection, RequestLog &Requests, WindowData *WindowData,
+						 Vector const &Position, Vector const &Size)
 {
-	xcb_window_t const WindowID = WindowData->ID;
+	uint16_t ConfigureMask = 0x00;
+	uint32_t ConfigureValues[4];
+	unsigned int ValueCount = 0;
 
-	DisableEvents(XConnection, WindowID);
+	if (Position.x != WindowData->AppliedPosition.x)
+	{
+		ConfigureMask |= XCB_CONFIG_WINDOW_X;
+		ConfigureValues[ValueCount++] = (unsigned int)Position.x;
+	}
+	if (Position.y != WindowData->AppliedPosition.y)
+	{
+		ConfigureMask |= XCB_CONFIG_WINDOW_Y;
+		ConfigureValues[ValueCount++] = (unsigned int)Position.y;
+	}
+	if (Size.x != WindowData->AppliedSize.x)
+	{
+		ConfigureMask |= XCB_CONFIG_WINDOW_WIDTH;
+		ConfigureValues[ValueCount++] = (unsigned int)Size.x;
+	}
+	if (Size.y != WindowData->AppliedSize.y)
+	{
+		ConfigureMask |= XCB_CONFIG_WINDOW_HEIGHT;
+		ConfigureValues[ValueCount++] = (unsigned int)Size.y;
+	}
 
-	uint16_t const ConfigureMask = XCB_CONFIG_WINDOW_X |
-								   XCB_CONFIG_WINDOW_Y |
-								   XCB_CONFIG_WINDOW_WIDTH |
-								   XCB_CONFIG_WINDOW_HEIGHT;
+	if (ConfigureMask != 0x00)
+		Requests.NoteRearrangement(xcb_configure_window(XConnection, WindowData->ID, ConfigureMask, ConfigureValues).sequence);
 
-	uint32_t const ConfigureValues[] = { (unsigned int)Position.x,
-										 (unsigned int)Position.y,
-										 (unsigned int)Size.x,
-										 (unsigned int)Size.y };
+	WindowData->AppliedPosition = Position;
+	WindowData->AppliedSize = Size;
 
-	xcb_configure_window(XConnection, WindowID, ConfigureMask, ConfigureValues);
+	return ConfigureMask;
+}
 
-	scoped_free<xcb_configure_notify_event_t *> ConfigureNotify = (xcb_configure_notify_event_t *)calloc(32, 1);
 
-	ConfigureNotify->event = WindowID;
-	ConfigureNotify->window = WindowID;
-	ConfigureNotify->response_type = XCB_CONFIGURE_NOTIFY;
-	ConfigureNotify->x = Position.x;
-	ConfigureNotify->y = Position.y;
-	ConfigureNotify->width = Size.x;
-	ConfigureNotify->height = Size.y;
+// Position is relative to the client's parent, RootPosition to the root
+void ConfigureClientWindow(xcb_connection_t *XConnection, RequestLog &Requests, ClientWindowData *WindowData,
+						   Vector const &Position, Vector const &Size, Vector const &RootPosition)
+{
+	bool const Resized = (ConfigureWindow(XConnection, Requests, WindowData, Position, Size) & (XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT)) != 0x00;
+	bool const Moved = RootPosition != WindowData->AppliedRootPosition;
 
-	xcb_send_event(XConnection, false, WindowID, XCB_EVENT_MASK_STRUCTURE_NOTIFY, (char *)(*ConfigureNotify));
+	// ICCCM 4.1.5: a resize gets a real ConfigureNotify from the server, but a move or an unchanged answer to the
+	// client's own request doesn't, so the client is sent a synthetic one in root coordinates
+	if ((Moved && !Resized) || WindowData->ConfigureRequestPending)
+	{
+		char Buffer[32] = { };
+		xcb_configure_notify_event_t * const ConfigureNotify = (xcb_configure_notify_event_t *)Buffer;
+
+		ConfigureNotify->event = WindowData->ID;
+		ConfigureNotify->window = WindowData->ID;
+		ConfigureNotify->response_type = XCB_CONFIGURE_NOTIFY;
+		ConfigureNotify->x = RootPosition.x;
+		ConfigureNotify->y = RootPosition.y;
+		ConfigureNotify->width = Size.x;
+		ConfigureNotify->height = Size.y;
+
+		xcb_send_event(XConnection, false, WindowData->ID, XCB_EVENT_MASK_STRUCTURE_NOTIFY, Buffer);
+	}
 
-	EnableEvents(XConnection, WindowID, WindowData->EventMask);
+	WindowData->AppliedRootPosition = RootPosition;
+	WindowData->ConfigureRequestPending = false;
 }
 
 
-void ConfigureWindow(xcb_connection_t *XConnection, xcb_window_t WindowID,
-					 Vector const &Position, Vector const &Size)
-{
-	uint16_t const ConfigureMask = XCB_CONFIG_WINDOW_X |
-								   XCB_CONFIG_WINDOW_Y |
-								   XCB_CONFIG_WINDOW_WIDTH |
-								   XCB_CONFIG_WINDOW_HEIGHT;
+bool ReplayDrawList(xcb_connection_t *XConnection, TextCache &Text, AuxiliaryWindowData *WindowData); // Defined below, with the cairo drawing
+
 
-	uint32_t const ConfigureValues[] = { (unsigned int)Position.x,
-										 (unsigned int)Position.y,
-										 (unsigned int)Size.x,
-										 (unsigned int)Size.y };
+// Redraws the window's backbuffer, but only if its size changed.  Moving it takes its contents along.
+// The caller holds the window data lock, as the event handler may be presenting the old backbuffer.
+void ConfigureAuxiliaryWindow(xcb_connection_t *XConnection, RequestLog &Requests, TextCache &Text, AuxiliaryWindowData *WindowData,
+							  Vector const &Position, Vector const &Size)
+{
+	if (ConfigureWindow(XConnection, Requests, WindowData, Position, Size) & (XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT))
+	{
+		WindowData->ResizeBackbuffer(XConnection, Size);
 
-	xcb_configure_window(XConnection, WindowID, ConfigureMask, ConfigureValues);
+		if (ReplayDrawList(XConnection, Text, WindowData))
+			WindowData->PresentBackbuffer(XConnection);
+	}
 }
 
 
 void X11XCB_DisplayServer::Sync()
 {
+	// The event handler adds to the pending changes while it holds the window data, so it has to be taken first here too
+	auto WindowDataAccessor = this->Data->GetWindowData();
 	auto GeometryChangesAccessor = this->Data->GetGeometryChanges();
+	auto PendingAccessor = this->Data->GetPending();
+
+	if (GeometryChangesAccessor->empty() && PendingAccessor->Visibility.empty() && PendingAccessor->Restacks.empty() && PendingAccessor->Focus == nullptr)
+	{
+		xcb_flush(this->Data->XConnection);
+		return;
+	}
+
 	for (auto &GeometryChange : *GeometryChangesAccessor)
 	{
 		Implementation::GeometryChange const *ChangeData = GeometryChange.second;
@@ -357,12 +414,12 @@ void X11XCB_DisplayServer::Sync()
 		Vector const &Position = ChangeData->Position;
 		Vector const &Size =	 ChangeData->Size;
 
-		if (ClientWindowData * const WindowDataCast = dynamic_cast<ClientWindowData *>(ChangeData->WindowData))
+		if (ChangeData->WindowData->Kind == Window::Kind::CLIENT)
 		{
+			ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(ChangeData->WindowData);
+
 			if (WindowDataCast->ParentID != XCB_NONE)
 			{
-				auto WindowDataAccessor = this->Data->GetWindowData();
-
 				auto FrameWindowData = WindowDataAccessor->find(WindowDataCast->ParentID);
 				if (FrameWindowData != WindowDataAccessor->end())
 				{
@@ -374,47 +431,40 @@ void X11XCB_DisplayServer::Sync()
 					Vector const FramePosition = Position + ULOffset;
 					Vector const FrameSize =	 Size - ULOffset + LROffset;
 
-					ConfigureWindow(this->Data->XConnection, WindowDataCast, ULOffset * -1, Size);
-					ConfigureWindow(this->Data->XConnection, WindowDataCast->ParentID, FramePosition, FrameSize);
-
-					AuxiliaryWindowData * const FrameWindowDataCast = static_cast<AuxiliaryWindowData *>(*FrameWindowData);
-
-					cairo_xcb_surface_set_size(FrameWindowDataCast->CairoSurface, FrameSize.x, FrameSize.y);
-
-					FrameWindowDataCast->ReplayDrawOperations();
+					ConfigureClientWindow(this->Data->XConnection, this->Data->Requests, WindowDataCast, ULOffset * -1, Size, Position);
+					ConfigureAuxiliaryWindow(this->Data->XConnection, this->Data->Requests, *this->Data->GetText(), static_cast<AuxiliaryWindowData *>(*FrameWindowData), FramePosition, FrameSize);
 				}
 				else
 					LOG_DEBUG_ERROR << "Could not find a frame window for the current client." << std::endl;
 			}
 			else
-				ConfigureWindow(this->Data->XConnection, WindowDataCast, Position, Size);
+				ConfigureClientWindow(this->Data->XConnection, this->Data->Requests, WindowDataCast, Position, Size, Position);
 		}
-		else if (AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(ChangeData->WindowData))
+		else if (ChangeData->WindowData->Kind == Window::Kind::FRAME || ChangeData->WindowData->Kind == Window::Kind::UTILITY)
 		{
+			AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(ChangeData->WindowData);
+
+			if (WindowDataCast->Kind == Window::Kind::FRAME)
 			{
-				FrameWindow *Frame;
-				ClientWindowData *ClientData;
-				if ((Frame = dynamic_cast<FrameWindow *>(&WindowDataCast->Window)) &&
-					((ClientData = static_cast<ClientWindowData *>(WindowDataCast->PrimaryWindowData))->ParentID != XCB_NONE))
+				FrameWindow * const Frame = static_cast<FrameWindow *>(&WindowDataCast->Window);
+				ClientWindowData * const ClientData = static_cast<ClientWindowData *>(WindowDataCast->PrimaryWindowData);
+
+				if (ClientData->ParentID != XCB_NONE)
 				{
 					Vector const ClientPosition = Frame->GetULOffset() * -1;
 					Vector const ClientSize = Size + Frame->GetULOffset() - Frame->GetLROffset();
 
-					ConfigureWindow(this->Data->XConnection, ClientData, ClientPosition, ClientSize);
+					ConfigureClientWindow(this->Data->XConnection, this->Data->Requests, ClientData, ClientPosition, ClientSize, Position - Frame->GetULOffset());
 				}
-			}
 
-			if (UtilityWindow * const WindowCast = dynamic_cast<UtilityWindow *>(&WindowDataCast->Window))
-			{
-				ConfigureWindow(this->Data->XConnection, WindowDataCast->ID, Position - WindowCast->GetPrimaryWindow().GetPosition(),
-																			 Size);
+				ConfigureAuxiliaryWindow(this->Data->XConnection, this->Data->Requests, *this->Data->GetText(), WindowDataCast, Position, Size);
 			}
 			else
-				ConfigureWindow(this->Data->XConnection, WindowDataCast->ID, Position, Size);
-
-			cairo_xcb_surface_set_size(WindowDataCast->CairoSurface, Size.x, Size.y);
+			{
+				UtilityWindow const &Utility = static_cast<UtilityWindow const &>(WindowDataCast->Window);
 
-			WindowDataCast->ReplayDrawOperations();
+				ConfigureAuxiliaryWindow(this->Data->XConnection, this->Data->Requests, *this->Data->GetText(), WindowDataCast, Position - Utility.GetPrimaryWindow().GetPosition(), Size);
+			}
 		}
 
 		delete ChangeData;
@@ -422,22 +472,68 @@ void X11XCB_DisplayServer::Sync()
 
 	GeometryChangesAccessor->clear();
 
-	xcb_aux_sync(this->Data->XConnection);
+	// Map and unmap after moving, so nothing is seen where it used to be
+	for (auto WindowData : PendingAccessor->Visibility)
+		this->Data->ApplyVisibility(WindowData);
+
+	PendingAccessor->Visibility.clear();
+
+	for (auto ParentID : PendingAccessor->Restacks)
+		this->Data->ApplyStackingOrder(ParentID);
+
+	PendingAccessor->Restacks.clear();
+
+	// Focus last, once the window is viewable
+	if (PendingAccessor->Focus != nullptr)
+	{
+		this->Data->ApplyFocus(PendingAccessor->Focus);
+		PendingAccessor->Focus = nullptr;
+	}
+
+	// Ends the run of rearrangements, so crossings the pointer itself causes after it aren't mistaken for ours
+	if (this->Data->Requests.TakeRearranged())
+		xcb_no_operation(this->Data->XConnection);
+
+	// Don't wait for the server; any errors are reported asynchronously by the event handler
+	xcb_flush(this->Data->XConnection);
 }
 
 
 Vector X11XCB_DisplayServer::GetMousePosition()
 {
+	if (PointerTracker::IsTrusted())
+		return PointerTracker::GetPosition();
+
+	this->Data->PointerQueries++;
+
 	xcb_query_pointer_cookie_t QueryPointerCookie = xcb_query_pointer_unchecked(this->Data->XConnection, this->Data->XScreen->root);
 	scoped_free<xcb_query_pointer_reply_t *> QueryPointerReply = xcb_query_pointer_reply(this->Data->XConnection, QueryPointerCookie, NULL);
 
+	this->Data->Handler->Wake();
+
+	if (!QueryPointerReply)
+		return PointerTracker::GetPosition();
+
+	// The pointer may be over a window that doesn't tell us when it moves, so this is only good for now
+	PointerTracker::Set(QueryPointerReply->root_x, QueryPointerReply->root_y);
+
 	return Vector(QueryPointerReply->root_x, QueryPointerReply->root_y);
 }
 
 
+uint64_t X11XCB_DisplayServer::GetPointerQueryCount() const
+{
+	return this->Data->PointerQueries;
+}
+
+
 void X11XCB_DisplayServer::SetMousePosition(Vector const &Position)
 {
-	xcb_warp_pointer(this->Data->XConnection, XCB_NONE, this->Data->XScreen->root, 0, 0, 0, 0, Position.x, Position.y);
+	xcb_void_cookie_t const Cookie = xcb_warp_pointer(this->Data->XConnection, XCB_NONE, this->Data->XScreen->root, 0, 0, 0, 0, Position.x, Position.y);
+	this->Data->Requests.Note("SetMousePosition", Cookie.sequence);
+
+	// Until the crossing events come back, we don't know what's under it.  A grab still hears where it went.
+	PointerTracker::Set(Position.x, Position.y, false);
 }
 
 
@@ -445,9 +541,7 @@ void X11XCB_DisplayServer::SetWindowGeometry(Window &Window, Vector const &Posit
 {
 	// If the window is a client that is fullscreen, effect no actual change.  The new dimensions have already been recorded.
 	{
-		ClientWindow * const WindowCast = dynamic_cast<ClientWindow *>(&Window);
-
-		if (WindowCast != nullptr && WindowCast->GetFullscreen() == true)
+		if (Window.GetKind() == Window::Kind::CLIENT && static_cast<ClientWindow &>(Window).GetFullscreen() == true)
 			return;
 	}
 
@@ -470,96 +564,24 @@ void X11XCB_DisplayServer::SetWindowVisibility(Window &Window, bool Visible)
 	auto WindowData = WindowDataAccessor->find(&Window);
 	if (WindowData != WindowDataAccessor->end())
 	{
-		xcb_window_t const &WindowID = (*WindowData)->ID;
-
-		if (ClientWindowData const * const WindowDataCast = dynamic_cast<ClientWindowData const *>(*WindowData))
-		{
-			if (WindowDataCast->ParentID != XCB_NONE)
-				return;
-
-			if (!WindowDataCast->Destroyed)
-			{
-				DisableEvents(this->Data->XConnection, WindowID);
-			}
-		}
-		else
-			DisableEvents(this->Data->XConnection, WindowID);
-
-		if (!Visible)
-			xcb_unmap_window(this->Data->XConnection, WindowID);
-		else
-			xcb_map_window(this->Data->XConnection, WindowID);
+		// Clients inside a frame are shown and hidden with it
+		if (Window.GetKind() == Window::Kind::CLIENT && static_cast<ClientWindowData *>(*WindowData)->ParentID != XCB_NONE)
+			return;
 
-		if (ClientWindowData const * const WindowDataCast = dynamic_cast<ClientWindowData const *>(*WindowData))
-		{
-			if (!WindowDataCast->Destroyed)
-				EnableEvents(this->Data->XConnection, WindowID, WindowDataCast->EventMask);
-		}
-		else
-			EnableEvents(this->Data->XConnection, WindowID, (*WindowData)->EventMask);
+		this->Data->SetWindowMapped(*WindowData, Visible);
 	}
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window! Cannot set window visibility." << std::endl;
 }
 
 
-bool WindowSupportsProtocol(xcb_connection_t *XConnection, xcb_window_t WindowID, xcb_atom_t ProtocolAtom)
-{
-	xcb_get_property_cookie_t const ProtocolsCookie = xcb_icccm_get_wm_protocols_unchecked(XConnection, WindowID, Atoms::WM_PROTOCOLS);
-
-	xcb_icccm_get_wm_protocols_reply_t ProtocolsReply;
-
-	if (!xcb_icccm_get_wm_protocols_reply(XConnection, ProtocolsCookie, &ProtocolsReply, nullptr))
-	{
-		LOG_DEBUG_WARNING << "Could not get WM_PROTOCOLS on window ID: " << WindowID << std::endl;
-		return false;
-	}
-
-	for (unsigned short Index = 0; Index < ProtocolsReply.atoms_len; Index++)
-	{
-		if (ProtocolsReply.atoms[Index] == ProtocolAtom)
-		{
-			xcb_icccm_get_wm_protocols_reply_wipe(&ProtocolsReply);
-			return true;
-		}
-	}
-
-	xcb_icccm_get_wm_protocols_reply_wipe(&ProtocolsReply);
-	return false;
-}
-
-
-void Raise(xcb_connection_t *XConnection, xcb_window_t WindowID)
-{
-	uint16_t const ConfigureMask = XCB_CONFIG_WINDOW_STACK_MODE;
-
-	uint32_t const ConfigureValues[] = { XCB_STACK_MODE_ABOVE };
-
-	xcb_configure_window(XConnection, WindowID, ConfigureMask, ConfigureValues);
-}
-
-
-void Lower(xcb_connection_t *XConnection, xcb_window_t WindowID)
-{
-	uint16_t const ConfigureMask = XCB_CONFIG_WINDOW_STACK_MODE;
-
-	uint32_t const ConfigureValues[] = { XCB_STACK_MODE_BELOW };
-
-	xcb_configure_window(XConnection, WindowID, ConfigureMask, ConfigureValues);
-}
-
-
 void X11XCB_DisplayServer::RaiseWindow(Window const &Window)
 {
 	auto WindowDataAccessor = this->Data->GetWindowData();
 
 	auto WindowData = WindowDataAccessor->find(&Window);
 	if (WindowData != WindowDataAccessor->end())
-	{
-		xcb_window_t const &WindowID = (*WindowData)->ID;
-
-		Raise(this->Data->XConnection, WindowID);
-	}
+		this->Data->SetWindowStacking(*WindowData, Implementation::StackMode::RAISE);
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window!  Cannot raise window." << std::endl;
 }
@@ -571,11 +593,7 @@ void X11XCB_DisplayServer::LowerWindow(Window const &Window)
 
 	auto WindowData = WindowDataAccessor->find(&Window);
 	if (WindowData != WindowDataAccessor->end())
-	{
-		xcb_window_t const &WindowID = (*WindowData)->ID;
-
-		Lower(this->Data->XConnection, WindowID);
-	}
+		this->Data->SetWindowStacking(*WindowData, Implementation::StackMode::LOWER);
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window!  Cannot lower window." << std::endl;
 }
@@ -595,13 +613,15 @@ void X11XCB_DisplayServer::DeleteWindow(Window &Window)
 		if (*ActiveWindowAccessor == *WindowData)
 			*ActiveWindowAccessor = nullptr;
 
-		if (dynamic_cast<ClientWindow *>(&Window))
+		if (Window.GetKind() == Window::Kind::CLIENT)
 		{
 			// XXX Remove from EWMH client list
 
 			// Don't generate an error if the window is already gone
 			xcb_change_save_set_checked(this->Data->XConnection, XCB_SET_MODE_DELETE, (*WindowData)->ID);
 		}
+
+		this->Data->ForgetWindow(*WindowData);
 	}
 
 	WindowDataAccessor->erase(&Window);
@@ -614,64 +634,17 @@ void X11XCB_DisplayServer::FocusPrimaryWindow(PrimaryWindow const &PrimaryWindow
 
 	auto WindowData = WindowDataAccessor->find(&PrimaryWindow);
 	if (WindowData != WindowDataAccessor->end())
-	{
-		xcb_window_t WindowID = (*WindowData)->ID;
-
-		if (ClientWindowData * const WindowDataCast = dynamic_cast<ClientWindowData *>(*WindowData))
-		{
-			xcb_get_window_attributes_cookie_t const WindowAttributesCookie = xcb_get_window_attributes(this->Data->XConnection, WindowID);
-			xcb_get_window_attributes_reply_t *WindowAttributes = xcb_get_window_attributes_reply(this->Data->XConnection, WindowAttributesCookie, nullptr);
-
-			if (WindowAttributes != nullptr && WindowAttributes->map_state == XCB_MAP_STATE_VIEWABLE)
-			{
-				if (WindowDataCast->NeverFocus)
-					WindowID = WindowDataCast->RootID;
-
-				if (WindowSupportsProtocol(this->Data->XConnection, WindowDataCast->ID, Atoms::WM_TAKE_FOCUS))
-				{
-					xcb_client_message_event_t ClientMessage;
-
-					memset(&ClientMessage, 0, sizeof(ClientMessage));
-
-					ClientMessage.response_type = XCB_CLIENT_MESSAGE;
-					ClientMessage.format = 32;
-					ClientMessage.window = WindowID;
-					ClientMessage.type = Atoms::WM_PROTOCOLS;
-					ClientMessage.data.data32[0] = Atoms::WM_TAKE_FOCUS;
-					ClientMessage.data.data32[1] = XCB_CURRENT_TIME;
-
-					xcb_send_event(this->Data->XConnection, false, WindowDataCast->ID, XCB_EVENT_MASK_NO_EVENT, (char *)&ClientMessage);
-				}
-
-				xcb_set_input_focus(this->Data->XConnection, XCB_INPUT_FOCUS_POINTER_ROOT, WindowID, XCB_CURRENT_TIME);
-
-				// XXX Set EWMH active window and add to the EWMH focus stack
-			}
-
-			free(WindowAttributes);
-
-			// Keep track of which window has the input focus so we can detect unauthorized changes to the focus and revert them
-			{
-				auto ActiveWindowAccessor = this->Data->GetActiveWindow();
-
-				*ActiveWindowAccessor = WindowDataCast;
-			}
-		}
-		else // This is a root window
-		{
-			xcb_set_input_focus(this->Data->XConnection, XCB_INPUT_FOCUS_POINTER_ROOT, WindowID, XCB_CURRENT_TIME);
-		}
-	}
+		this->Data->SetWindowFocus(*WindowData);
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window!  Cannot focus window." << std::endl;
 }
 
 
-void Update_NET_WM_STATE(xcb_connection_t *XConnection, xcb_window_t WindowID, std::set<xcb_atom_t> const &StateAtoms)
+xcb_void_cookie_t Update_NET_WM_STATE(xcb_connection_t *XConnection, xcb_window_t WindowID, std::set<xcb_atom_t> const &StateAtoms)
 {
 	std::vector<xcb_atom_t> const Data(StateAtoms.begin(), StateAtoms.end());
 
-	xcb_change_property(XConnection, XCB_PROP_MODE_REPLACE, WindowID,
+	return xcb_change_property(XConnection, XCB_PROP_MODE_REPLACE, WindowID,
 						Atoms::_NET_WM_STATE, XCB_ATOM_ATOM, 32, Data.size(), &Data.front());
 }
 
@@ -692,38 +665,28 @@ void X11XCB_DisplayServer::SetClientWindowIconified(ClientWindow &ClientWindow,
 		if (Value)
 		{
 			uint32_t StateValues[] = { XCB_ICCCM_WM_STATE_ICONIC, XCB_NONE };
-			xcb_change_property(this->Data->XConnection, XCB_PROP_MODE_REPLACE, WindowID,
-								Atoms::WM_STATE, Atoms::WM_STATE, 32, 2, StateValues);
+			xcb_void_cookie_t const Cookie = xcb_change_property(this->Data->XConnection, XCB_PROP_MODE_REPLACE, WindowID,
+																 Atoms::WM_STATE, Atoms::WM_STATE, 32, 2, StateValues);
+			this->Data->Requests.Note("SetClientWindowIconified", Cookie.sequence);
 
 			ClientWindowData->_NET_WM_STATE.insert(Atoms::_NET_WM_STATE_HIDDEN);
 			Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
 
 			if (ClientWindowData->ParentID != XCB_NONE)
-			{
-				DisableEvents(this->Data->XConnection, WindowID);
-
-				xcb_unmap_window(this->Data->XConnection, WindowID);
-
-				EnableEvents(this->Data->XConnection, WindowID, ClientWindowData->EventMask);
-			}
+				this->Data->SetWindowMapped(ClientWindowData, false);
 		}
 		else
 		{
 			uint32_t StateValues[] = { XCB_ICCCM_WM_STATE_NORMAL, XCB_NONE };
-			xcb_change_property(this->Data->XConnection, XCB_PROP_MODE_REPLACE, WindowID,
-								Atoms::WM_STATE, Atoms::WM_STATE, 32, 2, StateValues);
+			xcb_void_cookie_t const Cookie = xcb_change_property(this->Data->XConnection, XCB_PROP_MODE_REPLACE, WindowID,
+																 Atoms::WM_STATE, Atoms::WM_STATE, 32, 2, StateValues);
+			this->Data->Requests.Note("SetClientWindowIconified", Cookie.sequence);
 
 			ClientWindowData->_NET_WM_STATE.erase(Atoms::_NET_WM_STATE_HIDDEN);
 			Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
 
 			if (ClientWindowData->ParentID != XCB_NONE)
-			{
-				DisableEvents(this->Data->XConnection, WindowID);
-
-				xcb_map_window(this->Data->XConnection, WindowID);
-
-				EnableEvents(this->Data->XConnection, WindowID, ClientWindowData->EventMask);
-			}
+				this->Data->SetWindowMapped(ClientWindowData, true);
 		}
 	}
 	else
@@ -746,7 +709,8 @@ void X11XCB_DisplayServer::SetClientWindowFullscreen(ClientWindow &ClientWindow,
 			if (Value)
 			{
 				ClientWindowData->_NET_WM_STATE.insert(Atoms::_NET_WM_STATE_FULLSCREEN);
-				Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
+				xcb_void_cookie_t const Cookie = Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
+				this->Data->Requests.Note("SetClientWindowFullscreen", Cookie.sequence);
 
 				if (RootWindow const * const ClientRoot = ClientWindow.GetRootWindow())
 				{
@@ -759,7 +723,8 @@ void X11XCB_DisplayServer::SetClientWindowFullscreen(ClientWindow &ClientWindow,
 			else
 			{
 				ClientWindowData->_NET_WM_STATE.erase(Atoms::_NET_WM_STATE_FULLSCREEN);
-				Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
+				xcb_void_cookie_t const Cookie = Update_NET_WM_STATE(this->Data->XConnection, WindowID, ClientWindowData->_NET_WM_STATE);
+				this->Data->Requests.Note("SetClientWindowFullscreen", Cookie.sequence);
 
 				this->Data->SetWindowGeometry(ClientWindowData, ClientWindow.GetPosition(),
 																ClientWindow.GetSize());
@@ -790,17 +755,18 @@ void X11XCB_DisplayServer::SetClientWindowUrgent(ClientWindow &ClientWindow, boo
 		if (WindowDataCast->Urgent == Value)
 			return;
 
-		xcb_icccm_wm_hints_t	  WMHints;
-		xcb_get_property_cookie_t WMHintsCookie = xcb_icccm_get_wm_hints_unchecked(this->Data->XConnection, WindowID);
-
-		xcb_icccm_get_wm_hints_reply(this->Data->XConnection, WMHintsCookie, &WMHints, nullptr);
+		xcb_icccm_wm_hints_t &WMHints = WindowDataCast->WMHints;
 
 		if (Value)
 			WMHints.flags |= XCB_ICCCM_WM_HINT_X_URGENCY;
 		else
 			WMHints.flags &= ~XCB_ICCCM_WM_HINT_X_URGENCY;
 
-		xcb_icccm_set_wm_hints(this->Data->XConnection, WindowID, &WMHints);
+		xcb_void_cookie_t const Cookie = xcb_icccm_set_wm_hints(this->Data->XConnection, WindowID, &WMHints);
+		this->Data->Requests.Note("SetClientWindowUrgent", Cookie.sequence);
+
+		// A reply already on its way would predate this
+		this->Data->RefreshClientProperty(WindowDataCast, Atoms::WM_HINTS);
 
 		WindowDataCast->Urgent = Value;
 	}
@@ -816,9 +782,10 @@ void X11XCB_DisplayServer::CloseClientWindow(ClientWindow const &ClientWindow)
 	auto WindowData = WindowDataAccessor->find(&ClientWindow);
 	if (WindowData != WindowDataAccessor->end())
 	{
-		xcb_window_t const &WindowID = (*WindowData)->ID;
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(*WindowData);
+		xcb_window_t const &WindowID = WindowDataCast->ID;
 
-		if (WindowSupportsProtocol(this->Data->XConnection, WindowID, Atoms::WM_DELETE_WINDOW))
+		if (WindowDataCast->Protocols.count(Atoms::WM_DELETE_WINDOW))
 		{
 			xcb_client_message_event_t ClientMessage;
 
@@ -831,11 +798,15 @@ void X11XCB_DisplayServer::CloseClientWindow(ClientWindow const &ClientWindow)
 			ClientMessage.data.data32[0] = Atoms::WM_DELETE_WINDOW;
 			ClientMessage.data.data32[1] = XCB_CURRENT_TIME;
 
-			xcb_send_event(this->Data->XConnection, false, WindowID, XCB_EVENT_MASK_NO_EVENT, (char *)&ClientMessage);
+			xcb_void_cookie_t const Cookie = xcb_send_event(this->Data->XConnection, false, WindowID, XCB_EVENT_MASK_NO_EVENT, (char *)&ClientMessage);
+			this->Data->Requests.Note("CloseClientWindow", Cookie.sequence);
 		}
 		else
+		{
 			// The client can't close nicely, so kill it
-			xcb_kill_client(this->Data->XConnection, WindowID);
+			xcb_void_cookie_t const Cookie = xcb_kill_client(this->Data->XConnection, WindowID);
+			this->Data->Requests.Note("CloseClientWindow", Cookie.sequence);
+		}
 	}
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window! Cannot close." << std::endl;
@@ -851,7 +822,8 @@ void X11XCB_DisplayServer::KillClientWindow(ClientWindow const &ClientWindow)
 	{
 		xcb_window_t const &WindowID = (*WindowData)->ID;
 
-		xcb_kill_client(this->Data->XConnection, WindowID);
+		xcb_void_cookie_t const Cookie = xcb_kill_client(this->Data->XConnection, WindowID);
+		this->Data->Requests.Note("KillClientWindow", Cookie.sequence);
 	}
 	else
 		LOG_DEBUG_ERROR << "Could not find a window ID for the provided window! Cannot kill." << std::endl;
@@ -860,8 +832,7 @@ void X11XCB_DisplayServer::KillClientWindow(ClientWindow const &ClientWindow)
 
 namespace Cairo
 {
-	enum class DrawMode { OVERLAY,
-						  REPLACE };
+	typedef DrawList::DrawMode DrawMode;
 
 
 	void ClearWindow(AuxiliaryWindow *AuxiliaryWindow, cairo_t *Context, Color const &Color)
@@ -875,12 +846,6 @@ namespace Cairo
 	}
 
 
-	void FlushWindow(cairo_surface_t *Surface)
-	{
-		cairo_surface_flush(Surface);
-	}
-
-
 	void DrawRectangle(cairo_t *Context, Vector const &Position, Vector const &Size, float LineWidth, Color const &Color, DrawMode Mode)
 	{
 		cairo_set_operator(Context, Mode == DrawMode::OVERLAY ? CAIRO_OPERATOR_OVER : CAIRO_OPERATOR_SOURCE);
@@ -939,35 +904,30 @@ namespace Cairo
 	}
 
 
-	void RealizeShape(cairo_t *Context, Shape const &Shape)
+	void RealizeShape(cairo_t *Context, DrawList::ShapeElement const *Elements, size_t ElementCount)
 	{
-		bool FirstElement = true;
-		for (auto Element : Shape)
+		for (size_t Index = 0; Index < ElementCount; Index++)
 		{
-			if (Element->GetType() == Glass::Shape::Element::Type::POINT)
-			{
-				Shape::Point const &Point = static_cast<Shape::Point const &>(*Element);
+			DrawList::ShapeElement const &Element = Elements[Index];
 
-				if (FirstElement)
-					cairo_move_to(Context, Point.X, Point.Y);
+			if (Element.Type == Glass::Shape::Element::Type::POINT)
+			{
+				if (Index == 0)
+					cairo_move_to(Context, Element.Values[0], Element.Values[1]);
 				else
-					cairo_line_to(Context, Point.X, Point.Y);
+					cairo_line_to(Context, Element.Values[0], Element.Values[1]);
 			}
-			else if (Element->GetType() == Glass::Shape::Element::Type::ARC)
+			else if (Element.Type == Glass::Shape::Element::Type::ARC)
 			{
-				Shape::Arc const &Arc = static_cast<Shape::Arc const &>(*Element);
-
-				cairo_arc(Context, Arc.CenterX, Arc.CenterY, Arc.Radius, Arc.StartAngle, Arc.EndAngle);
+				cairo_arc(Context, Element.Values[0], Element.Values[1], Element.Values[2], Element.Values[3], Element.Values[4]);
 			}
-
-			FirstElement = false;
 		}
 	}
 
 
-	void DrawShape(cairo_t *Context, Shape const &Shape, float LineWidth, Color const &Color, bool CloseShape, DrawMode Mode)
+	void DrawShape(cairo_t *Context, DrawList::ShapeElement const *Elements, size_t ElementCount, float LineWidth, Color const &Color, bool CloseShape, DrawMode Mode)
 	{
-		if (Shape.empty())
+		if (ElementCount == 0)
 			return;
 
 		cairo_set_operator(Context, Mode == DrawMode::OVERLAY ? CAIRO_OPERATOR_OVER : CAIRO_OPERATOR_SOURCE);
@@ -976,7 +936,7 @@ namespace Cairo
 		cairo_set_line_width(Context, LineWidth);
 
 		cairo_new_sub_path(Context);
-		RealizeShape(Context, Shape);
+		RealizeShape(Context, Elements, ElementCount);
 
 		if (CloseShape)
 			cairo_close_path(Context);
@@ -985,38 +945,34 @@ namespace Cairo
 	}
 
 
-	void FillShape(cairo_t *Context, Shape const &Shape, Color const &Color, DrawMode Mode)
+	void FillShape(cairo_t *Context, DrawList::ShapeElement const *Elements, size_t ElementCount, Color const &Color, DrawMode Mode)
 	{
-		if (Shape.empty())
+		if (ElementCount == 0)
 			return;
 
 		cairo_set_operator(Context, Mode == DrawMode::OVERLAY ? CAIRO_OPERATOR_OVER : CAIRO_OPERATOR_SOURCE);
 		cairo_set_source_rgba(Context, Color.R, Color.B, Color.G, Color.A);
 
 		cairo_new_sub_path(Context);
-		RealizeShape(Context, Shape);
+		RealizeShape(Context, Elements, ElementCount);
 		cairo_close_path(Context);
 
 		cairo_fill(Context);
 	}
 
 
-	void LoadFont(PangoLayout *Layout, std::string const &FontDescriptionString)
+	void LoadFont(PangoLayout *Layout, PangoFontDescription const *FontDescription)
 	{
-		PangoFontDescription * const FontDescription = pango_font_description_from_string(FontDescriptionString.c_str());
-
 		pango_layout_set_font_description(Layout, FontDescription);
-
-		pango_font_description_free(FontDescription);
 	}
 
 
-	void DrawText(cairo_t *Context, PangoLayout *Layout, std::string const &Text, Vector const &Position, Color const &Color, float Size, DrawMode Mode)
+	void DrawText(cairo_t *Context, PangoLayout *Layout, char const *Text, size_t TextLength, Vector const &Position, Color const &Color, DrawMode Mode)
 	{
 		cairo_set_operator(Context, Mode == DrawMode::OVERLAY ? CAIRO_OPERATOR_OVER : CAIRO_OPERATOR_SOURCE);
 		cairo_set_source_rgba(Context, Color.R, Color.B, Color.G, Color.A);
 
-		pango_layout_set_text(Layout, Text.c_str(), -1);
+		pango_layout_set_text(Layout, Text, TextLength);
 
 		PangoRectangle InkExtents, LogicalExtents;
 		pango_layout_get_extents(Layout, &InkExtents, &LogicalExtents);
@@ -1027,30 +983,62 @@ namespace Cairo
 
 		pango_cairo_show_layout(Context, Layout);
 	}
+}
 
 
-	float GetTextWidth(PangoLayout *Layout, std::string const &Text)
-	{
-		pango_layout_set_text(Layout, Text.c_str(), -1);
+// False if the redraw had to be put off until the server is done with the window's last frame
+bool ReplayDrawList(xcb_connection_t *XConnection, TextCache &Text, AuxiliaryWindowData *WindowData)
+{
+	if (!WindowData->BeginDrawing())
+		return false;
 
-		PangoRectangle Extents;
-		pango_layout_get_extents(Layout, &Extents, nullptr);
+	cairo_t * const Context = WindowData->CairoContext;
+	DrawList const &Operations = WindowData->DrawOperations;
 
-		//LOG_WARNING << pango_layout_get_baseline(Layout) << " " << Extents.height << std::endl;
+	for (auto &Operation : Operations)
+	{
+		Vector const Position(Operation.X, Operation.Y);
+		Vector const Size(Operation.Width, Operation.Height);
+		Color const OperationColor(Operation.R, Operation.G, Operation.B, Operation.A);
 
-		return (float)Extents.width / PANGO_SCALE;
+		switch (Operation.Code)
+		{
+		case DrawList::Opcode::CLEAR_WINDOW:
+			Cairo::ClearWindow(static_cast<AuxiliaryWindow *>(&WindowData->Window), Context, OperationColor);
+			break;
+		case DrawList::Opcode::LOAD_FONT:
+			Cairo::LoadFont(WindowData->Layout, Text.GetFontDescription(Operations.GetText(Operation)));
+			break;
+		case DrawList::Opcode::DRAW_RECTANGLE:
+			Cairo::DrawRectangle(Context, Position, Size, Operation.LineWidth, OperationColor, Operation.Mode);
+			break;
+		case DrawList::Opcode::FILL_RECTANGLE:
+			Cairo::FillRectangle(Context, Position, Size, OperationColor, Operation.Mode);
+			break;
+		case DrawList::Opcode::DRAW_ROUNDED_RECTANGLE:
+			Cairo::DrawRoundedRectangle(Context, Position, Size, Operation.Radius, Operation.LineWidth, OperationColor, Operation.Mode);
+			break;
+		case DrawList::Opcode::FILL_ROUNDED_RECTANGLE:
+			Cairo::FillRoundedRectangle(Context, Position, Size, Operation.Radius, OperationColor, Operation.Mode);
+			break;
+		case DrawList::Opcode::DRAW_SHAPE:
+			Cairo::DrawShape(Context, Operations.GetShapeElements(Operation), Operation.DataLength / sizeof(DrawList::ShapeElement),
+							 Operation.LineWidth, OperationColor, Operation.CloseShape, Operation.Mode);
+			break;
+		case DrawList::Opcode::FILL_SHAPE:
+			Cairo::FillShape(Context, Operations.GetShapeElements(Operation), Operation.DataLength / sizeof(DrawList::ShapeElement),
+							 OperationColor, Operation.Mode);
+			break;
+		case DrawList::Opcode::DRAW_TEXT:
+			Cairo::DrawText(Context, WindowData->Layout, Operations.GetText(Operation), Operation.DataLength, Position, OperationColor, Operation.Mode);
+			break;
+		}
 	}
 
+	WindowData->EndDrawing(XConnection);
+	WindowData->PaintedHash = Operations.GetHash();
 
-	float GetTextHeight(PangoLayout *Layout, std::string const &Text)
-	{
-		pango_layout_set_text(Layout, Text.c_str(), -1);
-
-		PangoRectangle Extents;
-		pango_layout_get_extents(Layout, &Extents, nullptr);
-
-		return (float)Extents.height / PANGO_SCALE;
-	}
+	return true;
 }
 
 
@@ -1074,10 +1062,10 @@ void X11XCB_DisplayServer::ClearWindow(AuxiliaryWindow &AuxiliaryWindow, Color c
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
 		WindowDataCast->DrawOperations.clear();
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::ClearWindow, &AuxiliaryWindow, WindowDataCast->CairoContext, ClearColor));
+		WindowDataCast->DrawOperations.Clear(ClearColor);
 
 		WindowDataCast->FontDescriptionString = GetFontDescriptionString(Config::FontFaceSans, Config::FontSize);
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::LoadFont, WindowDataCast->Layout, WindowDataCast->FontDescriptionString));
+		WindowDataCast->DrawOperations.LoadFont(WindowDataCast->FontDescriptionString);
 	}
 }
 
@@ -1091,8 +1079,12 @@ void X11XCB_DisplayServer::FlushWindow(AuxiliaryWindow &AuxiliaryWindow)
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::FlushWindow, WindowDataCast->CairoSurface));
-		WindowDataCast->ReplayDrawOperations();
+		// The window already shows exactly this
+		if (WindowDataCast->DrawOperations.GetHash() == WindowDataCast->PaintedHash)
+			return;
+
+		if (ReplayDrawList(this->Data->XConnection, *this->Data->GetText(), WindowDataCast))
+			WindowDataCast->PresentBackbuffer(this->Data->XConnection);
 	}
 }
 
@@ -1106,7 +1098,7 @@ void X11XCB_DisplayServer::DrawRectangle(AuxiliaryWindow &AuxiliaryWindow, Vecto
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::DrawRectangle, WindowDataCast->CairoContext, Position, Size, LineWidth, Color, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.DrawRectangle(Position, Size, LineWidth, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1120,7 +1112,7 @@ void X11XCB_DisplayServer::FillRectangle(AuxiliaryWindow &AuxiliaryWindow, Vecto
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::FillRectangle, WindowDataCast->CairoContext, Position, Size, Color, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.FillRectangle(Position, Size, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1134,7 +1126,7 @@ void X11XCB_DisplayServer::DrawRoundedRectangle(AuxiliaryWindow &AuxiliaryWindow
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::DrawRoundedRectangle, WindowDataCast->CairoContext, Position, Size, Radius, LineWidth, Color, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.DrawRoundedRectangle(Position, Size, Radius, LineWidth, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1148,7 +1140,7 @@ void X11XCB_DisplayServer::FillRoundedRectangle(AuxiliaryWindow &AuxiliaryWindow
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::FillRoundedRectangle, WindowDataCast->CairoContext, Position, Size, Radius, Color, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.FillRoundedRectangle(Position, Size, Radius, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1162,7 +1154,7 @@ void X11XCB_DisplayServer::DrawShape(AuxiliaryWindow &AuxiliaryWindow, Shape con
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::DrawShape, WindowDataCast->CairoContext, Shape, LineWidth, Color, CloseShape, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.DrawShape(Shape, LineWidth, Color, CloseShape, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1176,7 +1168,7 @@ void X11XCB_DisplayServer::FillShape(AuxiliaryWindow &AuxiliaryWindow, Shape con
 	{
 		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(*WindowData);
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::FillShape, WindowDataCast->CairoContext, Shape, Color, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.FillShape(Shape, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
@@ -1194,64 +1186,24 @@ void  X11XCB_DisplayServer::DrawText(AuxiliaryWindow &AuxiliaryWindow, std::stri
 
 		if (WindowDataCast->FontDescriptionString != FontDescriptionString)
 		{
-			WindowDataCast->DrawOperations.push_back(std::bind(Cairo::LoadFont, WindowDataCast->Layout, FontDescriptionString));
+			WindowDataCast->DrawOperations.LoadFont(FontDescriptionString);
 			WindowDataCast->FontDescriptionString = FontDescriptionString;
 		}
 
-		WindowDataCast->DrawOperations.push_back(std::bind(Cairo::DrawText, WindowDataCast->CairoContext, WindowDataCast->Layout, Text, Position, Color, Size, (Cairo::DrawMode)Mode));
+		WindowDataCast->DrawOperations.DrawText(Text, Position, Color, (DrawList::DrawMode)Mode);
 	}
 }
 
 
 float X11XCB_DisplayServer::GetTextWidth(std::string const &FontFace, std::string const &Text, float Size)
 {
-	// We need a cairo context, so grab the first auxiliary window
-	auto WindowDataAccessor = this->Data->GetWindowData();
-
-	for (auto WindowData : *WindowDataAccessor)
-	{
-		if (AuxiliaryWindowData * const WindowDataCast = dynamic_cast<AuxiliaryWindowData *>(WindowData))
-		{
-			std::string const FontDescriptionString = GetFontDescriptionString(FontFace, Size);
-
-			Cairo::LoadFont(WindowDataCast->Layout, FontDescriptionString);
-
-			float const Return = Cairo::GetTextWidth(WindowDataCast->Layout, Text);
-
-			Cairo::LoadFont(WindowDataCast->Layout, WindowDataCast->FontDescriptionString);
-
-			return Return;
-		}
-	}
-
-	return 0.0f;
+	return this->Data->GetText()->Measure(GetFontDescriptionString(FontFace, Size), Text).Width;
 }
 
 
 float X11XCB_DisplayServer::GetTextHeight(std::string const &FontFace, std::string const &Text, float Size)
 {
-	// We need a cairo context, so grab the first auxiliary window
-	auto WindowDataAccessor = this->Data->GetWindowData();
-
-	for (auto WindowData : *WindowDataAccessor)
-	{
-		if (AuxiliaryWindowData * const WindowDataCast = dynamic_cast<AuxiliaryWindowData *>(WindowData))
-		{
-			std::string const FontDescriptionString = GetFontDescriptionString(FontFace, Size);
-
-			if (WindowDataCast->FontDescriptionString != FontDescriptionString)
-				Cairo::LoadFont(WindowDataCast->Layout, FontDescriptionString);
-
-			float const Return = Cairo::GetTextHeight(WindowDataCast->Layout, Text);
-
-			if (WindowDataCast->FontDescriptionString != FontDescriptionString)
-				Cairo::LoadFont(WindowDataCast->Layout, WindowDataCast->FontDescriptionString);
-
-			return Return;
-		}
-	}
-
-	return 0.0f;
+	return this->Data->GetText()->Measure(GetFontDescriptionString(FontFace, Size), Text).Height;
 }
 
 
@@ -1286,8 +1238,8 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 		{
 			Window *RootWindow = nullptr;
 
-			if (ClientWindow const * const WindowCast = dynamic_cast<ClientWindow const *>(&PrimaryWindow))
-				RootWindow = WindowCast->GetRootWindow();
+			if (PrimaryWindow.GetKind() == Window::Kind::CLIENT)
+				RootWindow = static_cast<ClientWindow &>(PrimaryWindow).GetRootWindow();
 			else
 				RootWindow = &PrimaryWindow;
 
@@ -1313,7 +1265,7 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 
 
 		// Sanity check
-		if (dynamic_cast<FrameWindow const *>(&AuxiliaryWindow) && !dynamic_cast<Glass::ClientWindow *>(&PrimaryWindow))
+		if (AuxiliaryWindow.GetKind() == Window::Kind::FRAME && PrimaryWindow.GetKind() != Window::Kind::CLIENT)
 		{
 			LOG_DEBUG_ERROR << "A frame can only be added to a client window!  Cannot activate auxiliary window." << std::endl;
 			return;
@@ -1326,11 +1278,12 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 		Vector const Position =	AuxiliaryWindow.GetPosition();
 		Vector const Size =		AuxiliaryWindow.GetSize();
 
-		uint32_t EventMask = XCB_EVENT_MASK_ENTER_WINDOW |
+		uint32_t EventMask = XCB_EVENT_MASK_EXPOSURE |
+							 XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW |
 							 XCB_EVENT_MASK_POINTER_MOTION |
 							 XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE;
 
-		if (dynamic_cast<FrameWindow const *>(&AuxiliaryWindow))
+		if (AuxiliaryWindow.GetKind() == Window::Kind::FRAME)
 			EventMask |= XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
 
 		uint32_t const Values[] = {
@@ -1341,13 +1294,14 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 			this->Data->XColorMap
 		};
 
-		xcb_create_window(this->Data->XConnection, this->Data->XVisualDepth,
-						  AuxiliaryWindowID, RootWindowID,
-						  Position.x, Position.y, Size.x, Size.y,
-						  0, XCB_COPY_FROM_PARENT,
-						  this->Data->XVisual->visual_id,
-						  XCB_CW_BACK_PIXEL | XCB_CW_BORDER_PIXEL | XCB_CW_OVERRIDE_REDIRECT | XCB_CW_EVENT_MASK | XCB_CW_COLORMAP,
-						  Values);
+		xcb_void_cookie_t const Cookie = xcb_create_window(this->Data->XConnection, this->Data->XVisualDepth,
+														   AuxiliaryWindowID, RootWindowID,
+														   Position.x, Position.y, Size.x, Size.y,
+														   0, XCB_COPY_FROM_PARENT,
+														   this->Data->XVisual->visual_id,
+														   XCB_CW_BACK_PIXEL | XCB_CW_BORDER_PIXEL | XCB_CW_OVERRIDE_REDIRECT | XCB_CW_EVENT_MASK | XCB_CW_COLORMAP,
+														   Values);
+		this->Data->Requests.Note("ActivateAuxiliaryWindow", Cookie.sequence);
 
 
 		// Disable events
@@ -1358,19 +1312,27 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 
 
 		// Apply the auxiliary window
-		if (FrameWindow const * const WindowCast = dynamic_cast<FrameWindow const *>(&AuxiliaryWindow))
+		if (AuxiliaryWindow.GetKind() == Window::Kind::FRAME)
 		{
+			FrameWindow const * const WindowCast = static_cast<FrameWindow const *>(&AuxiliaryWindow);
+
 			if (WindowCast->GetVisibility() == true)
 				xcb_map_window(this->Data->XConnection, AuxiliaryWindowID);
 
 			Vector const Position = WindowCast->GetULOffset() * -1;
 			xcb_reparent_window(this->Data->XConnection, PrimaryWindowID, AuxiliaryWindowID, Position.x, Position.y);
 
+			this->Data->RemoveStackedWindow(PrimaryWindowData);
+
 			static_cast<ClientWindowData *>(PrimaryWindowData)->ParentID = AuxiliaryWindowID;
+			this->Data->AddStackedWindow(PrimaryWindowData);
+			PrimaryWindowData->AppliedPosition = Position;
 			PrimaryWindowData->EventMask &= ~XCB_EVENT_MASK_ENTER_WINDOW;
 		}
-		else if (UtilityWindow const * const WindowCast = static_cast<UtilityWindow const *>(&AuxiliaryWindow))
+		else // This is a utility window
 		{
+			UtilityWindow const * const WindowCast = static_cast<UtilityWindow const *>(&AuxiliaryWindow);
+
 			if (WindowCast->GetVisibility() == true)
 				xcb_map_window(this->Data->XConnection, AuxiliaryWindowID);
 
@@ -1380,8 +1342,15 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 
 
 		// Prepare drawing surfaces
-		cairo_surface_t * const CairoSurface = cairo_xcb_surface_create(this->Data->XConnection, AuxiliaryWindowID, this->Data->XVisual, Size.x, Size.y);
-		cairo_t * const CairoContext = cairo_create(CairoSurface);
+		uint16_t const BackbufferWidth = std::max<short>(Size.x, 1);
+		uint16_t const BackbufferHeight = std::max<short>(Size.y, 1);
+
+		xcb_pixmap_t const Backbuffer = xcb_generate_id(this->Data->XConnection);
+		xcb_create_pixmap(this->Data->XConnection, this->Data->XVisualDepth, Backbuffer, AuxiliaryWindowID, BackbufferWidth, BackbufferHeight);
+
+		uint32_t const GraphicsContextValues[] = { 0 }; // No exposure events from copying the backbuffer in
+		xcb_gcontext_t const GraphicsContext = xcb_generate_id(this->Data->XConnection);
+		xcb_create_gc(this->Data->XConnection, GraphicsContext, AuxiliaryWindowID, XCB_GC_GRAPHICS_EXPOSURES, GraphicsContextValues);
 
 		// Enable events
 		EnableEvents(this->Data->XConnection, AuxiliaryWindowID, EventMask);
@@ -1391,8 +1360,16 @@ void X11XCB_DisplayServer::ActivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryWin
 
 
 		// Store window data
-		WindowDataAccessor->push_back(new AuxiliaryWindowData(AuxiliaryWindow, AuxiliaryWindowID, EventMask, PrimaryWindowData, RootWindowID,
-															  CairoSurface, CairoContext, GetFontDescriptionString(Config::FontFaceSans, Config::FontSize)));
+		Glass::AuxiliaryWindowData * const AuxiliaryWindowData = new Glass::AuxiliaryWindowData(AuxiliaryWindow, AuxiliaryWindowID, EventMask, PrimaryWindowData, RootWindowID,
+																							   Backbuffer, this->Data->XVisual, this->Data->XVisualDepth, GraphicsContext,
+																							   GetFontDescriptionString(Config::FontFaceSans, Config::FontSize));
+		AuxiliaryWindowData->CreateSurface(this->Data->XConnection, this->Data->SharedMemory);
+
+		WindowDataAccessor->push_back(AuxiliaryWindowData);
+		this->Data->AddStackedWindow(AuxiliaryWindowData);
+
+		if (AuxiliaryWindow.GetKind() == Window::Kind::FRAME)
+			static_cast<ClientWindowData *>(PrimaryWindowData)->FrameData = AuxiliaryWindowData;
 	}
 	else
 		LOG_DEBUG_ERROR << "Auxiliary window already exists on the server!  Cannot activate auxiliary window." << std::endl;
@@ -1419,10 +1396,13 @@ void X11XCB_DisplayServer::DeactivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryW
 
 
 		// Disable events
-		xcb_grab_server(this->Data->XConnection);
+		xcb_void_cookie_t const Cookie = xcb_grab_server(this->Data->XConnection);
+		this->Data->Requests.Note("DeactivateAuxiliaryWindow", Cookie.sequence);
 
-		if (ClientWindowData * const PrimaryWindowDataCast = dynamic_cast<ClientWindowData *>(PrimaryWindowData))
+		if (PrimaryWindowData->Kind == Window::Kind::CLIENT)
 		{
+			ClientWindowData * const PrimaryWindowDataCast = static_cast<ClientWindowData *>(PrimaryWindowData);
+
 			if (!PrimaryWindowDataCast->Destroyed)
 				DisableEvents(this->Data->XConnection, PrimaryWindowID);
 		}
@@ -1431,31 +1411,46 @@ void X11XCB_DisplayServer::DeactivateAuxiliaryWindow(AuxiliaryWindow &AuxiliaryW
 
 
 		// Destroy the drawing surfaces
-		cairo_destroy(AuxiliaryWindowData->CairoContext);
-		cairo_surface_destroy(AuxiliaryWindowData->CairoSurface);
+		AuxiliaryWindowData->DestroySurface(this->Data->XConnection);
+
+		xcb_free_gc(this->Data->XConnection, AuxiliaryWindowData->GraphicsContext);
+		xcb_free_pixmap(this->Data->XConnection, AuxiliaryWindowData->Backbuffer);
 
 
 		// Destroy the auxiliary window
-		if (dynamic_cast<FrameWindow *>(&AuxiliaryWindow))
+		this->Data->RemoveStackedWindow(AuxiliaryWindowData);
+
+		if (AuxiliaryWindow.GetKind() == Window::Kind::FRAME)
 		{
 			ClientWindowData * const PrimaryWindowDataCast = static_cast<ClientWindowData *>(PrimaryWindowData); // Only client windows have frames
 
+			this->Data->RemoveStackedWindow(PrimaryWindowDataCast);
+
 			if (!PrimaryWindowDataCast->Destroyed)
 			{
 				Vector const Position = PrimaryWindow.GetPosition();
 				xcb_reparent_window(this->Data->XConnection, PrimaryWindowID, RootWindowID, Position.x, Position.y);
+
+				PrimaryWindowDataCast->AppliedPosition = Position;
+				PrimaryWindowDataCast->AppliedRootPosition = Position;
 			}
 
 			PrimaryWindowDataCast->ParentID = XCB_NONE;
+			PrimaryWindowDataCast->FrameData = nullptr;
 			PrimaryWindowDataCast->EventMask |= XCB_EVENT_MASK_ENTER_WINDOW;
+
+			if (!PrimaryWindowDataCast->Destroyed)
+				this->Data->AddStackedWindow(PrimaryWindowDataCast);
 		}
 
 		xcb_destroy_window(this->Data->XConnection, AuxiliaryWindowData->ID);
 
 
 		// Enable events
-		if (ClientWindowData * const PrimaryWindowDataCast = dynamic_cast<ClientWindowData *>(PrimaryWindowData))
+		if (PrimaryWindowData->Kind == Window::Kind::CLIENT)
 		{
+			ClientWindowData * const PrimaryWindowDataCast = static_cast<ClientWindowData *>(PrimaryWindowData);
+
 			if (!PrimaryWindowDataCast->Destroyed)
 				EnableEvents(this->Data->XConnection, PrimaryWindowID, PrimaryWindowData->EventMask);
 		}
@@ -20,6 +20,8 @@
 #ifndef GLASS_DISPLAYSERVER_X11XCB_DISPLAYSERVER
 #define GLASS_DISPLAYSERVER_X11XCB_DISPLAYSERVER
 
+#include <cstdint>
+
 #include "glass/core/DisplayServer.hpp"
 
 namespace Glass
@@ -36,6 +38,8 @@ namespace Glass
 		Vector GetMousePosition();
 		void   SetMousePosition(Vector const &Position);
 
+		uint64_t GetPointerQueryCount() const; // How often GetMousePosition couldn't answer from pointer events
+
 	protected:
 		// XXX Make it safe to call these on windows that have not been deleted but that no longer exist on the server
 
@@ -0,0 +1,220 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <string.h> // memcpy
+
+#include "glass/displayserver/x11xcb_displayserver/DrawList.hpp"
+
+using namespace Glass;
+
+
+DrawList::const_iterator DrawList::begin() const	{ return this->Commands.begin(); }
+DrawList::const_iterator DrawList::end() const		{ return this->Commands.end(); }
+
+
+void DrawList::clear()
+{
+	this->Commands.clear();
+	this->Data.clear();
+}
+
+
+// FNV-1a over the commands and their data
+uint64_t DrawList::GetHash() const
+{
+	uint64_t Hash = 0xCBF29CE484222325ull;
+
+	unsigned char const * const CommandBytes = reinterpret_cast<unsigned char const *>(this->Commands.data());
+	for (size_t Index = 0; Index < this->Commands.size() * sizeof(Command); Index++)
+		Hash = (Hash ^ CommandBytes[Index]) * 0x100000001B3ull;
+
+	for (char const Byte : this->Data)
+		Hash = (Hash ^ (unsigned char)Byte) * 0x100000001B3ull;
+
+	return Hash;
+}
+
+
+char const *DrawList::GetText(Command const &Command) const
+{
+	return this->Data.data() + Command.DataOffset;
+}
+
+
+DrawList::ShapeElement const *DrawList::GetShapeElements(Command const &Command) const
+{
+	return reinterpret_cast<ShapeElement const *>(this->Data.data() + Command.DataOffset);
+}
+
+
+void DrawList::Clear(Glass::Color const &Color)
+{
+	this->AddCommand(Opcode::CLEAR_WINDOW, DrawMode::REPLACE, Color);
+}
+
+
+void DrawList::LoadFont(std::string const &FontDescriptionString)
+{
+	Command &NewCommand = this->AddCommand(Opcode::LOAD_FONT, DrawMode::REPLACE, Glass::Color());
+
+	// Kept null terminated for pango
+	this->AddData(NewCommand, FontDescriptionString.c_str(), FontDescriptionString.size() + 1);
+}
+
+
+void DrawList::DrawRectangle(Vector const &Position, Vector const &Size, float LineWidth, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::DRAW_RECTANGLE, Mode, Color);
+
+	DrawList::SetGeometry(NewCommand, Position, Size);
+	NewCommand.LineWidth = LineWidth;
+}
+
+
+void DrawList::FillRectangle(Vector const &Position, Vector const &Size, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::FILL_RECTANGLE, Mode, Color);
+
+	DrawList::SetGeometry(NewCommand, Position, Size);
+}
+
+
+void DrawList::DrawRoundedRectangle(Vector const &Position, Vector const &Size, float Radius, float LineWidth, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::DRAW_ROUNDED_RECTANGLE, Mode, Color);
+
+	DrawList::SetGeometry(NewCommand, Position, Size);
+	NewCommand.Radius = Radius;
+	NewCommand.LineWidth = LineWidth;
+}
+
+
+void DrawList::FillRoundedRectangle(Vector const &Position, Vector const &Size, float Radius, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::FILL_ROUNDED_RECTANGLE, Mode, Color);
+
+	DrawList::SetGeometry(NewCommand, Position, Size);
+	NewCommand.Radius = Radius;
+}
+
+
+void DrawList::DrawShape(Shape const &Shape, float LineWidth, Glass::Color const &Color, bool CloseShape, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::DRAW_SHAPE, Mode, Color);
+
+	NewCommand.LineWidth = LineWidth;
+	NewCommand.CloseShape = CloseShape;
+
+	this->AddShape(NewCommand, Shape);
+}
+
+
+void DrawList::FillShape(Shape const &Shape, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::FILL_SHAPE, Mode, Color);
+
+	this->AddShape(NewCommand, Shape);
+}
+
+
+void DrawList::DrawText(std::string const &Text, Vector const &Position, Glass::Color const &Color, DrawMode Mode)
+{
+	Command &NewCommand = this->AddCommand(Opcode::DRAW_TEXT, Mode, Color);
+
+	DrawList::SetGeometry(NewCommand, Position, Vector());
+
+	this->AddData(NewCommand, Text.data(), Text.size());
+}
+
+
+DrawList::Command &DrawList::AddCommand(Opcode Code, DrawMode Mode, Glass::Color const &Color)
+{
+	// Value initialized, so unused fields are zero and hash the same every time
+	this->Commands.push_back(Command());
+
+	Command &NewCommand = this->Commands.back();
+
+	NewCommand.Code = Code;
+	NewCommand.Mode = Mode;
+	NewCommand.R = Color.R;
+	NewCommand.G = Color.G;
+	NewCommand.B = Color.B;
+	NewCommand.A = Color.A;
+
+	return NewCommand;
+}
+
+
+void DrawList::SetGeometry(Command &Command, Vector const &Position, Vector const &Size)
+{
+	Command.X = Position.x;
+	Command.Y = Position.y;
+	Command.Width = Size.x;
+	Command.Height = Size.y;
+}
+
+
+void DrawList::AddData(Command &Command, void const *Data, size_t Length)
+{
+	// Every entry starts aligned, in case it holds shape elements
+	size_t const Offset = (this->Data.size() + alignof(ShapeElement) - 1) & ~(alignof(ShapeElement) - 1);
+
+	this->Data.resize(Offset + Length);
+
+	// Without data, the space is left for the caller to fill
+	if (Data != nullptr && Length != 0)
+		memcpy(this->Data.data() + Offset, Data, Length);
+
+	Command.DataOffset = Offset;
+	Command.DataLength = Length;
+}
+
+
+void DrawList::AddShape(Command &Command, Shape const &Shape)
+{
+	this->AddData(Command, nullptr, Shape.size() * sizeof(ShapeElement));
+
+	ShapeElement *NewElement = reinterpret_cast<ShapeElement *>(this->Data.data() + Command.DataOffset);
+
+	for (auto Element : Shape)
+	{
+		NewElement->Type = Element->GetType();
+
+		if (NewElement->Type == Shape::Element::Type::POINT)
+		{
+			Shape::Point const &Point = static_cast<Shape::Point const &>(*Element);
+
+			NewElement->Values[0] = Point.X;
+			NewElement->Values[1] = Point.Y;
+			NewElement->Values[2] = NewElement->Values[3] = NewElement->Values[4] = 0.0f;
+		}
+		else
+		{
+			Shape::Arc const &Arc = static_cast<Shape::Arc const &>(*Element);
+
+			NewElement->Values[0] = Arc.CenterX;
+			NewElement->Values[1] = Arc.CenterY;
+			NewElement->Values[2] = Arc.Radius;
+			NewElement->Values[3] = Arc.StartAngle;
+			NewElement->Values[4] = Arc.EndAngle;
+		}
+
+		NewElement++;
+	}
+}
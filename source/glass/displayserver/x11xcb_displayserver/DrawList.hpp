@@ -0,0 +1,109 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_X11XCB_DISPLAYSERVER_DRAWLIST
+#define GLASS_X11XCB_DISPLAYSERVER_DRAWLIST
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glass/core/Color.hpp"
+#include "glass/core/Shape.hpp"
+#include "glass/core/Vector.hpp"
+
+namespace Glass
+{
+	// An auxiliary window's drawing, recorded as fixed-size commands.  Shape elements and text are copied into a separate
+	// data area and referred to by offset.  Clearing keeps the storage, so after the first few frames recording a window's
+	// drawing doesn't allocate, and a frame identical to the last one can be recognized by its hash.
+	class DrawList
+	{
+	public:
+		enum class Opcode : uint8_t { CLEAR_WINDOW,
+									  LOAD_FONT,
+									  DRAW_RECTANGLE,
+									  FILL_RECTANGLE,
+									  DRAW_ROUNDED_RECTANGLE,
+									  FILL_ROUNDED_RECTANGLE,
+									  DRAW_SHAPE,
+									  FILL_SHAPE,
+									  DRAW_TEXT };
+
+		enum class DrawMode : uint8_t { OVERLAY,
+										REPLACE };
+
+		struct Command
+		{
+			Opcode		Code;
+			DrawMode	Mode;
+			bool		CloseShape;
+			uint8_t		Unused;
+
+			short		X, Y;
+			short		Width, Height;
+			float		LineWidth;
+			float		Radius;
+			float		R, G, B, A;
+
+			uint32_t	DataOffset; // Shape elements, text or a font description
+			uint32_t	DataLength;
+		};
+		static_assert(sizeof(Command) == 44, "Commands are hashed byte by byte, so they can't have padding");
+
+		struct ShapeElement
+		{
+			Shape::Element::Type	Type;
+			float					Values[5]; // X and Y for points; center X and Y, radius, start and end angles for arcs
+		};
+
+		typedef std::vector<Command>::const_iterator const_iterator;
+
+		const_iterator	begin() const;
+		const_iterator	end() const;
+
+		void			clear();
+		uint64_t		GetHash() const;
+
+		char const			   *GetText(Command const &Command) const;
+		ShapeElement const	   *GetShapeElements(Command const &Command) const;
+
+		// Recording
+		void Clear(Glass::Color const &Color);
+		void LoadFont(std::string const &FontDescriptionString);
+		void DrawRectangle(Vector const &Position, Vector const &Size, float LineWidth, Glass::Color const &Color, DrawMode Mode);
+		void FillRectangle(Vector const &Position, Vector const &Size, Glass::Color const &Color, DrawMode Mode);
+		void DrawRoundedRectangle(Vector const &Position, Vector const &Size, float Radius, float LineWidth, Glass::Color const &Color, DrawMode Mode);
+		void FillRoundedRectangle(Vector const &Position, Vector const &Size, float Radius, Glass::Color const &Color, DrawMode Mode);
+		void DrawShape(Shape const &Shape, float LineWidth, Glass::Color const &Color, bool CloseShape, DrawMode Mode);
+		void FillShape(Shape const &Shape, Glass::Color const &Color, DrawMode Mode);
+		void DrawText(std::string const &Text, Vector const &Position, Glass::Color const &Color, DrawMode Mode);
+
+	private:
+		Command	   &AddCommand(Opcode Code, DrawMode Mode, Glass::Color const &Color);
+		static void	SetGeometry(Command &Command, Vector const &Position, Vector const &Size);
+		void		AddData(Command &Command, void const *Data, size_t Length);
+		void		AddShape(Command &Command, Shape const &Shape);
+
+		std::vector<Command>	Commands;
+		std::vector<char>		Data;
+	};
+}
+
+#endif
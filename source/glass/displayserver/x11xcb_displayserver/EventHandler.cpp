@@ -17,23 +17,34 @@
 * Copyright 2014-2015 Chris Foster
 */
 
-#include <sys/select.h>
+#include <algorithm>
+#include <errno.h>
+#include <string.h> // strerror
+#include <sys/epoll.h>
+#include <unistd.h>
 
+#include <xcb/shm.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_aux.h>
 #include <xcb/xcb_event.h>
 #include <xcb/xcb_ewmh.h>
 #include <xcb/xcb_icccm.h>
 
+#include "config.hpp"
 #include "glass/core/Event.hpp"
 #include "glass/core/EventQueue.hpp"
 #include "glass/core/Log.hpp"
 #include "glass/displayserver/x11xcb_displayserver/EventHandler.hpp"
 #include "glass/displayserver/x11xcb_displayserver/InputTranslator.hpp"
+#include "glass/displayserver/x11xcb_displayserver/PointerTracker.hpp"
 #include "util/scoped_free.hpp"
+#include "util/timestamp.hpp"
 
 using namespace Glass;
 
+bool ReplayDrawList(xcb_connection_t *XConnection, TextCache &Text, AuxiliaryWindowData *WindowData); // Defined in X11XCB_DisplayServer.cpp
+
+
 X11XCB_DisplayServer::Implementation::EventHandler::EventHandler(X11XCB_DisplayServer::Implementation &Owner) :
 	Owner(Owner),
 	Worker(&EventHandler::Listen, this)
@@ -51,50 +62,200 @@ X11XCB_DisplayServer::Implementation::EventHandler::~EventHandler()
 }
 
 
-scoped_free<xcb_generic_event_t *> WaitForEvent(xcb_connection_t *XConnection)
+void X11XCB_DisplayServer::Implementation::EventHandler::Wake()
 {
-	thread_local bool DescriptorOpen = false;
+	this->Worker.wake();
+}
 
-	xcb_generic_event_t *Event = nullptr;
 
-	if (!DescriptorOpen)
+// Sleeps until the X connection has something to read or the thread is interrupted, with no wakeups in between
+struct EventReactor
+{
+	EventReactor(xcb_connection_t *XConnection) :
+		Descriptor(epoll_create1(EPOLL_CLOEXEC))
 	{
-		int XCBFileDescriptor = xcb_get_file_descriptor(XConnection);
-		fd_set FileDescriptors;
+		if (this->Descriptor == -1)
+		{
+			LOG_FATAL << "Could not create an epoll instance for the X connection!" << std::endl;
+			exit(1);
+		}
 
-		struct timespec Timeout = { 0, 250000000 }; // Check for interruptions every 0.25 seconds
+		this->Watch(xcb_get_file_descriptor(XConnection));
+		this->Watch(interruptible<std::thread>::wake_descriptor());
+	}
 
-		while (true)
-		{
-			interruptible<std::thread>::check();
 
-			FD_ZERO(&FileDescriptors);
-			FD_SET(XCBFileDescriptor, &FileDescriptors);
+	~EventReactor()
+	{
+		close(this->Descriptor);
+	}
 
-			if (pselect(XCBFileDescriptor + 1, &FileDescriptors, nullptr, nullptr, &Timeout, nullptr) > 0)
-			{
-				DescriptorOpen = true;
 
-				if ((Event = xcb_poll_for_event(XConnection)))
-					break;
-			}
-		}
+	void Watch(int FileDescriptor)
+	{
+		if (FileDescriptor == -1)
+			return;
+
+		struct epoll_event Event;
+
+		Event.events = EPOLLIN;
+		Event.data.fd = FileDescriptor;
+
+		epoll_ctl(this->Descriptor, EPOLL_CTL_ADD, FileDescriptor, &Event);
 	}
-	else
+
+
+	void Wait()
 	{
-		if ((Event = xcb_poll_for_event(XConnection)) == nullptr)
+		struct epoll_event Events[2];
+
+		int const Count = epoll_wait(this->Descriptor, Events, 2, -1);
+
+		if (Count == -1 && errno != EINTR)
+			LOG_DEBUG_ERROR << "Waiting for X events failed: " << strerror(errno) << std::endl;
+
+		// Woken so events another thread read in get handled
+		for (int i = 0; i < Count; i++)
+			if (Events[i].data.fd == interruptible<std::thread>::wake_descriptor())
+				interruptible<std::thread>::clear_wake();
+	}
+
+
+	int const Descriptor;
+};
+
+
+// Returns the next event that has already been read from the connection, or nullptr if there isn't one yet.
+// A run of pointer motion that's already been read is collapsed into the newest position, holding on to the first
+// unrelated event for the next call.
+xcb_generic_event_t *PollForEvent(xcb_connection_t *XConnection)
+{
+	thread_local xcb_generic_event_t *DeferredEvent = nullptr;
+
+	xcb_generic_event_t *Event = nullptr;
+
+	if (DeferredEvent != nullptr)
+	{
+		Event = DeferredEvent;
+		DeferredEvent = nullptr;
+	}
+	else if ((Event = xcb_poll_for_event(XConnection)) == nullptr)
+		return nullptr;
+
+	if (XCB_EVENT_RESPONSE_TYPE(Event) == XCB_MOTION_NOTIFY)
+	{
+		while (xcb_generic_event_t * const NextEvent = xcb_poll_for_queued_event(XConnection))
 		{
-			DescriptorOpen = false;
-			return WaitForEvent(XConnection);
+			if (XCB_EVENT_RESPONSE_TYPE(NextEvent) != XCB_MOTION_NOTIFY ||
+				((xcb_motion_notify_event_t *)NextEvent)->event != ((xcb_motion_notify_event_t *)Event)->event)
+			{
+				DeferredEvent = NextEvent;
+				break;
+			}
+
+			free(Event);
+			Event = NextEvent;
 		}
 	}
 
+	return Event;
+}
+
+
+// Sleeps until the connection has something to read, returning false if it was lost instead
+bool SleepUntilReadable(xcb_connection_t *XConnection)
+{
+	thread_local EventReactor Reactor(XConnection);
+
 	interruptible<std::thread>::check();
 
+	if (xcb_connection_has_error(XConnection))
+	{
+		LOG_DEBUG_ERROR << "The X connection was lost!" << std::endl;
+		return false;
+	}
+
+	Reactor.Wait();
+	return true;
+}
+
+
+// Also used by the input listener, on its own connection
+scoped_free<xcb_generic_event_t *> WaitForEvent(xcb_connection_t *XConnection)
+{
+	xcb_generic_event_t *Event = nullptr;
+
+	// Events may already be queued, read in while waiting for a reply
+	while ((Event = PollForEvent(XConnection)) == nullptr)
+	{
+		xcb_flush(XConnection);
+
+		if (!SleepUntilReadable(XConnection))
+			return nullptr;
+	}
+
+	interruptible<std::thread>::check();
+
+	// Whatever this event turns into is stamped with when it got here, so latencies include translating it
+	EventQueue::SetArrivalTime(timestamp());
+
 	return Event;
 }
 
 
+scoped_free<xcb_generic_event_t *> X11XCB_DisplayServer::Implementation::EventHandler::WaitForEvent()
+{
+	xcb_connection_t * const XConnection = this->Owner.XConnection;
+
+	// Property replies come in on the same connection, and may have been read in by another thread's blocking call, so
+	// they're picked up after every event as well as before going to sleep.
+	this->Owner.CollectClientProperties();
+
+	xcb_generic_event_t *Event = nullptr;
+
+	while ((Event = PollForEvent(XConnection)) == nullptr)
+	{
+		this->Owner.CollectClientProperties();
+		xcb_flush(XConnection);
+
+		if (!SleepUntilReadable(XConnection))
+			return nullptr;
+	}
+
+	interruptible<std::thread>::check();
+
+	EventQueue::SetArrivalTime(timestamp());
+
+	return Event;
+}
+
+
+void GrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow, std::map<Input, EventRecord> &BindingMap)
+{
+	BindingMap.clear();
+
+	for (auto &Binding : Config::InputBindings)
+	{
+		XInput Condition = InputTranslator::ToX(Binding.second);
+
+		if (Condition.Type == Input::Type::KEYBOARD)
+			xcb_grab_key(XConnection, true, RootWindow, Condition.ModifierState, Condition.Value.KeyCode, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+		else
+			xcb_grab_button(XConnection, true, RootWindow, XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION,
+							XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_SYNC, XCB_NONE, XCB_NONE, Condition.Value.Button, Condition.ModifierState);
+
+		BindingMap.insert(std::make_pair(Binding.second, Binding.first));
+	}
+}
+
+
+void UngrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow)
+{
+	xcb_ungrab_key(XConnection, XCB_GRAB_ANY, RootWindow, XCB_BUTTON_MASK_ANY);
+	xcb_ungrab_button(XConnection, XCB_BUTTON_INDEX_ANY, RootWindow, XCB_MOD_MASK_ANY);
+}
+
+
 std::string GetWindowName(xcb_connection_t *XConnection, xcb_window_t WindowID); // Defined in Implementation.cpp
 
 
@@ -102,10 +263,20 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Listen()
 {
 	InputTranslator::Initialize(this->Owner.XConnection);
 
+	if (Config::DisplayServerInputBindings)
+	{
+		GrabBindings(this->Owner.XConnection, this->Owner.XScreen->root, this->BindingMap);
+		xcb_flush(this->Owner.XConnection);
+	}
+
 	try
 	{
-		while (scoped_free<xcb_generic_event_t *> Event = WaitForEvent(this->Owner.XConnection))
+		while (scoped_free<xcb_generic_event_t *> Event = this->WaitForEvent())
+		{
 			this->Handle(*Event);
+
+			this->Owner.Requests.Retire((*Event)->full_sequence);
+		}
 	}
 	catch (interrupted_exception const &e)
 	{ }
@@ -123,9 +294,46 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 		{
 			xcb_generic_error_t *Error = (xcb_generic_error_t *)Event;
 
-			LOG_DEBUG_INFO_NOHEADER << " - Error: " << xcb_event_get_error_label(Error->error_code) << ", " <<
-													   xcb_event_get_request_label(Error->major_code) << ", " << (int)Error->minor_code << ", " <<
-													   (unsigned int)Error->resource_id;
+			LOG_DEBUG_INFO_NOHEADER << " - Error" << std::endl;
+
+			// Nothing waits on its requests, so this is the only place their errors are seen
+			LOG_WARNING << "X Error: " <<
+						   "Request Label = " << xcb_event_get_request_label(Error->major_code) << ", " <<
+						   "Error Label = " << xcb_event_get_error_label(Error->error_code) << ", " <<
+						   "Resource = " << (unsigned int)Error->resource_id << ", " <<
+						   "From " << this->Owner.Requests.GetOrigin(Error->full_sequence) << std::endl;
+
+			if (!this->Owner.SharedMemory)
+				break;
+
+			// A shared image the server couldn't attach or read would never finish uploading, so the window would never be
+			// redrawn.  It's drawn through the server from then on.
+			auto WindowDataAccessor = this->Owner.GetWindowData();
+			for (auto WindowData : *WindowDataAccessor)
+			{
+				if (WindowData->Kind != Window::Kind::FRAME && WindowData->Kind != Window::Kind::UTILITY)
+					continue;
+
+				AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData);
+				AuxiliaryWindowData::SharedImage const &Image = WindowDataCast->Image;
+
+				bool const AttachFailed = Image.Segment != XCB_NONE && Image.AttachSequence == Error->full_sequence;
+				bool const UploadFailed = Image.UploadSequence != 0 && Image.UploadSequence == Error->full_sequence;
+
+				if (!AttachFailed && !UploadFailed)
+					continue;
+
+				LOG_WARNING << "The server could not use the shared image of auxiliary window " << WindowDataCast->ID <<
+							   "; drawing it through the server instead." << std::endl;
+
+				WindowDataCast->AbandonSharedImage(this->Owner.XConnection, !AttachFailed);
+
+				if (ReplayDrawList(this->Owner.XConnection, *this->Owner.GetText(), WindowDataCast))
+					WindowDataCast->PresentBackbuffer(this->Owner.XConnection);
+
+				xcb_flush(this->Owner.XConnection);
+				break;
+			}
 		}
 		break;
 	case XCB_CREATE_NOTIFY:
@@ -155,8 +363,11 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 		{
 			xcb_motion_notify_event_t * const MotionNotify = (xcb_motion_notify_event_t *)Event;
 
-			this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new PointerMove_Event(Vector(MotionNotify->root_x,
-																								 MotionNotify->root_y))));
+			// Motion that reached a child first might not have reached us at all, unless we have the pointer grabbed
+			PointerTracker::Set(MotionNotify->root_x, MotionNotify->root_y, MotionNotify->child == XCB_NONE);
+
+			this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(PointerMove_Event(Vector(MotionNotify->root_x,
+																						   MotionNotify->root_y)));
 		}
 		break;
 
@@ -176,11 +387,28 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 									   KeyPress->child << ", " << KeyPress->event << " at " <<
 									   KeyPress->root_x << ", " << KeyPress->root_y;
 
+			PointerTracker::NoteInput(Event);
+
+			// Button grabs freeze the keyboard until the button is released, whether or not the release is bound itself
+			if (Config::DisplayServerInputBindings && XCB_EVENT_RESPONSE_TYPE(Event) == XCB_BUTTON_RELEASE)
+			{
+				xcb_allow_events(this->Owner.XConnection, XCB_ALLOW_SYNC_KEYBOARD, XCB_CURRENT_TIME);
+				xcb_flush(this->Owner.XConnection);
+			}
+
 			Glass::Input Input = InputTranslator::ToGlass(Event);
 
 			if (!Input.IsValid())
 				break;
 
+			// Bindings are grabbed on the root, so they're seen here before any window's own input
+			auto Binding = this->BindingMap.find(Input);
+			if (Binding != this->BindingMap.end())
+			{
+				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(Binding->second);
+				break;
+			}
+
 			auto WindowDataAccessor = this->Owner.GetWindowData();
 
 			auto WindowData = WindowDataAccessor->find(KeyPress->event);
@@ -189,7 +417,7 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				Window &EventWindow = (*WindowData)->Window;
 				Vector const Position = Vector(KeyPress->root_x, KeyPress->root_y);
 
-				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new Input_Event(EventWindow, Input, Position)));
+				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(Input_Event(EventWindow, Input, Position));
 			}
 		}
 		break;
@@ -209,6 +437,7 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				xcb_window_t const WindowID = PropertyNotify->window;
 				LOG_DEBUG_INFO_NOHEADER << " on " << WindowID;
 
+#ifdef GLASS_DEBUG
 				{
 					xcb_get_atom_name_cookie_t const AtomNameCookie = xcb_get_atom_name_unchecked(this->Owner.XConnection, PropertyNotify->atom);
 
@@ -221,49 +450,37 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 						free(AtomNameReply);
 					}
 				}
+#endif
 
-				if (ClientWindowData * const WindowDataCast = dynamic_cast<ClientWindowData *>(*WindowData))
+				if ((*WindowData)->Kind == Window::Kind::CLIENT)
 				{
+					ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(*WindowData);
+
 					if (WindowDataCast->Destroyed)
 						break;
 
-					ClientWindow &EventWindow = static_cast<ClientWindow &>(WindowDataCast->Window);
-
-					if (PropertyNotify->atom == Atoms::WM_HINTS)
-					{
-						xcb_icccm_wm_hints_t	  WMHints;
-						xcb_get_property_cookie_t WMHintsCookie = xcb_icccm_get_wm_hints_unchecked(this->Owner.XConnection, WindowID);
-
-						if (!xcb_icccm_get_wm_hints_reply(this->Owner.XConnection, WMHintsCookie, &WMHints, nullptr))
-							break;
-
-						if ((bool)(WMHints.flags & XCB_ICCCM_WM_HINT_X_URGENCY) != WindowDataCast->Urgent)
-						{
-							WindowDataCast->Urgent = !WindowDataCast->Urgent;
-
-							this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*new ClientUrgencyChange_Event(EventWindow, WindowDataCast->Urgent));
-						}
-					}
-					else if (PropertyNotify->atom == Atoms::WM_NAME || PropertyNotify->atom == Atoms::_NET_WM_NAME)
-					{
-						this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*new PrimaryNameChange_Event(EventWindow, GetWindowName(this->Owner.XConnection, WindowID)));
-					}
+					// Name, hints and protocol changes are reported once CollectClientProperties has the new value
+					this->Owner.RefreshClientProperty(WindowDataCast, PropertyNotify->atom);
 				}
-				else if (RootWindowData * const WindowDataCast = dynamic_cast<RootWindowData *>(*WindowData))
+				else if ((*WindowData)->Kind == Window::Kind::ROOT)
 				{
+					RootWindowData * const WindowDataCast = static_cast<RootWindowData *>(*WindowData);
+
 					RootWindow &EventWindow = static_cast<RootWindow &>(WindowDataCast->Window);
 
 					if (PropertyNotify->atom == Atoms::WM_NAME)
 					{
-						this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*new PrimaryNameChange_Event(EventWindow, GetWindowName(this->Owner.XConnection, WindowID)));
+						this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(PrimaryNameChange_Event(EventWindow, GetWindowName(this->Owner.XConnection, WindowID)));
 					}
 					else if (PropertyNotify->atom == Atoms::XFree86_has_VT)
 					{
 						for (auto WindowData : *WindowDataAccessor)
 						{
-							if (AuxiliaryWindowData * const WindowDataCast = dynamic_cast<AuxiliaryWindowData *>(WindowData))
-								WindowDataCast->ReplayDrawOperations();
+							if (WindowData->Kind == Window::Kind::FRAME || WindowData->Kind == Window::Kind::UTILITY)
+								static_cast<AuxiliaryWindowData *>(WindowData)->PresentBackbuffer(this->Owner.XConnection);
 						}
+
+						xcb_flush(this->Owner.XConnection);
 					}
 				}
 			}
@@ -271,6 +488,27 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 		break;
 
 
+	case XCB_EXPOSE:
+		{
+			xcb_expose_event_t * const Expose = (xcb_expose_event_t *)Event;
+
+			LOG_DEBUG_INFO_NOHEADER << " - Expose on " << Expose->window;
+
+			auto WindowDataAccessor = this->Owner.GetWindowData();
+
+			// The backbuffer already has what belongs there
+			auto WindowData = WindowDataAccessor->find(Expose->window);
+			if (WindowData != WindowDataAccessor->end() && ((*WindowData)->Kind == Window::Kind::FRAME || (*WindowData)->Kind == Window::Kind::UTILITY))
+			{
+				static_cast<AuxiliaryWindowData *>(*WindowData)->PresentBackbuffer(this->Owner.XConnection, Expose->x, Expose->y, Expose->width, Expose->height);
+
+				if (Expose->count == 0)
+					xcb_flush(this->Owner.XConnection);
+			}
+		}
+		break;
+
+
 	case XCB_CONFIGURE_REQUEST:
 		{
 			xcb_configure_request_event_t * const ConfigureRequest = (xcb_configure_request_event_t *)Event;
@@ -285,10 +523,13 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 
 			// If we know about the client already, send the geometry portion of the request to the window manager
 			auto WindowData = WindowDataAccessor->find(ConfigureRequest->window);
-			if (WindowData != WindowDataAccessor->end() && dynamic_cast<ClientWindowData const *>(*WindowData))
+			if (WindowData != WindowDataAccessor->end() && (*WindowData)->Kind == Window::Kind::CLIENT)
 			{
 				ClientWindow &EventWindow = static_cast<ClientWindow &>((*WindowData)->Window);
 
+				// Whatever the window manager decides, the client is owed a ConfigureNotify
+				static_cast<ClientWindowData *>(*WindowData)->ConfigureRequestPending = true;
+
 				unsigned char ValueMask = (ConfigureRequest->value_mask & XCB_CONFIG_WINDOW_X ?		 ClientGeometryChangeRequest_Event::Values::POSITION_X : 0) |
 										  (ConfigureRequest->value_mask & XCB_CONFIG_WINDOW_Y ?		 ClientGeometryChangeRequest_Event::Values::POSITION_Y : 0) |
 										  (ConfigureRequest->value_mask & XCB_CONFIG_WINDOW_WIDTH ?	 ClientGeometryChangeRequest_Event::Values::SIZE_X : 0) |
@@ -300,7 +541,7 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				Vector const RequestedSize(ConfigureRequest->value_mask & XCB_CONFIG_WINDOW_WIDTH ? ConfigureRequest->width : 0,
 										   ConfigureRequest->value_mask & XCB_CONFIG_WINDOW_HEIGHT ? ConfigureRequest->height : 0);
 
-				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientGeometryChangeRequest_Event(EventWindow, ValueMask, RequestedPosition, RequestedSize)));
+				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientGeometryChangeRequest_Event(EventWindow, ValueMask, RequestedPosition, RequestedSize));
 			}
 			else // Otherwise, configure it along with everything else
 			{
@@ -340,12 +581,17 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 			{
 				ConfigureMask |= XCB_CONFIG_WINDOW_STACK_MODE;
 				ConfigureValues.push_back(ConfigureRequest->stack_mode);
+
+				// The server's order is no longer the one we sent
+				if (WindowData != WindowDataAccessor->end())
+					this->Owner.ResetStackingOrder(*WindowData);
 			}
 
 			if (!ConfigureValues.empty())
 			{
-				xcb_configure_window(this->Owner.XConnection, ConfigureRequest->window, ConfigureMask, &ConfigureValues.front());
-				xcb_aux_sync(this->Owner.XConnection);
+				xcb_void_cookie_t const Cookie = xcb_configure_window(this->Owner.XConnection, ConfigureRequest->window, ConfigureMask, &ConfigureValues.front());
+				this->Owner.Requests.Note("ConfigureRequest", Cookie.sequence);
+				xcb_flush(this->Owner.XConnection);
 			}
 		}
 		break;
@@ -365,11 +611,13 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				ClientWindowList ClientWindows = this->Owner.CreateClientWindows({ MapRequest->window });
 
 				for (auto &ClientWindow : ClientWindows)
-					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientCreate_Event(*ClientWindow)));
+					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientCreate_Event(*ClientWindow));
 			}
-			else if (ClientWindowData const * const WindowDataCast = dynamic_cast<ClientWindowData const *>(*WindowData))
+			else if ((*WindowData)->Kind == Window::Kind::CLIENT)
 			{
-				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientIconifiedRequest_Event(static_cast<ClientWindow &>(WindowDataCast->Window), false)));
+				ClientWindowData const * const WindowDataCast = static_cast<ClientWindowData const *>(*WindowData);
+
+				this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientIconifiedRequest_Event(static_cast<ClientWindow &>(WindowDataCast->Window), false));
 			}
 		}
 		break;
@@ -387,11 +635,29 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 			auto WindowData = WindowDataAccessor->find(DestroyNotify->window);
 			if (WindowData != WindowDataAccessor->end())
 			{
-				if (ClientWindowData * const WindowDataCast = dynamic_cast<ClientWindowData *>(*WindowData))
+				if ((*WindowData)->Kind == Window::Kind::CLIENT)
 				{
+					ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(*WindowData);
+
+					// Unmaps we asked for ourselves come back here too, carrying the sequence number of our request.
+					// Synthetic ones are always the client withdrawing (ICCCM 4.1.4), whatever their sequence number.
+					if (XCB_EVENT_RESPONSE_TYPE(Event) == XCB_UNMAP_NOTIFY && (Event->response_type & 0x80) == 0)
+					{
+						std::vector<unsigned int> &PendingUnmaps = WindowDataCast->PendingUnmaps;
+
+						// They're in the order they were sent.  Any before this one will never be reported now.
+						PendingUnmaps.erase(PendingUnmaps.begin(), std::lower_bound(PendingUnmaps.begin(), PendingUnmaps.end(), Event->full_sequence));
+
+						if (!PendingUnmaps.empty() && PendingUnmaps.front() == Event->full_sequence)
+						{
+							LOG_DEBUG_INFO_NOHEADER << " (ours)";
+							break;
+						}
+					}
+
 					if (!WindowDataCast->Destroyed)
 					{
-						this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientDestroy_Event(static_cast<ClientWindow &>(WindowDataCast->Window))));
+						this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientDestroy_Event(static_cast<ClientWindow &>(WindowDataCast->Window)));
 
 						WindowDataCast->Destroyed = true;
 					}
@@ -407,6 +673,28 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 
 			LOG_DEBUG_INFO_NOHEADER << " - Enter notify on " << EnterNotify->child << ", " << EnterNotify->event << "(" << (unsigned int)EnterNotify->mode << ", " << (unsigned int)EnterNotify->detail << ") at " << EnterNotify->root_x << ", " << EnterNotify->root_y;
 
+			// Only our own windows report pointer motion, and only if the pointer is in the window itself rather than a child.
+			// A grab elsewhere takes all motion for itself; if it's one of ours, its own events keep the position current.
+			if (EnterNotify->mode == XCB_NOTIFY_MODE_GRAB)
+				PointerTracker::Untrack();
+			else
+			{
+				auto WindowDataAccessor = this->Owner.GetWindowData();
+
+				auto WindowData = WindowDataAccessor->find(EnterNotify->event);
+				bool const Tracked = EnterNotify->child == XCB_NONE && WindowData != WindowDataAccessor->end() &&
+									 ((*WindowData)->Kind == Window::Kind::FRAME || (*WindowData)->Kind == Window::Kind::UTILITY);
+
+				PointerTracker::Set(EnterNotify->root_x, EnterNotify->root_y, Tracked);
+			}
+
+			// The pointer didn't move; a window we moved, restacked, mapped or unmapped did.  Crossings from grabs are left alone.
+			if (EnterNotify->mode == XCB_NOTIFY_MODE_NORMAL && this->Owner.Requests.IsRearrangement(Event->full_sequence))
+			{
+				LOG_DEBUG_INFO_NOHEADER << " (rearrangement)";
+				break;
+			}
+
 			auto WindowDataAccessor = this->Owner.GetWindowData();
 
 			if (EnterNotify->child != XCB_NONE)
@@ -417,23 +705,29 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 
 				if (WindowData != WindowDataAccessor->end())
 				{
-					if (ClientWindowData const * const WindowDataCast = dynamic_cast<ClientWindowData *>(*WindowData))
+					if ((*WindowData)->Kind == Window::Kind::CLIENT)
 					{
+						ClientWindowData const * const WindowDataCast = static_cast<ClientWindowData const *>(*WindowData);
+
 						if (WindowDataCast->Destroyed)
 							break;
 					}
-					else if (AuxiliaryWindowData const * const WindowDataCast = dynamic_cast<AuxiliaryWindowData const *>(*WindowData))
+					else if ((*WindowData)->Kind == Window::Kind::FRAME || (*WindowData)->Kind == Window::Kind::UTILITY)
 					{
-						if (ClientWindowData const * const PrimaryWindowDataCast = dynamic_cast<ClientWindowData const *>(WindowDataCast->PrimaryWindowData))
+						AuxiliaryWindowData const * const WindowDataCast = static_cast<AuxiliaryWindowData const *>(*WindowData);
+
+						if (WindowDataCast->PrimaryWindowData->Kind == Window::Kind::CLIENT)
 						{
+							ClientWindowData const * const PrimaryWindowDataCast = static_cast<ClientWindowData const *>(WindowDataCast->PrimaryWindowData);
+
 							if (PrimaryWindowDataCast->Destroyed)
 								break;
 						}
 					}
 
-					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new WindowEnter_Event((*WindowData)->Window,
-																								  Vector(EnterNotify->root_x,
-																										 EnterNotify->root_y))));
+					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(WindowEnter_Event((*WindowData)->Window,
+																							Vector(EnterNotify->root_x,
+																								   EnterNotify->root_y)));
 				}
 			}
 			else
@@ -441,24 +735,43 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				auto WindowData = WindowDataAccessor->find(EnterNotify->event);
 				if (WindowData != WindowDataAccessor->end())
 				{
-					if (AuxiliaryWindowData const * const WindowDataCast = dynamic_cast<AuxiliaryWindowData const *>(*WindowData))
+					if ((*WindowData)->Kind == Window::Kind::FRAME || (*WindowData)->Kind == Window::Kind::UTILITY)
 					{
-						if (ClientWindowData const * const PrimaryWindowDataCast = dynamic_cast<ClientWindowData const *>(WindowDataCast->PrimaryWindowData))
+						AuxiliaryWindowData const * const WindowDataCast = static_cast<AuxiliaryWindowData const *>(*WindowData);
+
+						if (WindowDataCast->PrimaryWindowData->Kind == Window::Kind::CLIENT)
 						{
+							ClientWindowData const * const PrimaryWindowDataCast = static_cast<ClientWindowData const *>(WindowDataCast->PrimaryWindowData);
+
 							if (PrimaryWindowDataCast->Destroyed)
 								break;
 						}
 					}
 
-					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new WindowEnter_Event((*WindowData)->Window,
-																								  Vector(EnterNotify->root_x,
-																										 EnterNotify->root_y))));
+					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(WindowEnter_Event((*WindowData)->Window,
+																							Vector(EnterNotify->root_x,
+																								   EnterNotify->root_y)));
 				}
 			}
 		}
 		break;
 
 
+	case XCB_LEAVE_NOTIFY:
+		{
+			xcb_leave_notify_event_t * const LeaveNotify = (xcb_leave_notify_event_t *)Event;
+
+			LOG_DEBUG_INFO_NOHEADER << " - Leave notify on " << LeaveNotify->event;
+
+			// Whatever the pointer went into, an enter notify will tell us if it reports motion
+			if (LeaveNotify->mode == XCB_NOTIFY_MODE_GRAB)
+				PointerTracker::Untrack();
+			else
+				PointerTracker::Set(LeaveNotify->root_x, LeaveNotify->root_y, false);
+		}
+		break;
+
+
 	case XCB_FOCUS_IN:
 		{
 			xcb_focus_in_event_t * const FocusIn = (xcb_focus_in_event_t *)Event;
@@ -477,7 +790,10 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 
 			// If it's not, take back the focus
 			if (ReclaimFocusData != nullptr && !ReclaimFocusData->Destroyed)
-				static_cast<ClientWindow &>(ReclaimFocusData->Window).Focus();
+			{
+				this->Owner.ApplyFocus(ReclaimFocusData);
+				xcb_flush(this->Owner.XConnection);
+			}
 		}
 		break;
 
@@ -494,8 +810,8 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 				auto WindowDataAccessor = this->Owner.GetWindowData();
 
 				auto WindowData = WindowDataAccessor->find(ClientMessage->window);
-				if (WindowData != WindowDataAccessor->end())
-					EventWindow = dynamic_cast<ClientWindow *>(&(*WindowData)->Window);
+				if (WindowData != WindowDataAccessor->end() && (*WindowData)->Kind == Window::Kind::CLIENT)
+					EventWindow = static_cast<ClientWindow *>(&(*WindowData)->Window);
 			}
 
 			if (EventWindow != nullptr)
@@ -504,7 +820,7 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 					ClientMessage->format == 32 &&
 					ClientMessage->data.data32[0] == XCB_ICCCM_WM_STATE_ICONIC)
 				{
-					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientIconifiedRequest_Event(*EventWindow, true)));
+					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientIconifiedRequest_Event(*EventWindow, true));
 				}
 				else if (ClientMessage->type == Atoms::_NET_WM_STATE &&
 						(ClientMessage->data.data32[1] == Atoms::_NET_WM_STATE_FULLSCREEN || ClientMessage->data.data32[2] == Atoms::_NET_WM_STATE_FULLSCREEN))
@@ -521,7 +837,7 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 						break;
 					}
 
-					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(*(new ClientFullscreenRequest_Event(*EventWindow, Value)));
+					this->Owner.DisplayServer.OutgoingEventQueue.AddEvent(ClientFullscreenRequest_Event(*EventWindow, Value));
 				}
 			}
 		}
@@ -531,6 +847,58 @@ void X11XCB_DisplayServer::Implementation::EventHandler::Handle(xcb_generic_even
 	case XCB_MAPPING_NOTIFY:
 		{
 			LOG_DEBUG_INFO_NOHEADER << " - Mapping notify" << std::endl;
+
+			xcb_mapping_notify_event_t * const MappingNotify = (xcb_mapping_notify_event_t *)Event;
+
+			if (MappingNotify->request == XCB_MAPPING_KEYBOARD)
+				InputTranslator::Refresh(MappingNotify);
+
+			if (Config::DisplayServerInputBindings && MappingNotify->request == XCB_MAPPING_KEYBOARD)
+			{
+				UngrabBindings(this->Owner.XConnection, this->Owner.XScreen->root);
+				GrabBindings(this->Owner.XConnection, this->Owner.XScreen->root, this->BindingMap);
+
+				xcb_flush(this->Owner.XConnection);
+			}
+		}
+		break;
+	default:
+		if (this->Owner.SharedMemory && XCB_EVENT_RESPONSE_TYPE(Event) == this->Owner.SharedMemoryCompletion)
+		{
+			LOG_DEBUG_INFO_NOHEADER << " - Shared image upload finished on " << ((xcb_shm_completion_event_t *)Event)->drawable;
+
+			xcb_shm_seg_t const Segment = ((xcb_shm_completion_event_t *)Event)->shmseg;
+
+			// The image can be drawn over again without waiting.  An older upload's completion says nothing about a newer one.
+			auto WindowDataAccessor = this->Owner.GetWindowData();
+			for (auto WindowData : *WindowDataAccessor)
+			{
+				if (WindowData->Kind != Window::Kind::FRAME && WindowData->Kind != Window::Kind::UTILITY)
+					continue;
+
+				AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData);
+				AuxiliaryWindowData::SharedImage &Image = WindowDataCast->Image;
+
+				if (Image.Segment == Segment)
+				{
+					if (Image.UploadSequence == Event->full_sequence)
+					{
+						Image.UploadSequence = 0;
+
+						// Drawing that came in while the server was reading the image was put off until now
+						if (Image.RedrawPending)
+						{
+							Image.RedrawPending = false;
+
+							if (ReplayDrawList(this->Owner.XConnection, *this->Owner.GetText(), WindowDataCast))
+								WindowDataCast->PresentBackbuffer(this->Owner.XConnection);
+
+							xcb_flush(this->Owner.XConnection);
+						}
+					}
+					break;
+				}
+			}
 		}
 		break;
 	}
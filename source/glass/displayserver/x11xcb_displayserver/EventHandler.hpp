@@ -20,12 +20,16 @@
 #ifndef GLASS_X11XCB_DISPLAYSERVER_EVENTHANDLER
 #define GLASS_X11XCB_DISPLAYSERVER_EVENTHANDLER
 
+#include <map>
 #include <thread>
 
 #include <xcb/xcb.h>
 
+#include "glass/core/Event.hpp"
+#include "glass/core/Input.hpp"
 #include "glass/displayserver/x11xcb_displayserver/Implementation.hpp"
 #include "util/interruptible.hpp"
+#include "util/scoped_free.hpp"
 
 namespace Glass
 {
@@ -35,11 +39,20 @@ namespace Glass
 		EventHandler(X11XCB_DisplayServer::Implementation &Owner);
 		~EventHandler();
 
+		// A blocking reply on another thread reads any events that came before it off the socket, which doesn't wake the
+		// handler.  Call this after one, so the handler picks them up instead of leaving them until more arrive.
+		void Wake();
+
 	private:
 		void Listen();
 		void Handle(xcb_generic_event_t *Event);
+		scoped_free<xcb_generic_event_t *> WaitForEvent();
 
 		X11XCB_DisplayServer::Implementation &Owner;
+
+		// Only filled when the display server handles the input bindings itself
+		std::map<Input, EventRecord> BindingMap;
+
 		interruptible<std::thread> Worker;
 	};
 }
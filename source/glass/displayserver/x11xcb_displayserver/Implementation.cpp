@@ -17,12 +17,22 @@
 * Copyright 2014-2015 Chris Foster
 */
 
+#include <algorithm>
+#include <limits>
+#include <string.h> // memset
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <unistd.h>
+#include <xcb/shm.h>
 #include <xcb/xcb_icccm.h>
+#include <xcb/xcbext.h> // xcb_poll_for_reply
 
+#include "glass/core/Event.hpp"
+#include "glass/core/EventQueue.hpp"
 #include "glass/core/Log.hpp"
 #include "glass/displayserver/x11xcb_displayserver/GeometryChange.hpp"
 #include "glass/displayserver/x11xcb_displayserver/Implementation.hpp"
+#include "util/timestamp.hpp"
 
 using namespace Glass;
 
@@ -30,7 +40,13 @@ X11XCB_DisplayServer::Implementation::Implementation(X11XCB_DisplayServer &Displ
 	DisplayServer(DisplayServer),
 	XConnection(nullptr),
 	XScreen(nullptr),
-	ActiveWindowData(XCB_NONE)
+	SharedMemory(false),
+	SharedMemoryCompletion(0),
+	ActiveWindowData(XCB_NONE),
+	Text(256),
+	Pending(),
+	PendingPropertyRequests(0),
+	PointerQueries(0)
 {
 
 }
@@ -42,6 +58,57 @@ X11XCB_DisplayServer::Implementation::~Implementation()
 }
 
 
+bool X11XCB_DisplayServer::Implementation::ProbeSharedMemory()
+{
+	xcb_query_extension_reply_t const * const Extension = xcb_get_extension_data(this->XConnection, &xcb_shm_id);
+	if (Extension == nullptr || !Extension->present)
+		return false;
+
+	// Shared images are put into the backbuffers as they are, so the server has to lay pixels out the way cairo does
+	if ((this->XVisualDepth != 32 && this->XVisualDepth != 24) ||
+		this->XVisual->red_mask != 0xFF0000 || this->XVisual->green_mask != 0xFF00 || this->XVisual->blue_mask != 0xFF)
+		return false;
+
+	uint32_t const ByteOrderTest = 1;
+	uint8_t const  ByteOrder = (*(uint8_t const *)&ByteOrderTest == 1 ? XCB_IMAGE_ORDER_LSB_FIRST : XCB_IMAGE_ORDER_MSB_FIRST);
+
+	xcb_setup_t const * const Setup = xcb_get_setup(this->XConnection);
+	if (Setup->image_byte_order != ByteOrder)
+		return false;
+
+	bool PixelsMatch = false;
+	for (xcb_format_iterator_t Format = xcb_setup_pixmap_formats_iterator(Setup); Format.rem != 0; xcb_format_next(&Format))
+	{
+		if (Format.data->depth == this->XVisualDepth)
+			PixelsMatch = (Format.data->bits_per_pixel == 32);
+	}
+
+	if (!PixelsMatch)
+		return false;
+
+	// Servers on other machines can advertise the extension without being able to reach our memory, so try attaching
+	int const ID = shmget(IPC_PRIVATE, 4096, IPC_CREAT | 0600);
+	if (ID == -1)
+		return false;
+
+	xcb_shm_seg_t const Segment = xcb_generate_id(this->XConnection);
+	xcb_generic_error_t * const Error = xcb_request_check(this->XConnection, xcb_shm_attach_checked(this->XConnection, Segment, ID, 1));
+
+	shmctl(ID, IPC_RMID, nullptr);
+
+	if (Error != nullptr)
+	{
+		free(Error);
+		return false;
+	}
+
+	xcb_shm_detach(this->XConnection, Segment);
+
+	this->SharedMemoryCompletion = Extension->first_event + XCB_SHM_COMPLETION;
+	return true;
+}
+
+
 locked_accessor<ClientWindowData *> X11XCB_DisplayServer::Implementation::GetActiveWindow()		{ return { this->ActiveWindowData, this->ActiveWindowMutex }; }
 
 
@@ -52,12 +119,27 @@ locked_accessor<ClientWindowList>	X11XCB_DisplayServer::Implementation::GetClien
 locked_accessor<WindowDataContainer> X11XCB_DisplayServer::Implementation::GetWindowData()		{ return { this->WindowData, this->WindowDataMutex }; }
 
 
+locked_accessor<TextCache> X11XCB_DisplayServer::Implementation::GetText()					{ return { this->Text, this->TextMutex }; }
+
+
 locked_accessor<X11XCB_DisplayServer::Implementation::GeometryChangeMap> X11XCB_DisplayServer::Implementation::GetGeometryChanges()
 {
 	return { this->GeometryChanges, this->GeometryChangesMutex };
 }
 
 
+locked_accessor<X11XCB_DisplayServer::Implementation::PendingChanges> X11XCB_DisplayServer::Implementation::GetPending()
+{
+	return { this->Pending, this->PendingMutex };
+}
+
+
+locked_accessor<X11XCB_DisplayServer::Implementation::StackingOrderMap> X11XCB_DisplayServer::Implementation::GetStackingOrders()
+{
+	return { this->StackingOrders, this->StackingOrdersMutex };
+}
+
+
 std::string GetWindowName(xcb_connection_t *XConnection, xcb_window_t WindowID)
 {
 	xcb_get_property_cookie_t const EWMHNameCookie = xcb_get_property_unchecked(XConnection, false, WindowID,
@@ -110,6 +192,157 @@ std::string GetWindowClass(xcb_connection_t *XConnection, xcb_window_t WindowID)
 }
 
 
+std::string GetPropertyString(xcb_get_property_reply_t *PropertyReply)
+{
+	if (PropertyReply == nullptr)
+		return "";
+
+	char * const Value = (char *)xcb_get_property_value(PropertyReply);
+
+	return std::string(Value, Value + xcb_get_property_value_length(PropertyReply));
+}
+
+
+std::set<xcb_atom_t> GetPropertyAtoms(xcb_get_property_reply_t *PropertyReply)
+{
+	std::set<xcb_atom_t> PropertyAtoms;
+
+	if (PropertyReply == nullptr || PropertyReply->type != Atoms::ATOM || PropertyReply->format != 32)
+		return PropertyAtoms;
+
+	xcb_atom_t * const Value = (xcb_atom_t *)xcb_get_property_value(PropertyReply);
+
+	PropertyAtoms.insert(Value, Value + xcb_get_property_value_length(PropertyReply) / sizeof(xcb_atom_t));
+
+	return PropertyAtoms;
+}
+
+
+// Replaces any request still outstanding, since its reply would already be stale
+void SendPropertyRequest(xcb_connection_t *XConnection, std::atomic<unsigned int> &PendingPropertyRequests,
+						 ClientWindowData::PropertyRequest &Request, xcb_get_property_cookie_t Cookie)
+{
+	if (Request.Pending)
+		xcb_discard_reply(XConnection, Request.Cookie.sequence);
+	else
+		PendingPropertyRequests++;
+
+	Request.Pending = true;
+	Request.Cookie = Cookie;
+}
+
+
+// Returns true once the request has been answered, leaving the reply (or nullptr on error) for the caller to free
+bool PollPropertyRequest(xcb_connection_t *XConnection, std::atomic<unsigned int> &PendingPropertyRequests,
+						 ClientWindowData::PropertyRequest &Request, xcb_get_property_reply_t *&PropertyReply)
+{
+	PropertyReply = nullptr;
+
+	if (!Request.Pending)
+		return false;
+
+	void *Reply = nullptr;
+
+	if (!xcb_poll_for_reply(XConnection, Request.Cookie.sequence, &Reply, nullptr))
+		return false;
+
+	Request.Pending = false;
+	PendingPropertyRequests--;
+
+	// Changes the reply turns into arrived with it, not with whatever event this thread last handled
+	EventQueue::SetArrivalTime(timestamp());
+
+	PropertyReply = (xcb_get_property_reply_t *)Reply;
+	return true;
+}
+
+
+bool X11XCB_DisplayServer::Implementation::RefreshClientProperty(ClientWindowData *WindowData, xcb_atom_t Property)
+{
+	xcb_window_t const &WindowID = WindowData->ID;
+
+	if (Property == Atoms::_NET_WM_NAME)
+		SendPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowData->EWMHNameRequest,
+							xcb_get_property_unchecked(this->XConnection, false, WindowID, Atoms::_NET_WM_NAME, Atoms::UTF8_STRING, 0, -1));
+	else if (Property == Atoms::WM_NAME)
+		SendPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowData->ICCCMNameRequest,
+							xcb_icccm_get_wm_name_unchecked(this->XConnection, WindowID));
+	else if (Property == Atoms::WM_HINTS)
+		SendPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowData->WMHintsRequest,
+							xcb_icccm_get_wm_hints_unchecked(this->XConnection, WindowID));
+	else if (Property == Atoms::WM_PROTOCOLS)
+		SendPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowData->ProtocolsRequest,
+							xcb_icccm_get_wm_protocols_unchecked(this->XConnection, WindowID, Atoms::WM_PROTOCOLS));
+	else
+		return false;
+
+	return true;
+}
+
+
+void X11XCB_DisplayServer::Implementation::CollectClientProperties()
+{
+	if (this->PendingPropertyRequests == 0)
+		return;
+
+	auto WindowDataAccessor = this->GetWindowData();
+
+	for (auto WindowData : *WindowDataAccessor)
+	{
+		if (WindowData->Kind != Window::Kind::CLIENT)
+			continue;
+
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		std::string const OldName = WindowDataCast->GetName();
+		xcb_get_property_reply_t *PropertyReply;
+
+		if (PollPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowDataCast->EWMHNameRequest, PropertyReply))
+		{
+			WindowDataCast->EWMHName = GetPropertyString(PropertyReply);
+			free(PropertyReply);
+		}
+
+		if (PollPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowDataCast->ICCCMNameRequest, PropertyReply))
+		{
+			WindowDataCast->ICCCMName = GetPropertyString(PropertyReply);
+			free(PropertyReply);
+		}
+
+		if (PollPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowDataCast->WMHintsRequest, PropertyReply))
+		{
+			if (PropertyReply == nullptr || !xcb_icccm_get_wm_hints_from_reply(&WindowDataCast->WMHints, PropertyReply))
+				xcb_icccm_wm_hints_set_none(&WindowDataCast->WMHints);
+
+			free(PropertyReply);
+		}
+
+		if (PollPropertyRequest(this->XConnection, this->PendingPropertyRequests, WindowDataCast->ProtocolsRequest, PropertyReply))
+		{
+			WindowDataCast->Protocols = GetPropertyAtoms(PropertyReply);
+			free(PropertyReply);
+		}
+
+		if (WindowDataCast->Destroyed)
+			continue;
+
+		ClientWindow &EventWindow = static_cast<ClientWindow &>(WindowDataCast->Window);
+
+		std::string const Name = WindowDataCast->GetName();
+		if (Name != OldName)
+			this->DisplayServer.OutgoingEventQueue.AddEvent(PrimaryNameChange_Event(EventWindow, Name));
+
+		bool const Urgent = xcb_icccm_wm_hints_get_urgency(&WindowDataCast->WMHints);
+		if (Urgent != WindowDataCast->Urgent)
+		{
+			WindowDataCast->Urgent = Urgent;
+
+			this->DisplayServer.OutgoingEventQueue.AddEvent(ClientUrgencyChange_Event(EventWindow, Urgent));
+		}
+	}
+}
+
+
 RootWindowList X11XCB_DisplayServer::Implementation::CreateRootWindows(WindowIDList const &WindowIDs)
 {
 	// This list is incomplete, and support may or may not be complete
@@ -254,6 +487,9 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 	std::vector<xcb_get_property_cookie_t>			EWMHStateCookies;
 	std::vector<xcb_get_property_cookie_t>			EWMHWindowTypeCookies;
 	std::vector<xcb_get_property_cookie_t>			TransientForCookies;
+	std::vector<xcb_get_property_cookie_t>			EWMHNameCookies;
+	std::vector<xcb_get_property_cookie_t>			ICCCMNameCookies;
+	std::vector<xcb_get_property_cookie_t>			ProtocolsCookies;
 	std::vector<xcb_get_window_attributes_cookie_t>	WindowAttributesCookies;
 
 	GeometryCookies.reserve(WindowIDs.size());
@@ -261,6 +497,9 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 	EWMHStateCookies.reserve(WindowIDs.size());
 	EWMHWindowTypeCookies.reserve(WindowIDs.size());
 	TransientForCookies.reserve(WindowIDs.size());
+	EWMHNameCookies.reserve(WindowIDs.size());
+	ICCCMNameCookies.reserve(WindowIDs.size());
+	ProtocolsCookies.reserve(WindowIDs.size());
 	WindowAttributesCookies.reserve(WindowIDs.size());
 
 
@@ -275,6 +514,10 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 		WindowAttributesCookies.push_back(xcb_get_window_attributes_unchecked(this->XConnection, ClientWindowID));
 		WMHintsCookies.push_back(xcb_icccm_get_wm_hints_unchecked(this->XConnection, ClientWindowID));
 		TransientForCookies.push_back(xcb_icccm_get_wm_transient_for_unchecked(this->XConnection, ClientWindowID));
+		EWMHNameCookies.push_back(xcb_get_property_unchecked(this->XConnection, false, ClientWindowID,
+															 Atoms::_NET_WM_NAME, Atoms::UTF8_STRING, 0, -1));
+		ICCCMNameCookies.push_back(xcb_icccm_get_wm_name_unchecked(this->XConnection, ClientWindowID));
+		ProtocolsCookies.push_back(xcb_icccm_get_wm_protocols_unchecked(this->XConnection, ClientWindowID, Atoms::WM_PROTOCOLS));
 	}
 
 
@@ -284,6 +527,9 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 	std::vector<xcb_get_property_reply_t *>				EWMHStateReplies;
 	std::vector<xcb_get_property_reply_t *>				EWMHWindowTypeReplies;
 	std::vector<xcb_window_t>							TransientForReplies;
+	std::vector<xcb_get_property_reply_t *>				EWMHNameReplies;
+	std::vector<xcb_get_property_reply_t *>				ICCCMNameReplies;
+	std::vector<xcb_get_property_reply_t *>				ProtocolsReplies;
 	std::vector<xcb_get_window_attributes_reply_t *>	WindowAttributesReplies;
 	WindowIDList										ManageableWindowIDs;
 
@@ -319,6 +565,10 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 				if (WindowAttributesReply != nullptr)
 					free(WindowAttributesReply);
 
+				xcb_discard_reply(this->XConnection, EWMHNameCookies[Index].sequence);
+				xcb_discard_reply(this->XConnection, ICCCMNameCookies[Index].sequence);
+				xcb_discard_reply(this->XConnection, ProtocolsCookies[Index].sequence);
+
 				continue;
 			}
 
@@ -333,6 +583,9 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 			WindowAttributesReplies.push_back(WindowAttributesReply);
 			WMHintsReplies.push_back(WMHintsReply);
 			TransientForReplies.push_back(TransientForReply);
+			EWMHNameReplies.push_back(xcb_get_property_reply(this->XConnection, EWMHNameCookies[Index], nullptr));
+			ICCCMNameReplies.push_back(xcb_get_property_reply(this->XConnection, ICCCMNameCookies[Index], nullptr));
+			ProtocolsReplies.push_back(xcb_get_property_reply(this->XConnection, ProtocolsCookies[Index], nullptr));
 			ManageableWindowIDs.push_back(WindowIDs[Index]);
 
 			// Place non-transient windows before transient windows (in no particular order) so that their client structures
@@ -350,8 +603,14 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 
 	for (auto &Index : OrderedIndices)
 	{
-		// Get the client's name
-		std::string Name = GetWindowName(this->XConnection, ManageableWindowIDs[Index]);
+		// Get the client's name, preferring _NET_WM_NAME
+		std::string const EWMHName = GetPropertyString(EWMHNameReplies[Index]);
+		std::string const ICCCMName = GetPropertyString(ICCCMNameReplies[Index]);
+
+		free(EWMHNameReplies[Index]);
+		free(ICCCMNameReplies[Index]);
+
+		std::string Name = (EWMHName != "" ? EWMHName : ICCCMName);
 
 		if (Name == "")
 			Name = "Unnamed Window";
@@ -432,7 +691,10 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 				// XXX Probably protect WindowData
 				WindowDataContainer::const_iterator TransientForClientData = this->WindowData.find(TransientForReply);
 				if (TransientForClientData != this->WindowData.end())
-					TransientForClient = dynamic_cast<ClientWindow *>(&(*TransientForClientData)->Window);
+				{
+					if ((*TransientForClientData)->Kind == Window::Kind::CLIENT)
+						TransientForClient = static_cast<ClientWindow *>(&(*TransientForClientData)->Window);
+				}
 				else
 					LOG_DEBUG_ERROR << "TransientFor client's WindowData does not exist!" << std::endl;
 			}
@@ -481,7 +743,19 @@ ClientWindowList X11XCB_DisplayServer::Implementation::CreateClientWindows(Windo
 			ClientWindowsAccessor->push_back(NewClientWindow);
 		}
 
-		this->WindowData.push_back(new ClientWindowData(*NewClientWindow, ClientWindowID, EventMask, NeverFocus, this->XScreen->root, XCB_NONE, Urgent));
+		ClientWindowData * const NewClientWindowData = new ClientWindowData(*NewClientWindow, ClientWindowID, EventMask, NeverFocus,
+																			this->XScreen->root, XCB_NONE, Urgent);
+
+		// Fill its property cache from the replies already in hand
+		NewClientWindowData->EWMHName = EWMHName;
+		NewClientWindowData->ICCCMName = ICCCMName;
+		NewClientWindowData->WMHints = WMHints;
+		NewClientWindowData->Protocols = GetPropertyAtoms(ProtocolsReplies[Index]);
+
+		free(ProtocolsReplies[Index]);
+
+		this->WindowData.push_back(NewClientWindowData);
+		this->AddStackedWindow(NewClientWindowData);
 
 		ClientWindows.push_back(NewClientWindow);
 	}
@@ -495,9 +769,11 @@ void X11XCB_DisplayServer::Implementation::SetWindowGeometry(Glass::WindowData *
 {
 	auto GeometryChangesAccessor = this->GetGeometryChanges();
 
-	if (AuxiliaryWindowData * const WindowDataCast = dynamic_cast<AuxiliaryWindowData *>(WindowData))
+	if (WindowData->Kind == Window::Kind::FRAME || WindowData->Kind == Window::Kind::UTILITY)
 	{
-		if (dynamic_cast<FrameWindow *>(&WindowDataCast->Window))
+		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData);
+
+		if (WindowDataCast->Kind == Window::Kind::FRAME)
 		{
 			auto GeometryChange = GeometryChangesAccessor->find(WindowDataCast->PrimaryWindowData->ID);
 			if (GeometryChange == GeometryChangesAccessor->end() ||
@@ -532,15 +808,20 @@ void X11XCB_DisplayServer::Implementation::SetWindowGeometry(Glass::WindowData *
 			}
 		}
 	}
-	else if (ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData)) // A client is the only other possibility
+	else if (WindowData->Kind == Window::Kind::CLIENT)
 	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
 		// If there's already a geometry change for the frame, delete it.
 		// The frame will be positioned when this client's geometry change is processed.
 		if (WindowDataCast->ParentID != XCB_NONE)
 		{
 			auto GeometryChange = GeometryChangesAccessor->find(WindowDataCast->ParentID);
 			if (GeometryChange != GeometryChangesAccessor->end())
+			{
+				delete GeometryChange->second;
 				GeometryChangesAccessor->erase(GeometryChange);
+			}
 		}
 
 
@@ -557,3 +838,408 @@ void X11XCB_DisplayServer::Implementation::SetWindowGeometry(Glass::WindowData *
 		}
 	}
 }
+
+
+void X11XCB_DisplayServer::Implementation::SetWindowMapped(Glass::WindowData *WindowData, bool Mapped)
+{
+	auto PendingAccessor = this->GetPending();
+
+	WindowData->DesiredMapped = Mapped;
+
+	if (std::find(PendingAccessor->Visibility.begin(), PendingAccessor->Visibility.end(), WindowData) == PendingAccessor->Visibility.end())
+		PendingAccessor->Visibility.push_back(WindowData);
+}
+
+
+// The window whose children WindowData is stacked among, or XCB_NONE if it isn't stacked
+xcb_window_t GetStackingParentID(Glass::WindowData *WindowData)
+{
+	switch (WindowData->Kind)
+	{
+	case Window::Kind::CLIENT:
+		{
+			ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+			return WindowDataCast->ParentID != XCB_NONE ? WindowDataCast->ParentID : WindowDataCast->RootID;
+		}
+
+	case Window::Kind::FRAME:
+		return static_cast<AuxiliaryWindowData *>(WindowData)->RootID;
+
+	case Window::Kind::UTILITY:
+		return static_cast<AuxiliaryWindowData *>(WindowData)->PrimaryWindowData->ID;
+
+	default:
+		return XCB_NONE;
+	}
+}
+
+
+void X11XCB_DisplayServer::Implementation::MarkRestack(PendingChanges &Pending, xcb_window_t ParentID)
+{
+	if (std::find(Pending.Restacks.begin(), Pending.Restacks.end(), ParentID) == Pending.Restacks.end())
+		Pending.Restacks.push_back(ParentID);
+}
+
+
+void X11XCB_DisplayServer::Implementation::SetWindowStacking(Glass::WindowData *WindowData, StackMode Mode)
+{
+	xcb_window_t const ParentID = GetStackingParentID(WindowData);
+
+	auto PendingAccessor = this->GetPending();
+	auto StackingOrdersAccessor = this->GetStackingOrders();
+
+	auto Order = StackingOrdersAccessor->find(ParentID);
+	if (Order == StackingOrdersAccessor->end())
+		return;
+
+	WindowDataList &Desired = Order->second.Desired;
+
+	auto Position = std::find(Desired.begin(), Desired.end(), WindowData);
+	if (Position == Desired.end())
+		return;
+
+	// Windows already in place, like the many raised again by each refresh of the window manager's stacking order, cost nothing
+	if (Mode == StackMode::RAISE && Position + 1 != Desired.end())
+		std::rotate(Position, Position + 1, Desired.end());
+	else if (Mode == StackMode::LOWER && Position != Desired.begin())
+		std::rotate(Desired.begin(), Position, Position + 1);
+	else
+		return;
+
+	Implementation::MarkRestack(*PendingAccessor, ParentID);
+}
+
+
+void X11XCB_DisplayServer::Implementation::SetWindowFocus(Glass::WindowData *WindowData)
+{
+	auto PendingAccessor = this->GetPending();
+
+	PendingAccessor->Focus = WindowData;
+}
+
+
+void X11XCB_DisplayServer::Implementation::ForgetWindow(Glass::WindowData *WindowData)
+{
+	// Pending changes wait for the end of the window manager's batch, so don't let one outlive its window
+	{
+		auto GeometryChangesAccessor = this->GetGeometryChanges();
+
+		auto GeometryChange = GeometryChangesAccessor->find(WindowData->ID);
+		if (GeometryChange != GeometryChangesAccessor->end())
+		{
+			delete GeometryChange->second;
+			GeometryChangesAccessor->erase(GeometryChange);
+		}
+	}
+
+	{
+		auto PendingAccessor = this->GetPending();
+
+		PendingAccessor->Visibility.erase(std::remove(PendingAccessor->Visibility.begin(), PendingAccessor->Visibility.end(), WindowData),
+										  PendingAccessor->Visibility.end());
+
+		if (PendingAccessor->Focus == WindowData)
+			PendingAccessor->Focus = nullptr;
+	}
+
+	this->RemoveStackedWindow(WindowData);
+
+	// Nobody will collect the replies to its property requests now
+	if (WindowData->Kind == Window::Kind::CLIENT)
+	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		for (ClientWindowData::PropertyRequest *Request : { &WindowDataCast->EWMHNameRequest, &WindowDataCast->ICCCMNameRequest,
+															&WindowDataCast->WMHintsRequest, &WindowDataCast->ProtocolsRequest })
+		{
+			if (Request->Pending)
+			{
+				xcb_discard_reply(this->XConnection, Request->Cookie.sequence);
+				Request->Pending = false;
+				this->PendingPropertyRequests--;
+			}
+		}
+	}
+
+	// Its own children go with it
+	{
+		auto PendingAccessor = this->GetPending();
+		auto StackingOrdersAccessor = this->GetStackingOrders();
+
+		StackingOrdersAccessor->erase(WindowData->ID);
+		PendingAccessor->Restacks.erase(std::remove(PendingAccessor->Restacks.begin(), PendingAccessor->Restacks.end(), WindowData->ID),
+										PendingAccessor->Restacks.end());
+	}
+}
+
+
+void X11XCB_DisplayServer::Implementation::AddStackedWindow(Glass::WindowData *WindowData)
+{
+	xcb_window_t const ParentID = GetStackingParentID(WindowData);
+	if (ParentID == XCB_NONE)
+		return;
+
+	auto PendingAccessor = this->GetPending();
+	auto StackingOrdersAccessor = this->GetStackingOrders();
+
+	StackingOrder &Order = (*StackingOrdersAccessor)[ParentID];
+
+	if (std::find(Order.Desired.begin(), Order.Desired.end(), WindowData) != Order.Desired.end())
+		return;
+
+	Order.Desired.push_back(WindowData);
+	Order.Applied.push_back(WindowData);
+	Order.Root = WindowData->Kind == Window::Kind::FRAME ||
+				 (WindowData->Kind == Window::Kind::CLIENT && static_cast<ClientWindowData *>(WindowData)->ParentID == XCB_NONE);
+
+	Implementation::MarkRestack(*PendingAccessor, ParentID);
+}
+
+
+void X11XCB_DisplayServer::Implementation::RemoveStackedWindow(Glass::WindowData *WindowData)
+{
+	xcb_window_t const ParentID = GetStackingParentID(WindowData);
+
+	auto PendingAccessor = this->GetPending();
+	auto StackingOrdersAccessor = this->GetStackingOrders();
+
+	auto Order = StackingOrdersAccessor->find(ParentID);
+	if (Order == StackingOrdersAccessor->end())
+		return;
+
+	WindowDataList &Desired = Order->second.Desired;
+	WindowDataList &Applied = Order->second.Applied;
+
+	Desired.erase(std::remove(Desired.begin(), Desired.end(), WindowData), Desired.end());
+	Applied.erase(std::remove(Applied.begin(), Applied.end(), WindowData), Applied.end());
+
+	Implementation::MarkRestack(*PendingAccessor, ParentID);
+}
+
+
+void X11XCB_DisplayServer::Implementation::ResetStackingOrder(Glass::WindowData *WindowData)
+{
+	xcb_window_t const ParentID = GetStackingParentID(WindowData);
+
+	auto PendingAccessor = this->GetPending();
+	auto StackingOrdersAccessor = this->GetStackingOrders();
+
+	auto Order = StackingOrdersAccessor->find(ParentID);
+	if (Order == StackingOrdersAccessor->end())
+		return;
+
+	// Every window will be put back in its place
+	Order->second.Applied.clear();
+
+	Implementation::MarkRestack(*PendingAccessor, ParentID);
+}
+
+
+void X11XCB_DisplayServer::Implementation::ApplyVisibility(Glass::WindowData *WindowData)
+{
+	if (WindowData->DesiredMapped == WindowData->AppliedMapped)
+		return;
+
+	WindowData->AppliedMapped = WindowData->DesiredMapped;
+
+	if (WindowData->Kind == Window::Kind::CLIENT)
+	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		if (WindowDataCast->Destroyed)
+			return;
+
+		// Our own unmap mustn't look like the client withdrawing
+		if (!WindowData->AppliedMapped)
+		{
+			xcb_void_cookie_t const Cookie = xcb_unmap_window(this->XConnection, WindowData->ID);
+
+			this->Requests.NoteRearrangement(Cookie.sequence);
+			WindowDataCast->PendingUnmaps.push_back(Cookie.sequence);
+			return;
+		}
+	}
+
+	if (WindowData->AppliedMapped)
+		this->Requests.NoteRearrangement(xcb_map_window(this->XConnection, WindowData->ID).sequence);
+	else
+		this->Requests.NoteRearrangement(xcb_unmap_window(this->XConnection, WindowData->ID).sequence);
+}
+
+
+bool IsStackable(Glass::WindowData *WindowData)
+{
+	return WindowData->Kind != Window::Kind::CLIENT || !static_cast<ClientWindowData *>(WindowData)->Destroyed;
+}
+
+
+// Marks the longest run of Positions that's already increasing.  Negative positions are never part of it.
+std::vector<bool> FindLongestIncreasingRun(std::vector<int> const &Positions)
+{
+	std::vector<size_t> Tails;	// For each run length, the index where the run with the lowest last position ends
+	std::vector<size_t> Previous(Positions.size(), std::numeric_limits<size_t>::max());
+
+	for (size_t Index = 0; Index < Positions.size(); Index++)
+	{
+		if (Positions[Index] < 0)
+			continue;
+
+		size_t Low = 0;
+		size_t High = Tails.size();
+
+		while (Low < High)
+		{
+			size_t const Middle = (Low + High) / 2;
+
+			if (Positions[Tails[Middle]] < Positions[Index])
+				Low = Middle + 1;
+			else
+				High = Middle;
+		}
+
+		if (Low > 0)
+			Previous[Index] = Tails[Low - 1];
+
+		if (Low == Tails.size())
+			Tails.push_back(Index);
+		else
+			Tails[Low] = Index;
+	}
+
+	std::vector<bool> Run(Positions.size(), false);
+
+	if (!Tails.empty())
+	{
+		for (size_t Index = Tails.back(); Index != std::numeric_limits<size_t>::max(); Index = Previous[Index])
+			Run[Index] = true;
+	}
+
+	return Run;
+}
+
+
+void X11XCB_DisplayServer::Implementation::ApplyStackingOrder(xcb_window_t ParentID)
+{
+	auto StackingOrdersAccessor = this->GetStackingOrders();
+
+	auto Order = StackingOrdersAccessor->find(ParentID);
+	if (Order == StackingOrdersAccessor->end())
+		return;
+
+	WindowDataList &Desired = Order->second.Desired;
+	WindowDataList &Applied = Order->second.Applied;
+
+	// Destroyed windows can't be restacked, or restacked against
+	Desired.erase(std::stable_partition(Desired.begin(), Desired.end(), IsStackable), Desired.end());
+	Applied.erase(std::stable_partition(Applied.begin(), Applied.end(), IsStackable), Applied.end());
+
+	// Windows that are already in the right order relative to each other can stay where they are.  Every other window
+	// is put directly above the one it should be above, from the bottom up, so each lands on a window that's already in place.
+	std::map<Glass::WindowData *, int> AppliedPositions;
+	for (size_t Index = 0; Index < Applied.size(); Index++)
+		AppliedPositions[Applied[Index]] = Index;
+
+	std::vector<int> Positions;
+	for (auto WindowData : Desired)
+	{
+		auto Position = AppliedPositions.find(WindowData);
+		Positions.push_back(Position != AppliedPositions.end() ? Position->second : -1);
+	}
+
+	std::vector<bool> const InPlace = FindLongestIncreasingRun(Positions);
+
+	for (size_t Index = 0; Index < Desired.size(); Index++)
+	{
+		if (InPlace[Index])
+			continue;
+
+		if (Index == 0)
+		{
+			uint32_t const ConfigureValues[] = { XCB_STACK_MODE_BELOW };
+
+			xcb_void_cookie_t const Cookie = xcb_configure_window(this->XConnection, Desired[Index]->ID, XCB_CONFIG_WINDOW_STACK_MODE, ConfigureValues);
+			this->Requests.NoteRearrangement(Cookie.sequence);
+		}
+		else
+		{
+			uint32_t const ConfigureValues[] = { Desired[Index - 1]->ID, XCB_STACK_MODE_ABOVE };
+
+			xcb_void_cookie_t const Cookie = xcb_configure_window(this->XConnection, Desired[Index]->ID, XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE, ConfigureValues);
+			this->Requests.NoteRearrangement(Cookie.sequence);
+		}
+	}
+
+	Applied = Desired;
+
+	// Keep the published order in step.  Clients inside frames are listed in their frame's place.
+	if (Order->second.Root)
+	{
+		WindowIDList ClientIDs;
+
+		for (auto WindowData : Applied)
+		{
+			if (WindowData->Kind == Window::Kind::FRAME)
+				ClientIDs.push_back(static_cast<AuxiliaryWindowData *>(WindowData)->PrimaryWindowData->ID);
+			else
+				ClientIDs.push_back(WindowData->ID);
+		}
+
+		xcb_change_property(this->XConnection, XCB_PROP_MODE_REPLACE, ParentID,
+							Atoms::_NET_CLIENT_LIST_STACKING, XCB_ATOM_WINDOW, 32, ClientIDs.size(), ClientIDs.data());
+	}
+}
+
+
+void X11XCB_DisplayServer::Implementation::ApplyFocus(Glass::WindowData *WindowData)
+{
+	xcb_window_t WindowID = WindowData->ID;
+
+	if (WindowData->Kind == Window::Kind::CLIENT)
+	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		// Focusing a window that isn't viewable is an error.  Sync has already applied any map changes, so the applied map
+		// states say whether it will be by the time the server gets here.
+		bool const Viewable = !WindowDataCast->Destroyed && WindowDataCast->AppliedMapped &&
+							  (WindowDataCast->FrameData == nullptr || WindowDataCast->FrameData->AppliedMapped);
+
+		if (Viewable)
+		{
+			if (WindowDataCast->NeverFocus)
+				WindowID = WindowDataCast->RootID;
+
+			if (WindowDataCast->Protocols.count(Atoms::WM_TAKE_FOCUS))
+			{
+				xcb_client_message_event_t ClientMessage;
+
+				memset(&ClientMessage, 0, sizeof(ClientMessage));
+
+				ClientMessage.response_type = XCB_CLIENT_MESSAGE;
+				ClientMessage.format = 32;
+				ClientMessage.window = WindowID;
+				ClientMessage.type = Atoms::WM_PROTOCOLS;
+				ClientMessage.data.data32[0] = Atoms::WM_TAKE_FOCUS;
+				ClientMessage.data.data32[1] = XCB_CURRENT_TIME;
+
+				xcb_send_event(this->XConnection, false, WindowDataCast->ID, XCB_EVENT_MASK_NO_EVENT, (char *)&ClientMessage);
+			}
+
+			xcb_void_cookie_t const Cookie = xcb_set_input_focus(this->XConnection, XCB_INPUT_FOCUS_POINTER_ROOT, WindowID, XCB_CURRENT_TIME);
+			this->Requests.Note("ApplyFocus", Cookie.sequence);
+
+			// XXX Set EWMH active window and add to the EWMH focus stack
+		}
+
+		// Keep track of which window has the input focus so we can detect unauthorized changes to the focus and revert them
+		{
+			auto ActiveWindowAccessor = this->GetActiveWindow();
+
+			*ActiveWindowAccessor = WindowDataCast;
+		}
+	}
+	else // This is a root window
+	{
+		xcb_void_cookie_t const Cookie = xcb_set_input_focus(this->XConnection, XCB_INPUT_FOCUS_POINTER_ROOT, WindowID, XCB_CURRENT_TIME);
+		this->Requests.Note("ApplyFocus", Cookie.sequence);
+	}
+}
@@ -20,12 +20,17 @@
 #ifndef GLASS_X11XCB_DISPLAYSERVER_IMPLEMENTATION
 #define GLASS_X11XCB_DISPLAYSERVER_IMPLEMENTATION
 
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <vector>
 
 #include <xcb/xcb.h>
 
 #include "glass/displayserver/X11XCB_DisplayServer.hpp"
 #include "glass/displayserver/x11xcb_displayserver/Atoms.hpp"
+#include "glass/displayserver/x11xcb_displayserver/RequestLog.hpp"
+#include "glass/displayserver/x11xcb_displayserver/TextCache.hpp"
 #include "glass/displayserver/x11xcb_displayserver/WindowData.hpp"
 
 namespace Glass
@@ -48,6 +53,13 @@ namespace Glass
 		xcb_colormap_t	  XColorMap;
 
 
+		// MIT-SHM.  Auxiliary windows are drawn into shared images when the server can attach our memory, which it can't
+		// from another machine, and when its pixel layout matches cairo's.
+		bool	SharedMemory;
+		uint8_t	SharedMemoryCompletion; // The response type of the extension's completion events
+		bool	ProbeSharedMemory();
+
+
 		// Event handling
 		class EventHandler; // Defined in EventHandler.hpp
 		EventHandler *Handler;
@@ -59,12 +71,19 @@ namespace Glass
 		locked_accessor<ClientWindowData *> GetActiveWindow();
 
 
-		// Window data
+		// Window data.  When more than one lock is held, this one is taken first, then geometry changes, pending changes
+		// and stacking orders in that order.  The active window and text cache locks may be taken under any of them.
 		WindowDataContainer	WindowData;
 		mutable std::mutex	WindowDataMutex;
 		locked_accessor<WindowDataContainer> GetWindowData();
 
 
+		// Text measurements and font descriptions
+		TextCache			Text;
+		mutable std::mutex	TextMutex;
+		locked_accessor<TextCache> GetText();
+
+
 		// Geometry changes
 		struct GeometryChange; // Defined in GeometryChange.hpp
 		typedef std::map<xcb_window_t, GeometryChange *> GeometryChangeMap;
@@ -73,18 +92,80 @@ namespace Glass
 		locked_accessor<GeometryChangeMap> GetGeometryChanges();
 
 
+		// Visibility, stacking and focus changes.  Like geometry changes, these are only recorded as they're made, and Sync
+		// reconciles them with what the server already has, so a batch sends one request per window that actually changed.
+		typedef std::vector<Glass::WindowData *>	WindowDataList;
+		typedef std::vector<xcb_window_t>			WindowIDList;
+
+		struct PendingChanges
+		{
+			WindowDataList		Visibility;	// Windows whose desired map state may differ from the applied one
+			WindowIDList		Restacks;	// Parents whose children's desired stacking order may differ from the applied one
+			Glass::WindowData  *Focus;
+		};
+		PendingChanges		Pending;
+		mutable std::mutex	PendingMutex;
+		locked_accessor<PendingChanges> GetPending();
+
+
+		// Stacking orders.  Each parent's managed children are kept bottom to top, both in the order the window manager
+		// wants and in the order the server has, so Sync only has to move the windows that are out of place.
+		enum class StackMode { RAISE, LOWER };
+
+		struct StackingOrder
+		{
+			WindowDataList	Desired;
+			WindowDataList	Applied;	// Windows whose place on the server isn't known are left out
+			bool			Root;		// Root windows' orders are published as _NET_CLIENT_LIST_STACKING
+		};
+		typedef std::map<xcb_window_t, StackingOrder> StackingOrderMap;
+		StackingOrderMap	StackingOrders;
+		mutable std::mutex	StackingOrdersMutex;
+		locked_accessor<StackingOrderMap> GetStackingOrders();
+
+
+		// Request tracking.  Requests are never waited on, so errors and the events they cause arrive later through the
+		// event handler, and are traced back to their requests by sequence number.
+		RequestLog			Requests;
+
+
+		// Client property cache.  Refreshing a property only sends the request, and CollectClientProperties picks up
+		// whichever replies have arrived without waiting for the rest, reporting any changes.
+		std::atomic<unsigned int>	PendingPropertyRequests;
+		bool						RefreshClientProperty(ClientWindowData *WindowData, xcb_atom_t Property); // False if it isn't cached
+		void						CollectClientProperties();
+
+
+		// Times the pointer position had to be asked of the server, when PointerTracker couldn't vouch for it
+		std::atomic<uint64_t>	PointerQueries;
+
+
 		// For internal access
 		locked_accessor<RootWindowList>		GetRootWindows();
 		locked_accessor<ClientWindowList>	GetClientWindows();
 
 
 		// Window creation
-		typedef std::vector<xcb_window_t> WindowIDList;
 		RootWindowList		CreateRootWindows(WindowIDList const &WindowIDs);
 		ClientWindowList	CreateClientWindows(WindowIDList const &WindowIDs);
 
 		// Window manipulation
 		void SetWindowGeometry(Glass::WindowData *WindowData, Vector const &Position, Vector const &Size);
+		void SetWindowMapped(Glass::WindowData *WindowData, bool Mapped);
+		void SetWindowStacking(Glass::WindowData *WindowData, StackMode Mode);
+		void SetWindowFocus(Glass::WindowData *WindowData);
+		void ForgetWindow(Glass::WindowData *WindowData);
+
+		// Stacking order bookkeeping.  New and reparented windows start on top of their parent's children.
+		void AddStackedWindow(Glass::WindowData *WindowData);
+		void RemoveStackedWindow(Glass::WindowData *WindowData);
+		void ResetStackingOrder(Glass::WindowData *WindowData); // For when something else restacks a window's siblings
+		static void MarkRestack(PendingChanges &Pending, xcb_window_t ParentID);
+
+		// Sending changes to the server
+		void ApplyVisibility(Glass::WindowData *WindowData);
+		void ApplyStackingOrder(xcb_window_t ParentID);
+		void ApplyFocus(Glass::WindowData *WindowData);
 	};
 }
 
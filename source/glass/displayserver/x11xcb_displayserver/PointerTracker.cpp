@@ -0,0 +1,87 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <xcb/xcb_event.h>
+
+#include "glass/displayserver/x11xcb_displayserver/PointerTracker.hpp"
+
+using namespace Glass;
+
+std::atomic<uint32_t> PointerTracker::Position(0);
+std::atomic_bool	  PointerTracker::Tracked(false);
+std::atomic_bool	  PointerTracker::Grabbed(false);
+
+
+void PointerTracker::Set(int16_t x, int16_t y)
+{
+	PointerTracker::Position = (uint32_t(uint16_t(x)) << 16) | uint16_t(y);
+}
+
+
+void PointerTracker::Set(int16_t x, int16_t y, bool Tracked)
+{
+	PointerTracker::Set(x, y);
+	PointerTracker::Tracked = Tracked;
+}
+
+
+void PointerTracker::Untrack()
+{
+	PointerTracker::Tracked = false;
+}
+
+
+void PointerTracker::NoteInput(xcb_generic_event_t const *InputEvent)
+{
+	// Key and button events share a layout
+	xcb_button_press_event_t const * const Event = (xcb_button_press_event_t const *)InputEvent;
+
+	PointerTracker::Set(Event->root_x, Event->root_y);
+
+	switch (XCB_EVENT_RESPONSE_TYPE(InputEvent))
+	{
+	case XCB_BUTTON_PRESS:
+		PointerTracker::Grabbed = true;
+		break;
+	case XCB_BUTTON_RELEASE:
+		{
+			uint16_t const AllButtons = XCB_BUTTON_MASK_1 | XCB_BUTTON_MASK_2 | XCB_BUTTON_MASK_3 | XCB_BUTTON_MASK_4 | XCB_BUTTON_MASK_5;
+			uint16_t const Released = Event->detail >= 1 && Event->detail <= 5 ? XCB_BUTTON_MASK_1 << (Event->detail - 1) : 0;
+
+			// The state is from just before the event, so it still has the released button in it
+			if ((Event->state & AllButtons & ~Released) == 0)
+				PointerTracker::Grabbed = false;
+		}
+		break;
+	}
+}
+
+
+bool PointerTracker::IsTrusted()
+{
+	return PointerTracker::Tracked || PointerTracker::Grabbed;
+}
+
+
+Vector PointerTracker::GetPosition()
+{
+	uint32_t const Position = PointerTracker::Position;
+
+	return Vector(int16_t(Position >> 16), int16_t(Position & 0xFFFF));
+}
@@ -0,0 +1,53 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_X11XCB_DISPLAYSERVER_POINTERTRACKER
+#define GLASS_X11XCB_DISPLAYSERVER_POINTERTRACKER
+
+#include <atomic>
+
+#include <xcb/xcb.h>
+
+#include "glass/core/Vector.hpp"
+
+namespace Glass
+{
+	// The pointer position, as last reported by pointer and input events on any of our connections.  Those all carry root
+	// coordinates.  The position is only trusted while every motion is known to reach us: either the pointer is over one of
+	// our own windows that reports its motion, or one of our connections has it grabbed.  Elsewhere it can move unheard.
+	struct PointerTracker
+	{
+		static void	  Set(int16_t x, int16_t y);
+		static void	  Set(int16_t x, int16_t y, bool Tracked); // Tracked if the pointer is over a window that reports its motion
+		static void	  Untrack();
+
+		// Key and button events.  A button press grabs the pointer for whoever it's reported to, until the last release.
+		static void	  NoteInput(xcb_generic_event_t const *InputEvent);
+
+		static bool	  IsTrusted();
+		static Vector GetPosition();
+
+	private:
+		static std::atomic<uint32_t> Position; // Root x in the high half, y in the low half
+		static std::atomic_bool		 Tracked;
+		static std::atomic_bool		 Grabbed;
+	};
+}
+
+#endif
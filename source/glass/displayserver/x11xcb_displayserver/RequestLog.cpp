@@ -0,0 +1,97 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include "glass/displayserver/x11xcb_displayserver/RequestLog.hpp"
+
+using namespace Glass;
+
+RequestLog::RequestLog() :
+	Rearranged(false)
+{
+
+}
+
+
+void RequestLog::Note(char const *Origin, unsigned int Sequence)
+{
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	this->Origins[Sequence] = Origin;
+}
+
+
+void RequestLog::NoteRearrangement(unsigned int Sequence)
+{
+	static char const * const Origin = "a window rearrangement";
+
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	// Rearrangements come in runs, which only need their first request noted
+	if (this->Origins.empty() || this->Origins.rbegin()->second != Origin)
+		this->Origins[Sequence] = Origin;
+
+	this->Rearrangements.insert(this->Rearrangements.end(), Sequence);
+	this->Rearranged = true;
+}
+
+
+bool RequestLog::TakeRearranged()
+{
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	bool const Rearranged = this->Rearranged;
+	this->Rearranged = false;
+
+	return Rearranged;
+}
+
+
+char const *RequestLog::GetOrigin(unsigned int Sequence)
+{
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	// The origin is the latest one noted at or before the request
+	auto Origin = this->Origins.upper_bound(Sequence);
+	if (Origin == this->Origins.begin())
+		return "an untracked request";
+
+	return (--Origin)->second;
+}
+
+
+bool RequestLog::IsRearrangement(unsigned int Sequence)
+{
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	return this->Rearrangements.count(Sequence) != 0;
+}
+
+
+void RequestLog::Retire(unsigned int Sequence)
+{
+	std::lock_guard<std::mutex> Lock(this->Mutex);
+
+	// Keep the origin covering Sequence, as later requests may still be attributed to it
+	auto Origin = this->Origins.upper_bound(Sequence);
+	if (Origin != this->Origins.begin())
+		this->Origins.erase(this->Origins.begin(), --Origin);
+
+	// Sequence itself may still have crossing events to come
+	this->Rearrangements.erase(this->Rearrangements.begin(), this->Rearrangements.lower_bound(Sequence));
+}
@@ -0,0 +1,60 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_X11XCB_DISPLAYSERVER_REQUESTLOG
+#define GLASS_X11XCB_DISPLAYSERVER_REQUESTLOG
+
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace Glass
+{
+	// Sequence numbers of requests that later errors and events have to be matched with.  They're taken from the cookies
+	// xcb returns for the requests themselves, so the log costs nothing extra but a no-op after each run of rearrangements.
+	class RequestLog
+	{
+	public:
+		RequestLog();
+
+		// Errors in Sequence and the requests after it are attributed to Origin, up to the next request noted
+		void		Note(char const *Origin, unsigned int Sequence);
+
+		// A request that moves, resizes, maps, unmaps or restacks a window.  Crossing events it causes carry its sequence number.
+		void		NoteRearrangement(unsigned int Sequence);
+
+		// Whether a rearrangement was noted since the last call.  Every event carries the sequence number of the last request
+		// the server handled, so a request has to follow a run of rearrangements before real crossings can be told apart.
+		bool		TakeRearranged();
+
+		char const *GetOrigin(unsigned int Sequence);
+		bool		IsRearrangement(unsigned int Sequence);
+
+		// The server handles requests in order, so once it has reported on Sequence, nothing before it can cause any more
+		void		Retire(unsigned int Sequence);
+
+	private:
+		std::map<unsigned int, char const *>	Origins;
+		std::set<unsigned int>					Rearrangements;
+		bool									Rearranged;
+		std::mutex								Mutex;
+	};
+}
+
+#endif
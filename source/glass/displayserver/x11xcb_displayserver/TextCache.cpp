@@ -0,0 +1,90 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include "glass/displayserver/x11xcb_displayserver/TextCache.hpp"
+
+using namespace Glass;
+
+TextCache::TextCache(size_t Capacity) :
+	Capacity(Capacity),
+	Surface(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1)),
+	Context(cairo_create(Surface)),
+	Layout(pango_cairo_create_layout(Context))
+{
+
+}
+
+
+TextCache::~TextCache()
+{
+	for (auto &FontDescription : this->FontDescriptions)
+		pango_font_description_free(FontDescription.second);
+
+	g_object_unref(this->Layout);
+	cairo_destroy(this->Context);
+	cairo_surface_destroy(this->Surface);
+}
+
+
+PangoFontDescription const *TextCache::GetFontDescription(char const *FontDescriptionString)
+{
+	this->LookupKey.assign(FontDescriptionString);
+
+	auto FontDescription = this->FontDescriptions.find(this->LookupKey);
+	if (FontDescription == this->FontDescriptions.end())
+		FontDescription = this->FontDescriptions.insert({ this->LookupKey, pango_font_description_from_string(FontDescriptionString) }).first;
+
+	return FontDescription->second;
+}
+
+
+TextCache::Extents TextCache::Measure(std::string const &FontDescriptionString, std::string const &Text)
+{
+	this->LookupKey.assign(FontDescriptionString);
+	this->LookupKey.push_back('\0');
+	this->LookupKey.append(Text);
+
+	auto Index = this->EntryIndex.find(this->LookupKey);
+	if (Index != this->EntryIndex.end())
+	{
+		this->Entries.splice(this->Entries.begin(), this->Entries, Index->second);
+		return Index->second->Value;
+	}
+
+	// Measure it
+	pango_layout_set_font_description(this->Layout, this->GetFontDescription(FontDescriptionString.c_str()));
+	pango_layout_set_text(this->Layout, Text.c_str(), Text.size());
+
+	PangoRectangle InkExtents;
+	pango_layout_get_extents(this->Layout, &InkExtents, nullptr);
+
+	Extents const Value = { (float)InkExtents.width / PANGO_SCALE, (float)InkExtents.height / PANGO_SCALE };
+
+	// Remember it, forgetting the least recently used entry if there's no room.  GetFontDescription used the lookup key.
+	if (this->Entries.size() >= this->Capacity)
+	{
+		this->EntryIndex.erase(this->Entries.back().Key);
+		this->Entries.pop_back();
+	}
+
+	this->Entries.push_front({ FontDescriptionString + '\0' + Text, Value });
+	this->EntryIndex[this->Entries.front().Key] = this->Entries.begin();
+
+	return Value;
+}
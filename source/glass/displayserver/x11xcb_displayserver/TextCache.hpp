@@ -0,0 +1,74 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#ifndef GLASS_X11XCB_DISPLAYSERVER_TEXTCACHE
+#define GLASS_X11XCB_DISPLAYSERVER_TEXTCACHE
+
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <cairo/cairo.h>
+#include <pango/pangocairo.h>
+
+namespace Glass
+{
+	// Parsed font descriptions, and the extents of recently measured text.  Measuring uses a layout of its own, so it
+	// doesn't need an auxiliary window and doesn't disturb their fonts.  The decorator measures the same few strings on
+	// every repaint, so once they've been seen, measuring them is a lookup.
+	class TextCache
+	{
+	public:
+		TextCache(size_t Capacity);
+		TextCache(TextCache const &Other) = delete;
+		~TextCache();
+
+		struct Extents
+		{
+			float Width;
+			float Height;
+		};
+
+		PangoFontDescription const *GetFontDescription(char const *FontDescriptionString);
+		Extents						Measure(std::string const &FontDescriptionString, std::string const &Text);
+
+	private:
+		struct Entry
+		{
+			std::string Key; // The font description and the text, separated by a NUL
+			Extents		Value;
+		};
+		typedef std::list<Entry> EntryList; // Most recently used first
+
+		size_t const Capacity;
+
+		std::map<std::string, PangoFontDescription *> FontDescriptions;
+
+		EntryList												Entries;
+		std::unordered_map<std::string, EntryList::iterator>	EntryIndex;
+		std::string												LookupKey; // Reused, so lookups don't allocate
+
+		cairo_surface_t	   *Surface;
+		cairo_t			   *Context;
+		PangoLayout		   *Layout;
+	};
+}
+
+#endif
@@ -17,6 +17,12 @@
 * Copyright 2014-2015 Chris Foster
 */
 
+#include <algorithm>
+#include <errno.h>
+#include <string.h> // strerror
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
 #include "glass/core/Log.hpp"
 #include "glass/displayserver/x11xcb_displayserver/WindowData.hpp"
 
@@ -24,8 +30,13 @@ using namespace Glass;
 
 WindowData::WindowData(Glass::Window &Window, xcb_window_t ID, uint32_t EventMask) :
 	Window(Window),
+	Kind(Window.GetKind()),
 	ID(ID),
-	EventMask(EventMask)
+	EventMask(EventMask),
+	AppliedPosition(Window.GetPosition()),
+	AppliedSize(Window.GetSize()),
+	DesiredMapped(Window.GetVisibility()),
+	AppliedMapped(Window.GetVisibility())
 {
 
 }
@@ -50,35 +61,263 @@ ClientWindowData::ClientWindowData(Glass::ClientWindow &Window, xcb_window_t ID,
 	NeverFocus(NeverFocus),
 	RootID(RootID),
 	ParentID(ParentID),
+	FrameData(nullptr),
 	Urgent(Urgent),
-	Destroyed(false)
+	Destroyed(false),
+	PendingUnmaps(),
+	AppliedRootPosition(Window.GetPosition()),
+	ConfigureRequestPending(false)
 {
+	xcb_icccm_wm_hints_set_none(&this->WMHints);
+}
+
 
+ClientWindowData::PropertyRequest::PropertyRequest() :
+	Pending(false)
+{
+	this->Cookie.sequence = 0;
+}
+
+
+std::string ClientWindowData::GetName() const
+{
+	return (this->EWMHName != "" ? this->EWMHName : this->ICCCMName);
 }
 
 
 AuxiliaryWindowData::AuxiliaryWindowData(Glass::AuxiliaryWindow &Window, xcb_window_t ID, uint32_t EventMask, WindowData *PrimaryWindowData, xcb_window_t RootID,
-										 cairo_surface_t *CairoSurface, cairo_t *CairoContext, std::string const &CairoFontFace) :
+										 xcb_pixmap_t Backbuffer, xcb_visualtype_t *BackbufferVisual, uint8_t BackbufferDepth, xcb_gcontext_t GraphicsContext,
+										 std::string const &CairoFontFace) :
 	WindowData(Window, ID, EventMask),
 	PrimaryWindowData(PrimaryWindowData),
 	RootID(RootID),
-	CairoSurface(CairoSurface),
-	CairoContext(CairoContext),
+	Backbuffer(Backbuffer),
+	BackbufferVisual(BackbufferVisual),
+	BackbufferDepth(BackbufferDepth),
+	GraphicsContext(GraphicsContext),
+	Image(),
+	CairoSurface(nullptr),
+	CairoContext(nullptr),
 	FontDescriptionString(CairoFontFace),
-	Layout(pango_cairo_create_layout(CairoContext))
+	Layout(nullptr),
+	PaintedHash(0)
+{
+	// Utility windows live inside their primary window
+	if (Window.GetKind() == Glass::Window::Kind::UTILITY)
+		this->AppliedPosition = static_cast<UtilityWindow &>(Window).GetLocalPosition();
+}
+
+
+AuxiliaryWindowData::SharedImage::SharedImage() :
+	Segment(XCB_NONE),
+	Address(nullptr),
+	Capacity(0),
+	AttachSequence(0),
+	UploadSequence(0),
+	RedrawPending(false)
+{
+
+}
+
+
+void DetachSharedImage(xcb_connection_t *XConnection, AuxiliaryWindowData::SharedImage &Image)
+{
+	if (Image.Segment == XCB_NONE)
+		return;
+
+	// The server keeps its own attachment until it has handled the detach, so uploads already sent still complete
+	xcb_shm_detach(XConnection, Image.Segment);
+	shmdt(Image.Address);
+
+	Image = AuxiliaryWindowData::SharedImage();
+}
+
+
+// Makes sure the image can hold Size bytes, replacing its segment with a bigger one if it can't
+bool ReserveSharedImage(xcb_connection_t *XConnection, AuxiliaryWindowData::SharedImage &Image, size_t Size)
+{
+	if (Image.Segment != XCB_NONE && Image.Capacity >= Size)
+		return true;
+
+	DetachSharedImage(XConnection, Image);
+
+	// Leave room to grow, so resizing a window a few pixels at a time doesn't replace the segment every time
+	size_t const PageSize = 4096;
+	size_t const Capacity = (Size + Size / 4 + PageSize - 1) / PageSize * PageSize;
+
+	int const ID = shmget(IPC_PRIVATE, Capacity, IPC_CREAT | 0600);
+	if (ID == -1)
+	{
+		LOG_DEBUG_ERROR << "Could not create a shared memory segment: " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	void * const Address = shmat(ID, nullptr, 0);
+	if (Address == (void *)-1)
+	{
+		LOG_DEBUG_ERROR << "Could not attach a shared memory segment: " << strerror(errno) << std::endl;
+		shmctl(ID, IPC_RMID, nullptr);
+		return false;
+	}
+
+	// Checking the attach would wait on the server.  If it fails, the event handler gets the error and gives up on the image.
+	xcb_shm_seg_t const Segment = xcb_generate_id(XConnection);
+	Image.AttachSequence = xcb_shm_attach(XConnection, Segment, ID, 1).sequence;
+
+	// Linux lets the server attach a segment marked for removal while we're still attached, so it can be marked now and
+	// is freed even if we never detach
+	shmctl(ID, IPC_RMID, nullptr);
+
+	Image.Segment = Segment;
+	Image.Address = (unsigned char *)Address;
+	Image.Capacity = Capacity;
+
+	return true;
+}
+
+
+void CreateCairoSurface(xcb_connection_t *XConnection, AuxiliaryWindowData *WindowData, uint16_t Width, uint16_t Height, bool SharedMemory)
+{
+	WindowData->CairoSurface = nullptr;
+
+	if (SharedMemory)
+	{
+		cairo_format_t const Format = (WindowData->BackbufferDepth == 32 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24);
+		int const Stride = cairo_format_stride_for_width(Format, Width);
+
+		if (ReserveSharedImage(XConnection, WindowData->Image, (size_t)Stride * Height))
+			WindowData->CairoSurface = cairo_image_surface_create_for_data(WindowData->Image.Address, Format, Width, Height, Stride);
+		else
+			LOG_DEBUG_WARNING << "Drawing auxiliary window " << WindowData->ID << " through the server instead." << std::endl;
+	}
+
+	if (WindowData->CairoSurface == nullptr)
+		WindowData->CairoSurface = cairo_xcb_surface_create(XConnection, WindowData->Backbuffer, WindowData->BackbufferVisual, Width, Height);
+
+	WindowData->CairoContext = cairo_create(WindowData->CairoSurface);
+
+	if (WindowData->Layout == nullptr)
+		WindowData->Layout = pango_cairo_create_layout(WindowData->CairoContext);
+	else
+		pango_cairo_update_layout(WindowData->CairoContext, WindowData->Layout);
+}
+
+
+void AuxiliaryWindowData::CreateSurface(xcb_connection_t *XConnection, bool SharedMemory)
 {
+	Vector const Size = this->Window.GetSize();
 
+	CreateCairoSurface(XConnection, this, std::max<short>(Size.x, 1), std::max<short>(Size.y, 1), SharedMemory);
 }
 
 
-void AuxiliaryWindowData::ReplayDrawOperations()
+void AuxiliaryWindowData::DestroySurface(xcb_connection_t *XConnection)
 {
-	for (auto &Operation : this->DrawOperations)
-		Operation();
+	g_object_unref(this->Layout);
+	cairo_destroy(this->CairoContext);
+	cairo_surface_destroy(this->CairoSurface);
+
+	this->Layout = nullptr;
+	this->CairoContext = nullptr;
+	this->CairoSurface = nullptr;
+
+	DetachSharedImage(XConnection, this->Image);
 }
 
 
-WindowDataContainer::iterator::iterator(WindowToDataMap::iterator const &Base) :
+void AuxiliaryWindowData::ResizeBackbuffer(xcb_connection_t *XConnection, Vector const &Size)
+{
+	// Pixmaps can't be empty
+	uint16_t const Width = std::max<short>(Size.x, 1);
+	uint16_t const Height = std::max<short>(Size.y, 1);
+
+	xcb_free_pixmap(XConnection, this->Backbuffer);
+
+	this->Backbuffer = xcb_generate_id(XConnection);
+	xcb_create_pixmap(XConnection, this->BackbufferDepth, this->Backbuffer, this->ID, Width, Height);
+
+	// Image surfaces can't be resized, only replaced
+	if (this->Image.Segment != XCB_NONE)
+	{
+		cairo_destroy(this->CairoContext);
+		cairo_surface_destroy(this->CairoSurface);
+
+		CreateCairoSurface(XConnection, this, Width, Height, true);
+	}
+	else
+		cairo_xcb_surface_set_drawable(this->CairoSurface, this->Backbuffer, Width, Height);
+}
+
+
+bool AuxiliaryWindowData::BeginDrawing()
+{
+	// The server reads the image some time after being asked to.  Rather than wait for it, the event handler redraws
+	// the window when the completion event for the upload comes in.
+	if (this->Image.UploadSequence != 0)
+	{
+		this->Image.RedrawPending = true;
+		return false;
+	}
+
+	return true;
+}
+
+
+void AuxiliaryWindowData::EndDrawing(xcb_connection_t *XConnection)
+{
+	cairo_surface_flush(this->CairoSurface);
+
+	if (this->Image.Segment == XCB_NONE)
+		return;
+
+	uint16_t const Width = cairo_image_surface_get_width(this->CairoSurface);
+	uint16_t const Height = cairo_image_surface_get_height(this->CairoSurface);
+
+	this->Image.UploadSequence = xcb_shm_put_image(XConnection, this->Backbuffer, this->GraphicsContext,
+												   Width, Height, 0, 0, Width, Height, 0, 0,
+												   this->BackbufferDepth, XCB_IMAGE_FORMAT_Z_PIXMAP, 1, this->Image.Segment, 0).sequence;
+}
+
+
+void AuxiliaryWindowData::AbandonSharedImage(xcb_connection_t *XConnection, bool Attached)
+{
+	if (this->Image.Segment == XCB_NONE)
+		return;
+
+	uint16_t const Width = cairo_image_surface_get_width(this->CairoSurface);
+	uint16_t const Height = cairo_image_surface_get_height(this->CairoSurface);
+
+	cairo_destroy(this->CairoContext);
+	cairo_surface_destroy(this->CairoSurface);
+
+	// Detaching a segment the server never attached would only cause another error
+	if (Attached)
+		xcb_shm_detach(XConnection, this->Image.Segment);
+
+	shmdt(this->Image.Address);
+	this->Image = SharedImage();
+
+	CreateCairoSurface(XConnection, this, Width, Height, false);
+}
+
+
+void AuxiliaryWindowData::PresentBackbuffer(xcb_connection_t *XConnection, int16_t x, int16_t y, uint16_t Width, uint16_t Height)
+{
+	cairo_surface_flush(this->CairoSurface);
+
+	xcb_copy_area(XConnection, this->Backbuffer, this->ID, this->GraphicsContext, x, y, x, y, Width, Height);
+}
+
+
+void AuxiliaryWindowData::PresentBackbuffer(xcb_connection_t *XConnection)
+{
+	Vector const Size = this->Window.GetSize();
+
+	this->PresentBackbuffer(XConnection, 0, 0, Size.x, Size.y);
+}
+
+
+WindowDataContainer::iterator::iterator(SlotList::iterator const &Base) :
 	Base(Base)
 {
 
@@ -139,17 +378,17 @@ WindowDataContainer::iterator WindowDataContainer::iterator::operator--(int)
 
 WindowDataContainer::iterator::reference WindowDataContainer::iterator::operator*() const
 {
-	return this->Base->second;
+	return *this->Base;
 }
 
 
 WindowDataContainer::iterator::pointer WindowDataContainer::iterator::operator->() const
 {
-	return &this->Base->second;
+	return &*this->Base;
 }
 
 
-WindowDataContainer::const_iterator::const_iterator(WindowToDataMap::const_iterator const &Base) :
+WindowDataContainer::const_iterator::const_iterator(SlotList::const_iterator const &Base) :
 	Base(Base)
 {
 
@@ -172,7 +411,7 @@ WindowDataContainer::const_iterator::const_iterator(const_iterator const &Other)
 
 WindowDataContainer::const_iterator &WindowDataContainer::const_iterator::operator=(const_iterator const &Other)
 {
-	*this = Other;
+	this->Base = Other.Base;
 	return *this;
 }
 
@@ -217,13 +456,23 @@ WindowDataContainer::const_iterator WindowDataContainer::const_iterator::operato
 
 WindowDataContainer::const_iterator::const_reference WindowDataContainer::const_iterator::operator*() const
 {
-	return this->Base->second;
+	return *this->Base;
 }
 
 
 WindowDataContainer::const_iterator::const_pointer WindowDataContainer::const_iterator::operator->() const
 {
-	return &this->Base->second;
+	return &*this->Base;
+}
+
+
+uint32_t const WindowDataContainer::EmptyIndex;
+
+
+WindowDataContainer::WindowDataContainer() :
+	TableBits(0)
+{
+	this->Rebuild(4);
 }
 
 
@@ -234,18 +483,18 @@ WindowDataContainer::~WindowDataContainer()
 }
 
 
-WindowDataContainer::iterator		WindowDataContainer::begin()		{ return this->WindowToData.begin(); }
-WindowDataContainer::const_iterator	WindowDataContainer::begin() const	{ return this->WindowToData.begin(); }
-WindowDataContainer::const_iterator	WindowDataContainer::cbegin() const	{ return this->WindowToData.cbegin(); }
+WindowDataContainer::iterator		WindowDataContainer::begin()		{ return this->Slots.begin(); }
+WindowDataContainer::const_iterator	WindowDataContainer::begin() const	{ return this->Slots.begin(); }
+WindowDataContainer::const_iterator	WindowDataContainer::cbegin() const	{ return this->Slots.cbegin(); }
 
 
-WindowDataContainer::iterator		WindowDataContainer::end()			{ return this->WindowToData.end(); }
-WindowDataContainer::const_iterator	WindowDataContainer::end() const	{ return this->WindowToData.end(); }
-WindowDataContainer::const_iterator	WindowDataContainer::cend() const	{ return this->WindowToData.cend(); }
+WindowDataContainer::iterator		WindowDataContainer::end()			{ return this->Slots.end(); }
+WindowDataContainer::const_iterator	WindowDataContainer::end() const	{ return this->Slots.end(); }
+WindowDataContainer::const_iterator	WindowDataContainer::cend() const	{ return this->Slots.cend(); }
 
 
-bool							WindowDataContainer::empty() const	{ return this->WindowToData.empty(); }
-WindowDataContainer::size_type	WindowDataContainer::size() const	{ return this->WindowToData.size(); }
+bool							WindowDataContainer::empty() const	{ return this->Slots.empty(); }
+WindowDataContainer::size_type	WindowDataContainer::size() const	{ return this->Slots.size(); }
 
 
 void WindowDataContainer::push_back(value_type WindowData)
@@ -256,21 +505,31 @@ void WindowDataContainer::push_back(value_type WindowData)
 		return;
 	}
 
-	this->WindowToData[&WindowData->Window] = WindowData;
-	this->IDToData[WindowData->ID] = WindowData;
+	// Replace any data the window already has
+	this->erase(&WindowData->Window);
+	this->erase(WindowData->ID);
+
+	// Keep the tables at most half full, so probes stay short
+	if ((this->Slots.size() + 1) * 2 > this->WindowIndex.size())
+		this->Rebuild(this->TableBits + 1);
+
+	uint32_t const Slot = this->Slots.size();
+	this->Slots.push_back(WindowData);
+
+	this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, WindowDataContainer::GetWindowKey(WindowData))] = Slot;
+	this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, WindowDataContainer::GetIDKey(WindowData))] = Slot;
 }
 
 
 WindowDataContainer::size_type WindowDataContainer::erase(Window const *Window)
 {
-	WindowToDataMap::iterator FindData = this->WindowToData.find(Window);
+	uint32_t const Slot = this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, reinterpret_cast<uintptr_t>(Window))];
 
-	if (FindData != this->WindowToData.end())
+	if (Slot != WindowDataContainer::EmptyIndex)
 	{
-		WindowData * const Data = FindData->second;
+		WindowData * const Data = this->Slots[Slot];
 
-		this->WindowToData.erase(FindData);
-		this->IDToData.erase(Data->ID);
+		this->EraseSlot(Slot);
 
 		delete Data;
 
@@ -283,14 +542,13 @@ WindowDataContainer::size_type WindowDataContainer::erase(Window const *Window)
 
 WindowDataContainer::size_type WindowDataContainer::erase(xcb_window_t ID)
 {
-	IDToDataMap::iterator FindData = this->IDToData.find(ID);
+	uint32_t const Slot = this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, ID)];
 
-	if (FindData != this->IDToData.end())
+	if (Slot != WindowDataContainer::EmptyIndex)
 	{
-		WindowData * const Data = FindData->second;
+		WindowData * const Data = this->Slots[Slot];
 
-		this->IDToData.erase(FindData);
-		this->WindowToData.erase(&Data->Window);
+		this->EraseSlot(Slot);
 
 		delete Data;
 
@@ -301,43 +559,142 @@ WindowDataContainer::size_type WindowDataContainer::erase(xcb_window_t ID)
 }
 
 
+// Like the map this replaced, erasing through an iterator doesn't delete the data
 WindowDataContainer::iterator WindowDataContainer::erase(iterator position)
 {
-	this->IDToData.erase((*position)->ID);
-	return this->WindowToData.erase(position.Base);
+	size_t const Slot = position.Base - this->Slots.begin();
+
+	this->EraseSlot(Slot);
+
+	return this->Slots.begin() + Slot;
 }
 
 
 WindowDataContainer::iterator WindowDataContainer::erase(iterator first, iterator last)
 {
-	for (iterator position = first; position != last; ++position)
-		this->IDToData.erase((*position)->ID);
+	size_t const First = first.Base - this->Slots.begin();
+
+	// Erasing a slot moves the last one into it, so work backwards to keep the rest of the range in place
+	for (size_t Slot = last.Base - this->Slots.begin(); Slot > First; Slot--)
+		this->EraseSlot(Slot - 1);
+
+	return this->Slots.begin() + First;
+}
+
+
+WindowDataContainer::iterator WindowDataContainer::find(Window const *Window)
+{
+	uint32_t const Slot = this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, reinterpret_cast<uintptr_t>(Window))];
 
-	return this->WindowToData.erase(first.Base, last.Base);
+	return Slot != WindowDataContainer::EmptyIndex ? this->Slots.begin() + Slot : this->Slots.end();
 }
 
 
-WindowDataContainer::iterator		WindowDataContainer::find(Window const *Window)			{ return this->WindowToData.find(Window); }
-WindowDataContainer::const_iterator	WindowDataContainer::find(Window const *Window) const	{ return this->WindowToData.find(Window); }
+WindowDataContainer::const_iterator WindowDataContainer::find(Window const *Window) const
+{
+	uint32_t const Slot = this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, reinterpret_cast<uintptr_t>(Window))];
+
+	return Slot != WindowDataContainer::EmptyIndex ? this->Slots.cbegin() + Slot : this->Slots.cend();
+}
 
 
 WindowDataContainer::iterator WindowDataContainer::find(xcb_window_t ID)
 {
-	IDToDataMap::iterator FindData = this->IDToData.find(ID);
+	uint32_t const Slot = this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, ID)];
 
-	if (FindData != this->IDToData.end())
-		return this->WindowToData.find(&FindData->second->Window);
-	else
-		return this->end();
+	return Slot != WindowDataContainer::EmptyIndex ? this->Slots.begin() + Slot : this->Slots.end();
 }
 
 
-WindowDataContainer::const_iterator	WindowDataContainer::find(xcb_window_t ID) const
+WindowDataContainer::const_iterator WindowDataContainer::find(xcb_window_t ID) const
 {
-	IDToDataMap::const_iterator FindData = this->IDToData.find(ID);
+	uint32_t const Slot = this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, ID)];
 
-	if (FindData != this->IDToData.cend())
-		return this->WindowToData.find(&FindData->second->Window);
-	else
-		return this->cend();
+	return Slot != WindowDataContainer::EmptyIndex ? this->Slots.cbegin() + Slot : this->Slots.cend();
+}
+
+
+uintptr_t WindowDataContainer::GetWindowKey(WindowData const *Data)	{ return reinterpret_cast<uintptr_t>(&Data->Window); }
+uintptr_t WindowDataContainer::GetIDKey(WindowData const *Data)		{ return Data->ID; }
+
+
+// Fibonacci hashing spreads both aligned pointers and sequential IDs evenly over the table
+size_t WindowDataContainer::GetHome(uintptr_t Key) const
+{
+	return (uint64_t(Key) * 0x9E3779B97F4A7C15ull) >> (64 - this->TableBits);
+}
+
+
+size_t WindowDataContainer::FindPosition(IndexTable const &Table, KeyFunction GetKey, uintptr_t Key) const
+{
+	size_t const Mask = Table.size() - 1;
+
+	size_t Position = this->GetHome(Key);
+	while (Table[Position] != WindowDataContainer::EmptyIndex && GetKey(this->Slots[Table[Position]]) != Key)
+		Position = (Position + 1) & Mask;
+
+	return Position;
+}
+
+
+// Entries after the removed one are shifted back into the gap, so no probe ever stops short of what it's looking for
+void WindowDataContainer::RemovePosition(IndexTable &Table, KeyFunction GetKey, size_t Position)
+{
+	size_t const Mask = Table.size() - 1;
+
+	size_t Gap = Position;
+	for (size_t Next = (Gap + 1) & Mask; Table[Next] != WindowDataContainer::EmptyIndex; Next = (Next + 1) & Mask)
+	{
+		size_t const Home = this->GetHome(GetKey(this->Slots[Table[Next]]));
+
+		// Only move an entry back if the gap is between its home and where it is now
+		if (((Next - Home) & Mask) >= ((Next - Gap) & Mask))
+		{
+			Table[Gap] = Table[Next];
+			Gap = Next;
+		}
+	}
+
+	Table[Gap] = WindowDataContainer::EmptyIndex;
+}
+
+
+// The last slot is moved into the erased one, to keep the slots packed
+void WindowDataContainer::EraseSlot(size_t Slot)
+{
+	WindowData * const Data = this->Slots[Slot];
+
+	this->RemovePosition(this->WindowIndex, WindowDataContainer::GetWindowKey,
+						 this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, WindowDataContainer::GetWindowKey(Data)));
+	this->RemovePosition(this->IDIndex, WindowDataContainer::GetIDKey,
+						 this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, WindowDataContainer::GetIDKey(Data)));
+
+	size_t const Last = this->Slots.size() - 1;
+
+	if (Slot != Last)
+	{
+		WindowData * const Moved = this->Slots[Last];
+
+		this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, WindowDataContainer::GetWindowKey(Moved))] = Slot;
+		this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, WindowDataContainer::GetIDKey(Moved))] = Slot;
+
+		this->Slots[Slot] = Moved;
+	}
+
+	this->Slots.pop_back();
+}
+
+
+void WindowDataContainer::Rebuild(size_t TableBits)
+{
+	this->TableBits = TableBits;
+
+	this->WindowIndex.assign(size_t(1) << TableBits, WindowDataContainer::EmptyIndex);
+	this->IDIndex.assign(size_t(1) << TableBits, WindowDataContainer::EmptyIndex);
+
+	for (uint32_t Slot = 0; Slot < this->Slots.size(); Slot++)
+	{
+		this->WindowIndex[this->FindPosition(this->WindowIndex, WindowDataContainer::GetWindowKey, WindowDataContainer::GetWindowKey(this->Slots[Slot]))] = Slot;
+		this->IDIndex[this->FindPosition(this->IDIndex, WindowDataContainer::GetIDKey, WindowDataContainer::GetIDKey(this->Slots[Slot]))] = Slot;
+	}
 }
@@ -20,16 +20,19 @@
 #ifndef GLASS_X11XCB_DISPLAYSERVER_WINDOWDATA
 #define GLASS_X11XCB_DISPLAYSERVER_WINDOWDATA
 
-#include <functional>
-#include <map>
+#include <cstdint>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <cairo/cairo-xcb.h>
 #include <pango/pangocairo.h>
 #include <xcb/xcb.h>
+#include <xcb/shm.h>
+#include <xcb/xcb_icccm.h>
 
 #include "glass/core/Window.hpp"
+#include "glass/displayserver/x11xcb_displayserver/DrawList.hpp"
 
 namespace Glass
 {
@@ -39,8 +42,17 @@ namespace Glass
 		virtual ~WindowData();
 
 		Glass::Window &Window;
+		Glass::Window::Kind const Kind; // Which WindowData this is, so it can be cast without dynamic_cast
 		xcb_window_t const ID;
 		uint32_t EventMask;
+
+		// The geometry last sent to the server, relative to the window's parent
+		Vector AppliedPosition;
+		Vector AppliedSize;
+
+		// Whether the window should be mapped, and whether the server has been told so.  Reconciled in Sync.
+		bool DesiredMapped;
+		bool AppliedMapped;
 	};
 
 
@@ -61,35 +73,101 @@ namespace Glass
 
 		xcb_window_t RootID;
 		xcb_window_t ParentID;
+		WindowData	*FrameData; // The data of the frame the client is in, if any
 		bool Urgent;
 		bool Destroyed;
+
+		// The state our own requests leave the window in, so the notifications they cause can be told apart from the client's
+		std::vector<unsigned int> PendingUnmaps; // Sequence numbers of our own unmaps whose UnmapNotify may still be coming
+
+		Vector		 AppliedRootPosition; // Differs from AppliedPosition while the client is inside a frame
+		bool		 ConfigureRequestPending; // The client asked to be configured and hasn't been answered yet
+
+		// Properties the client sets, cached so reading them never waits on the server.  When one changes, a new request is
+		// sent and its reply is collected by the event handler once it has arrived.
+		struct PropertyRequest
+		{
+			PropertyRequest();
+
+			bool						Pending;
+			xcb_get_property_cookie_t	Cookie;
+		};
+
+		std::string				EWMHName;
+		std::string				ICCCMName;
+		xcb_icccm_wm_hints_t	WMHints;
+		std::set<xcb_atom_t>	Protocols;
+
+		PropertyRequest EWMHNameRequest;
+		PropertyRequest ICCCMNameRequest;
+		PropertyRequest WMHintsRequest;
+		PropertyRequest ProtocolsRequest;
+
+		std::string GetName() const; // _NET_WM_NAME, or WM_NAME if that's empty
 	};
 
 
 	struct AuxiliaryWindowData : public WindowData
 	{
 		AuxiliaryWindowData(Glass::AuxiliaryWindow &Window, xcb_window_t ID, uint32_t EventMask, WindowData *PrimaryWindowData, xcb_window_t RootID,
-							cairo_surface_t *CairoSurface, cairo_t *CairoContext, std::string const &FontDescriptionString);
+							xcb_pixmap_t Backbuffer, xcb_visualtype_t *BackbufferVisual, uint8_t BackbufferDepth, xcb_gcontext_t GraphicsContext,
+							std::string const &FontDescriptionString);
 
 		WindowData * const PrimaryWindowData;
 		xcb_window_t RootID;
 
-		cairo_surface_t * const CairoSurface;
-		cairo_t * const CairoContext;
+		// Drawing goes to a pixmap the size of the window, which is only redrawn when its content or size changes.
+		// Exposures and VT switches just copy it back onto the window.  The event handler does that copy, so the backbuffer,
+		// its surfaces and its image are only touched with the window data lock held, on whichever thread.
+		xcb_pixmap_t				Backbuffer;
+		xcb_visualtype_t * const	BackbufferVisual;
+		uint8_t const				BackbufferDepth;
+		xcb_gcontext_t const		GraphicsContext;
+
+		// With MIT-SHM, cairo draws into an image in memory shared with the server, and each finished frame is put into the
+		// backbuffer with a single request.  Otherwise cairo draws on the backbuffer itself, sending every operation.
+		struct SharedImage
+		{
+			SharedImage();
+
+			xcb_shm_seg_t	Segment; // XCB_NONE when drawing goes through the server
+			unsigned char  *Address;
+			size_t			Capacity;
+			unsigned int	AttachSequence; // The request attaching the segment, which isn't checked
+			unsigned int	UploadSequence; // The request putting the last frame into the backbuffer, until the server is done with it
+			bool			RedrawPending;	// A redraw was put off until then
+		};
+		SharedImage Image;
+
+		cairo_surface_t *CairoSurface;
+		cairo_t *CairoContext;
 		std::string FontDescriptionString;
 
 		PangoLayout *Layout;
 
-		std::vector<std::function<void()>> DrawOperations;
-		void ReplayDrawOperations();
+		DrawList	DrawOperations;
+		uint64_t	PaintedHash; // The hash of the draw list last painted into the backbuffer
+
+		void CreateSurface(xcb_connection_t *XConnection, bool SharedMemory); // Draws through the server if the image can't be shared
+		void DestroySurface(xcb_connection_t *XConnection);
+
+		void ResizeBackbuffer(xcb_connection_t *XConnection, Vector const &Size); // Leaves it blank
+		bool BeginDrawing(); // False, and the redraw marked pending, while the server may still be reading the last frame
+		void EndDrawing(xcb_connection_t *XConnection); // Puts the shared image into the backbuffer
+		void AbandonSharedImage(xcb_connection_t *XConnection, bool Attached); // Draws through the server after the server couldn't use the image
+		void PresentBackbuffer(xcb_connection_t *XConnection, int16_t x, int16_t y, uint16_t Width, uint16_t Height);
+		void PresentBackbuffer(xcb_connection_t *XConnection);
 	};
 
 
+	// Window data is kept densely packed for iteration, with an open-addressing hash index for lookups by window and
+	// another for lookups by ID.  The WindowData never move, so pointers to them stay valid until they're erased, but
+	// iterators don't survive insertion or erasure.
 	class WindowDataContainer
 	{
 	private:
-		typedef std::map<Window const *, WindowData *>	WindowToDataMap;
-		typedef std::map<xcb_window_t, WindowData *>	IDToDataMap;
+		typedef std::vector<WindowData *>	SlotList;
+		typedef std::vector<uint32_t>		IndexTable; // Slot numbers, or EmptyIndex
 
 	public:
 		typedef size_t				size_type;
@@ -102,7 +180,7 @@ namespace Glass
 		class iterator
 		{
 		public:
-			iterator(WindowToDataMap::iterator const &Base);
+			iterator(SlotList::iterator const &Base);
 			iterator(iterator const &Other);
 
 			typedef WindowDataContainer::value_type	value_type;
@@ -126,13 +204,13 @@ namespace Glass
 			friend class WindowDataContainer;
 			friend class const_iterator;
 
-			WindowToDataMap::iterator Base;
+			SlotList::iterator Base;
 		};
 
 		class const_iterator
 		{
 		public:
-			const_iterator(WindowToDataMap::const_iterator const &Base);
+			const_iterator(SlotList::const_iterator const &Base);
 			const_iterator(iterator const &Other);
 			const_iterator(const_iterator const &Other);
 
@@ -158,9 +236,10 @@ namespace Glass
 		private:
 			friend class WindowDataContainer;
 
-			WindowToDataMap::const_iterator Base;
+			SlotList::const_iterator Base;
 		};
 
+		WindowDataContainer();
 		~WindowDataContainer();
 
 		iterator		begin();
@@ -188,9 +267,22 @@ namespace Glass
 		const_iterator	find(xcb_window_t ID) const;
 
 	private:
-
-		WindowToDataMap	WindowToData;
-		IDToDataMap		IDToData;
+		static uint32_t const EmptyIndex = 0xFFFFFFFF;
+
+		typedef uintptr_t (*KeyFunction)(WindowData const *Data);
+		static uintptr_t GetWindowKey(WindowData const *Data);
+		static uintptr_t GetIDKey(WindowData const *Data);
+
+		size_t	GetHome(uintptr_t Key) const;
+		size_t	FindPosition(IndexTable const &Table, KeyFunction GetKey, uintptr_t Key) const; // Or the empty position where Key would go
+		void	RemovePosition(IndexTable &Table, KeyFunction GetKey, size_t Position);
+		void	EraseSlot(size_t Slot);
+		void	Rebuild(size_t TableBits);
+
+		SlotList	Slots;
+		IndexTable	WindowIndex;
+		IndexTable	IDIndex;
+		size_t		TableBits;
 	};
 }
 
@@ -28,6 +28,7 @@
 #include "glass/core/EventQueue.hpp"
 #include "glass/core/Log.hpp"
 #include "glass/displayserver/x11xcb_displayserver/InputTranslator.hpp"
+#include "glass/displayserver/x11xcb_displayserver/PointerTracker.hpp"
 #include "glass/inputlistener/X11XCB_InputListener.hpp"
 #include "util/scoped_free.hpp"
 
@@ -56,32 +57,8 @@ X11XCB_InputListener::~X11XCB_InputListener()
 
 // Defined in displayserver/x11xcb_displayserver/EventHandler.cpp
 scoped_free<xcb_generic_event_t *> WaitForEvent(xcb_connection_t *XConnection);
-
-
-void GrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow, std::map<Input, Event const *> &BindingMap)
-{
-	BindingMap.clear();
-
-	for (auto &Binding : Config::InputBindings)
-	{
-		XInput Condition = InputTranslator::ToX(Binding.second);
-
-		if (Condition.Type == Input::Type::KEYBOARD)
-			xcb_grab_key(XConnection, true, RootWindow, Condition.ModifierState, Condition.Value.KeyCode, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
-		else
-			xcb_grab_button(XConnection, true, RootWindow, XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION,
-							XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_SYNC, XCB_NONE, XCB_NONE, Condition.Value.Button, Condition.ModifierState);
-
-		BindingMap.insert(std::make_pair(Binding.second, Binding.first));
-	}
-}
-
-
-void UngrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow)
-{
-	xcb_ungrab_key(XConnection, XCB_GRAB_ANY, RootWindow, XCB_BUTTON_MASK_ANY);
-	xcb_ungrab_button(XConnection, XCB_BUTTON_INDEX_ANY, RootWindow, XCB_MOD_MASK_ANY);
-}
+void GrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow, std::map<Input, EventRecord> &BindingMap);
+void UngrabBindings(xcb_connection_t *XConnection, xcb_window_t RootWindow);
 
 
 void X11XCB_InputListener::Listen()
@@ -102,7 +79,7 @@ void X11XCB_InputListener::Listen()
 
 
 	// Translate Glass input into X input and grab the bindings
-	std::map<Input, Event const *> BindingMap;
+	std::map<Input, EventRecord> BindingMap;
 	GrabBindings(XConnection, RootWindow, BindingMap);
 
 	xcb_flush(XConnection);
@@ -119,13 +96,15 @@ void X11XCB_InputListener::Listen()
 			case XCB_KEY_PRESS:
 			case XCB_KEY_RELEASE:
 				{
+					PointerTracker::NoteInput(*Event);
+
 					Input const TranslatedInput = InputTranslator::ToGlass(*Event);
 
 					if (TranslatedInput.IsValid())
 					{
 						auto FindValue = BindingMap.find(TranslatedInput);
 						if (FindValue != BindingMap.end())
-							this->OutgoingEventQueue.AddEvent(*FindValue->second->Copy());
+							this->OutgoingEventQueue.AddEvent(FindValue->second);
 					}
 				}
 				break;
@@ -134,8 +113,10 @@ void X11XCB_InputListener::Listen()
 				{
 					xcb_motion_notify_event_t * const MotionNotify = (xcb_motion_notify_event_t *)*Event;
 
-					this->OutgoingEventQueue.AddEvent(*(new PointerMove_Event(Vector(MotionNotify->root_x,
-																					 MotionNotify->root_y))));
+					// Motion only reaches the listener while one of its button grabs is active
+					PointerTracker::Set(MotionNotify->root_x, MotionNotify->root_y);
+					this->OutgoingEventQueue.AddEvent(PointerMove_Event(Vector(MotionNotify->root_x,
+																			   MotionNotify->root_y)));
 				}
 				break;
 
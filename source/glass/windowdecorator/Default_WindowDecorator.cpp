@@ -108,10 +108,10 @@ namespace Glass
 			float TagWidth = this->TagsWidth / this->TagCount;
 			unsigned short Tag = (Position.x - this->TagsStart) / TagWidth;
 
-			this->WindowDecorator.GetEventQueue().AddEvent(*(new TagDisplay_Event(TagDisplay_Event::Target::ROOT,
-																				  Input.GetModifier() & Glass::Input::Modifier::SHIFT ? TagDisplay_Event::Mode::TOGGLE :
-																																		TagDisplay_Event::Mode::SET,
-																				  0x01 << Tag)));
+			this->WindowDecorator.GetEventQueue().AddEvent(TagDisplay_Event(TagDisplay_Event::Target::ROOT,
+																			Input.GetModifier() & Glass::Input::Modifier::SHIFT ? TagDisplay_Event::Mode::TOGGLE :
+																																  TagDisplay_Event::Mode::SET,
+																			0x01 << Tag));
 		}
 
 
@@ -17,7 +17,11 @@
 * Copyright 2014-2015 Chris Foster
 */
 
+#include <pthread.h>
+#include <signal.h>
+
 #include "config.hpp"
+#include "glass/core/Log.hpp"
 #include "glass/windowmanager/Dynamic_WindowManager.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/EventHandler.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/Implementation.hpp"
@@ -40,11 +44,26 @@ Dynamic_WindowManager::Dynamic_WindowManager(Glass::DisplayServer &DisplayServer
 		this->Data->WindowDecorator = Config::WindowDecorator(DisplayServer, *this);
 	else
 		this->Data->WindowDecorator = nullptr;
+
+	// Dump latencies on SIGUSR1.  The signal has to be blocked everywhere, or it would kill whichever thread it landed on.
+	sigset_t BlockedSignals;
+	if (pthread_sigmask(SIG_BLOCK, nullptr, &BlockedSignals) == 0 && sigismember(&BlockedSignals, SIGUSR1) == 1)
+		this->Data->SignalThread = std::thread(&Implementation::WaitForSignals, this->Data);
+	else
+		LOG_DEBUG_WARNING << "SIGUSR1 isn't blocked, so latencies can't be dumped on request" << std::endl;
 }
 
 
 Dynamic_WindowManager::~Dynamic_WindowManager()
 {
+	if (this->Data->SignalThread.joinable())
+	{
+		this->Data->SignalThreadQuit = true;
+
+		pthread_kill(this->Data->SignalThread.native_handle(), SIGUSR1);
+		this->Data->SignalThread.join();
+	}
+
 	// Destroy event handler
 	delete this->Data->Handler;
 
@@ -107,3 +126,49 @@ Dynamic_WindowManager::TagMask Dynamic_WindowManager::GetTagMask(ClientWindow &C
 
 	return TagContainer->GetClientWindowTagMask(ClientWindow);
 }
+
+
+LatencyHistogram const &Dynamic_WindowManager::GetLatency(Event::Type Type, LatencyStage Stage) const
+{
+	return this->Data->Handler->GetLatency(Type, Stage);
+}
+
+
+LatencyHistogram const &Dynamic_WindowManager::GetSyncDuration() const
+{
+	return this->Data->Handler->GetSyncDuration();
+}
+
+
+void Dynamic_WindowManager::DumpLatencies(std::ostream &Stream) const
+{
+	Stream << "Event latencies in microseconds, as 50th / 99th / 99.9th percentile / maximum:" << std::endl;
+
+	char const * const StageNames[LatencyStageCount] = { "queued", "handled", "total" };
+
+	LatencyHistogram const &SyncDuration = this->GetSyncDuration();
+
+	Stream << "  Sync (" << SyncDuration.GetCount() << " syncs): " << SyncDuration.GetPercentile(50.0) / 1000.0 << " / " <<
+																	 SyncDuration.GetPercentile(99.0) / 1000.0 << " / " <<
+																	 SyncDuration.GetPercentile(99.9) / 1000.0 << " / " <<
+																	 SyncDuration.GetMaximum() / 1000.0 << std::endl;
+
+	for (size_t Type = 0; Type < Event::TypeCount; Type++)
+	{
+		uint64_t const Count = this->GetLatency(static_cast<Event::Type>(Type), LatencyStage::TOTAL).GetCount();
+		if (Count == 0)
+			continue;
+
+		Stream << "  " << Event::GetTypeName(static_cast<Event::Type>(Type)) << " (" << Count << " events)" << std::endl;
+
+		for (size_t Stage = 0; Stage < LatencyStageCount; Stage++)
+		{
+			LatencyHistogram const &Latency = this->GetLatency(static_cast<Event::Type>(Type), static_cast<LatencyStage>(Stage));
+
+			Stream << "    " << StageNames[Stage] << ": " << Latency.GetPercentile(50.0) / 1000.0 << " / " <<
+													   Latency.GetPercentile(99.0) / 1000.0 << " / " <<
+													   Latency.GetPercentile(99.9) / 1000.0 << " / " <<
+													   Latency.GetMaximum() / 1000.0 << std::endl;
+		}
+	}
+}
@@ -20,9 +20,12 @@
 #ifndef GLASS_WINDOWMANAGER_DYNAMIC_WINDOWMANAGER
 #define GLASS_WINDOWMANAGER_DYNAMIC_WINDOWMANAGER
 
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include "glass/core/Event.hpp"
+#include "glass/core/LatencyHistogram.hpp"
 #include "glass/core/WindowManager.hpp"
 
 namespace Glass
@@ -43,6 +46,19 @@ namespace Glass
 
 		TagMask					 GetTagMask(ClientWindow &ClientWindow) const;
 
+		// Nanoseconds from an event's arrival at the display server until it's taken from the queue, from then until
+		// the display server has synced the results of handling it, and the two together
+		enum class LatencyStage { QUEUED,
+								  HANDLED,
+								  TOTAL };
+
+		static size_t const LatencyStageCount = 3;
+
+		// A dump is also written to the log whenever the process receives SIGUSR1, as long as it's blocked in every thread
+		LatencyHistogram const &GetLatency(Event::Type Type, LatencyStage Stage) const;
+		LatencyHistogram const &GetSyncDuration() const; // Nanoseconds each display server sync takes
+		void					DumpLatencies(std::ostream &Stream) const;
+
 	private:
 		struct Implementation;
 		Implementation *Data;
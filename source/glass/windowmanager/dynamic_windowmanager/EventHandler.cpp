@@ -17,22 +17,27 @@
 * Copyright 2014-2015 Chris Foster
 */
 
-#include <array>
+#include <algorithm>
+#include <chrono>
 #include <unistd.h>
+#include <vector>
 
 #include "config.hpp"
 #include "glass/core/DisplayServer.hpp"
 #include "glass/core/Event.hpp"
 #include "glass/core/EventQueue.hpp"
+#include "glass/core/FlightRecorder.hpp"
 #include "glass/core/Log.hpp"
 #include "glass/core/WindowLayout.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/EventHandler.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/TagManager.hpp"
+#include "util/timestamp.hpp"
 
 using namespace Glass;
 
 Dynamic_WindowManager::Implementation::EventHandler::EventHandler(Dynamic_WindowManager::Implementation &Owner) :
-	Owner(Owner)
+	Owner(Owner),
+	Statistics()
 {
 
 }
@@ -40,15 +45,103 @@ Dynamic_WindowManager::Implementation::EventHandler::EventHandler(Dynamic_Window
 
 void Dynamic_WindowManager::Implementation::EventHandler::Listen()
 {
-	while (Glass::Event const *Event = this->Owner.WindowManager.IncomingEventQueue.WaitForEvent())
+	// Handle everything that's waiting, then sync the display server once for the whole batch
+	std::vector<EventRecord> Events(std::max<size_t>(Config::EventBatchSize, 1));
+	std::chrono::milliseconds const BatchTime(Config::EventBatchTime);
+
+	FlightRecorder * const Recorder = this->Owner.WindowManager.IncomingEventQueue.GetRecorder();
+
+	while (size_t const EventCount = this->Owner.WindowManager.IncomingEventQueue.DrainEvents(Events.data(), Events.size()))
 	{
-		this->Handle(Event);
+		uint64_t const DequeueTime = timestamp();
+
+		auto BatchStart = std::chrono::steady_clock::now();
+		size_t BatchBegin = 0;
+
+		for (size_t i = 0; i < EventCount; i++)
+		{
+			if (Recorder != nullptr)
+			{
+				auto const HandleStart = std::chrono::steady_clock::now();
+
+				this->Handle(&*Events[i]);
+
+				Recorder->RecordHandled(Events[i], std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - HandleStart).count());
+			}
+			else
+				this->Handle(&*Events[i]);
+
+			if (this->Owner.Quit)
+			{
+				this->EndBatch(&Events[BatchBegin], i + 1 - BatchBegin, DequeueTime);
+
+				LOG_DEBUG_INFO << "Handled " << this->Statistics.Events << " events in " << this->Statistics.Batches << " batches, the largest being " <<
+								  this->Statistics.LargestBatch << " events" << std::endl;
+				return;
+			}
+
+			// Don't let a long batch hold back what's already been handled
+			if (i + 1 < EventCount && std::chrono::steady_clock::now() - BatchStart >= BatchTime)
+			{
+				this->EndBatch(&Events[BatchBegin], i + 1 - BatchBegin, DequeueTime);
+
+				BatchStart = std::chrono::steady_clock::now();
+				BatchBegin = i + 1;
+			}
+		}
+
+		this->EndBatch(&Events[BatchBegin], EventCount - BatchBegin, DequeueTime);
+	}
+}
+
+
+Dynamic_WindowManager::Implementation::EventHandler::BatchStatistics const &Dynamic_WindowManager::Implementation::EventHandler::GetBatchStatistics() const
+{
+	return this->Statistics;
+}
+
 
-		delete Event;
+LatencyHistogram const &Dynamic_WindowManager::Implementation::EventHandler::GetLatency(Event::Type Type, Dynamic_WindowManager::LatencyStage Stage) const
+{
+	return this->Latencies[static_cast<size_t>(Type)][static_cast<size_t>(Stage)];
+}
+
+
+LatencyHistogram const &Dynamic_WindowManager::Implementation::EventHandler::GetSyncDuration() const
+{
+	return this->SyncDurations;
+}
+
+
+void Dynamic_WindowManager::Implementation::EventHandler::EndBatch(EventRecord const *Events, size_t EventCount, uint64_t DequeueTime)
+{
+	uint64_t const SyncStart = timestamp();
+
+	this->Owner.WindowManager.DisplayServer.Sync();
+
+	uint64_t const SyncTime = timestamp();
+
+	this->SyncDurations.Record(SyncTime - SyncStart);
+
+	for (size_t i = 0; i < EventCount; i++)
+	{
+		LatencyHistogram * const TypeLatencies = this->Latencies[static_cast<size_t>(Events[i]->GetType())];
+		uint64_t const ArrivalTime = std::min(Events[i].GetTime(), DequeueTime);
 
-		if (this->Owner.Quit)
-			return;
+		TypeLatencies[static_cast<size_t>(LatencyStage::QUEUED)].Record(DequeueTime - ArrivalTime);
+		TypeLatencies[static_cast<size_t>(LatencyStage::HANDLED)].Record(SyncTime - DequeueTime);
+		TypeLatencies[static_cast<size_t>(LatencyStage::TOTAL)].Record(SyncTime - ArrivalTime);
 	}
+
+	this->Statistics.Batches++;
+	this->Statistics.Events += EventCount;
+	this->Statistics.LargestBatch = std::max<unsigned long>(this->Statistics.LargestBatch, EventCount);
+
+	unsigned int Bucket = 0;
+	while ((EventCount >>= 1) && Bucket < 7)
+		Bucket++;
+
+	this->Statistics.BatchSizes[Bucket]++;
 }
 
 
@@ -82,792 +175,709 @@ short RoundIntToNearest(short Value, short Denominator)
 }
 
 
-void Dynamic_WindowManager::Implementation::EventHandler::Handle(Event const *Event)
+constexpr Dynamic_WindowManager::Implementation::EventHandler::HandlerFunction Dynamic_WindowManager::Implementation::EventHandler::Handlers[];
+
+
+void Dynamic_WindowManager::Implementation::EventHandler::Handle(Glass::Event const *Event)
 {
-	// Just some debug printing
-	switch (Event->GetType())
-	{
-	case Glass::Event::Type::ROOT_CREATE:
-		LOG_DEBUG_INFO << "Root Create event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_CREATE:
-		LOG_DEBUG_INFO << "Client Create event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_DESTROY:
-		LOG_DEBUG_INFO << "Client Destroy event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_GEOMETRY_CHANGE_REQUEST:
-		LOG_DEBUG_INFO << "Client Geometry Change Request event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_ICONIFIED_REQUEST:
-		LOG_DEBUG_INFO << "Client Iconified Request event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_URGENCY_CHANGE:
-		LOG_DEBUG_INFO << "Client Urgency Change event!" << std::endl;
-		break;
-	case Glass::Event::Type::CLIENT_FULLSCREEN_REQUEST:
-		LOG_DEBUG_INFO << "Client Fullscreen Request event!" << std::endl;
-		break;
-	case Glass::Event::Type::PRIMARY_NAME_CHANGE:
-		LOG_DEBUG_INFO << "Primary Name Change event!" << std::endl;
-		break;
-	case Glass::Event::Type::POINTER_MOVE:
-		//LOG_DEBUG_INFO << "Pointer Move event!" << std::endl;
-		break;
-	case Glass::Event::Type::WINDOW_ENTER:
-		LOG_DEBUG_INFO << "Enter Window event!" << std::endl;
-		break;
-	case Glass::Event::Type::INPUT:
-		LOG_DEBUG_INFO << "Input event!" << std::endl;
-		break;
-	case Glass::Event::Type::WINDOW_MOVE_MODAL:
-		LOG_DEBUG_INFO << "Modal Window Move event!" << std::endl;
-		break;
-	case Glass::Event::Type::WINDOW_RESIZE_MODAL:
-		LOG_DEBUG_INFO << "Modal Window Resize event!" << std::endl;
-		break;
-	case Glass::Event::Type::WINDOW_CLOSE:
-		LOG_DEBUG_INFO << "Close Window event!" << std::endl;
-		break;
-	case Glass::Event::Type::FLOATING_TOGGLE:
-		LOG_DEBUG_INFO << "Floating Toggle event!" << std::endl;
-		break;
-	case Glass::Event::Type::FLOATING_RAISE:
-		LOG_DEBUG_INFO << "Floating Raise event!" << std::endl;
-		break;
-	case Glass::Event::Type::SWITCH_TABBED:
-		LOG_DEBUG_INFO << "Switch Tabbed event!" << std::endl;
-		break;
-	case Glass::Event::Type::FOCUS_CYCLE:
-		LOG_DEBUG_INFO << "Focus Cycle event!" << std::endl;
-		break;
-	case Glass::Event::Type::LEVEL_TOGGLE:
-		LOG_DEBUG_INFO << "Level Toggle event!" << std::endl;
-		break;
-	case Glass::Event::Type::LAYOUT_CYCLE:
-		LOG_DEBUG_INFO << "Layout Cycle event!" << std::endl;
-		break;
-	case Glass::Event::Type::SPAWN_COMMAND:
-		LOG_DEBUG_INFO << "Spawn Command event!" << std::endl;
-		break;
-	case Glass::Event::Type::FULLSCREEN_TOGGLE:
-		LOG_DEBUG_INFO << "Fullscreen Toggle event!" << std::endl;
-		break;
-	case Glass::Event::Type::TAG_DISPLAY:
-		LOG_DEBUG_INFO << "Tag Display event!" << std::endl;
-		break;
-	case Glass::Event::Type::MANAGER_QUIT:
-		LOG_DEBUG_INFO << "Manager Quit event!" << std::endl;
-		break;
-	default:
-		LOG_DEBUG_INFO << "Some other type of event received!" << std::endl;
-	}
+	if (Event->GetType() != Glass::Event::Type::POINTER_MOVE)
+		LOG_DEBUG_INFO << Glass::Event::GetTypeName(Event->GetType()) << " event!" << std::endl;
 
-	static ClientWindow *ModalMove = nullptr;
-	static ClientWindow *ModalResize = nullptr;
-	static Vector ModalOldPosition;
-	static Vector ModalResizeMask;
+	(this->*EventHandler::Handlers[static_cast<size_t>(Event->GetType())])(Event);
+}
 
-	static ClientWindow *TabbedTarget = nullptr;
 
-	switch (Event->GetType())
+void Dynamic_WindowManager::Implementation::EventHandler::HandleRootCreate(Glass::Event const *Event)
+{
+	RootCreate_Event const * const EventCast = static_cast<RootCreate_Event const *>(Event);
+
 	{
-	case Glass::Event::Type::ROOT_CREATE:
-		{
-			RootCreate_Event const * const EventCast = static_cast<RootCreate_Event const *>(Event);
+		auto RootWindowsAccessor = this->Owner.WindowManager.GetRootWindows();
 
-			{
-				auto RootWindowsAccessor = this->Owner.WindowManager.GetRootWindows();
+		RootWindowsAccessor->push_back(&EventCast->RootWindow);
+	}
 
-				RootWindowsAccessor->push_back(&EventCast->RootWindow);
-			}
+	if (this->Owner.ActiveRoot == nullptr)
+		this->Owner.ActiveRoot = &EventCast->RootWindow;
 
-			if (this->Owner.ActiveRoot == nullptr)
-				this->Owner.ActiveRoot = &EventCast->RootWindow;
+	this->Owner.RootTags.insert(EventCast->RootWindow);
 
-			this->Owner.RootTags.insert(EventCast->RootWindow);
+	// To set the root's decorated size for the tags' window layouts
+	if (this->Owner.WindowDecorator != nullptr)
+		this->Owner.WindowDecorator->DecorateWindow(EventCast->RootWindow);
 
-			// To set the root's decorated size for the tags' window layouts
-			if (this->Owner.WindowDecorator != nullptr)
-				this->Owner.WindowDecorator->DecorateWindow(EventCast->RootWindow);
+	auto TagContainer = this->Owner.RootTags[EventCast->RootWindow];
+	for (auto &TagName : Config::TagNames)
+		TagContainer->CreateTag(TagName);
 
-			auto TagContainer = this->Owner.RootTags[EventCast->RootWindow];
-			for (auto &TagName : Config::TagNames)
-				TagContainer->CreateTag(TagName);
+	// To get the new tag information
+	if (this->Owner.WindowDecorator != nullptr)
+		this->Owner.WindowDecorator->DecorateWindow(EventCast->RootWindow);
+}
 
-			// To get the new tag information
-			if (this->Owner.WindowDecorator != nullptr)
-				this->Owner.WindowDecorator->DecorateWindow(EventCast->RootWindow);
-		}
-		break;
 
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientCreate(Glass::Event const *Event)
+{
+	ClientCreate_Event const * const EventCast = static_cast<ClientCreate_Event const *>(Event);
 
-	case Glass::Event::Type::CLIENT_CREATE:
-		{
-			ClientCreate_Event const * const EventCast = static_cast<ClientCreate_Event const *>(Event);
+	// Add the client to the client list
+	{
+		auto ClientWindowsAccessor = this->Owner.WindowManager.GetClientWindows();
 
-			// Add the client to the client list
-			{
-				auto ClientWindowsAccessor = this->Owner.WindowManager.GetClientWindows();
+		ClientWindowsAccessor->push_back(&EventCast->ClientWindow);
+	}
 
-				ClientWindowsAccessor->push_back(&EventCast->ClientWindow);
-			}
+	// Add the client to a root, based on shared area
+	{
+		auto RootWindowsAccessor = this->Owner.WindowManager.GetRootWindows();
 
-			// Add the client to a root, based on shared area
+		RootWindow *SelectedRoot = RootWindowsAccessor->front();
+		int LargestArea = 0;
+		for (auto Root : *RootWindowsAccessor)
+		{
+			int const Area = IntersectingArea(*Root, EventCast->ClientWindow);
+			if (Area > LargestArea)
 			{
-				auto RootWindowsAccessor = this->Owner.WindowManager.GetRootWindows();
-
-				RootWindow *SelectedRoot = RootWindowsAccessor->front();
-				int LargestArea = 0;
-				for (auto Root : *RootWindowsAccessor)
-				{
-					int const Area = IntersectingArea(*Root, EventCast->ClientWindow);
-					if (Area > LargestArea)
-					{
-						LargestArea = Area;
-						SelectedRoot = Root;
-					}
-				}
-
-				auto ClientWindowsAccessor = SelectedRoot->GetClientWindows();
-
-				ClientWindowsAccessor->push_back(&EventCast->ClientWindow);
+				LargestArea = Area;
+				SelectedRoot = Root;
 			}
+		}
 
-			bool const Floating = ClientShouldFloat(EventCast->ClientWindow);
+		auto ClientWindowsAccessor = SelectedRoot->GetClientWindows();
 
-			this->Owner.ClientData.insert(new Glass::ClientData(EventCast->ClientWindow, Floating));
+		ClientWindowsAccessor->push_back(&EventCast->ClientWindow);
+	}
 
-			this->Owner.RootTags[*EventCast->ClientWindow.GetRootWindow()]->AddClientWindow(EventCast->ClientWindow, Floating);
+	bool const Floating = ClientShouldFloat(EventCast->ClientWindow);
 
-			if (this->Owner.WindowDecorator != nullptr)
-				this->Owner.WindowDecorator->DecorateWindow(EventCast->ClientWindow, this->Owner.GetDecorationHint(EventCast->ClientWindow));
+	this->Owner.ClientData.insert(new Glass::ClientData(EventCast->ClientWindow, Floating));
 
-			// Activate the new client only if the current active client isn't fullscreen
-			if ((this->Owner.ActiveClient != nullptr && this->Owner.ActiveClient->GetFullscreen() == false) ||
-				 this->Owner.ActiveClient == nullptr)
-			{
-				if (Floating)
-					this->Owner.SetClientRaised(EventCast->ClientWindow, true);
+	this->Owner.RootTags[*EventCast->ClientWindow.GetRootWindow()]->AddClientWindow(EventCast->ClientWindow, Floating);
 
-				this->Owner.ActivateClient(EventCast->ClientWindow);
-			}
+	if (this->Owner.WindowDecorator != nullptr)
+		this->Owner.WindowDecorator->DecorateWindow(EventCast->ClientWindow, this->Owner.GetDecorationHint(EventCast->ClientWindow));
 
-			if (EventCast->ClientWindow.GetFullscreen())
-				this->Owner.SetClientFullscreen(EventCast->ClientWindow, true);
+	// Activate the new client only if the current active client isn't fullscreen
+	if ((this->Owner.ActiveClient != nullptr && this->Owner.ActiveClient->GetFullscreen() == false) ||
+		 this->Owner.ActiveClient == nullptr)
+	{
+		if (Floating)
+			this->Owner.SetClientRaised(EventCast->ClientWindow, true);
 
-			for (auto &Rule : Config::ClientRules)
-				Rule.Apply(EventCast->ClientWindow);
+		this->Owner.ActivateClient(EventCast->ClientWindow);
+	}
 
-			this->Owner.RefreshStackingOrder();
-		}
-		break;
+	if (EventCast->ClientWindow.GetFullscreen())
+		this->Owner.SetClientFullscreen(EventCast->ClientWindow, true);
+
+	for (auto &Rule : Config::ClientRules)
+		Rule.Apply(EventCast->ClientWindow);
+
+	this->Owner.RefreshStackingOrder();
+}
+
+
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientDestroy(Glass::Event const *Event)
+{
+	ClientDestroy_Event const * const EventCast = static_cast<ClientDestroy_Event const *>(Event);
 
+	if (this->Owner.ClientData.erase(EventCast->ClientWindow))
+	{
+		RootWindow * const ClientRoot = EventCast->ClientWindow.GetRootWindow();
 
-	case Glass::Event::Type::CLIENT_DESTROY:
+		// Focus the next client, if there is one
 		{
-			ClientDestroy_Event const * const EventCast = static_cast<ClientDestroy_Event const *>(Event);
+			auto TagContainer = this->Owner.RootTags[*ClientRoot];
 
-			if (this->Owner.ClientData.erase(EventCast->ClientWindow))
-			{
-				RootWindow * const ClientRoot = EventCast->ClientWindow.GetRootWindow();
+			TagContainer->RemoveClientWindow(EventCast->ClientWindow);
+			if (TagContainer->GetActiveTag()->size() > 0)
+				this->Owner.ActivateClient(**TagContainer->GetActiveTag()->begin());
+		}
 
-				// Focus the next client, if there is one
-				{
-					auto TagContainer = this->Owner.RootTags[*ClientRoot];
+		{
+			auto ClientWindowsAccessor = EventCast->ClientWindow.GetRootWindow()->GetClientWindows();
 
-					TagContainer->RemoveClientWindow(EventCast->ClientWindow);
-					if (TagContainer->GetActiveTag()->size() > 0)
-						this->Owner.ActivateClient(**TagContainer->GetActiveTag()->begin());
-				}
+			ClientWindowsAccessor->remove(&EventCast->ClientWindow);
+		}
 
-				{
-					auto ClientWindowsAccessor = EventCast->ClientWindow.GetRootWindow()->GetClientWindows();
+		{
+			auto ClientWindowsAccessor = this->Owner.WindowManager.GetClientWindows();
 
-					ClientWindowsAccessor->remove(&EventCast->ClientWindow);
-				}
+			ClientWindowsAccessor->remove(&EventCast->ClientWindow);
+			this->Owner.SetClientRaised(EventCast->ClientWindow, false);
+			this->Owner.SetClientLowered(EventCast->ClientWindow, false);
+		}
 
-				{
-					auto ClientWindowsAccessor = this->Owner.WindowManager.GetClientWindows();
+		if (&EventCast->ClientWindow == this->Owner.ActiveClient)
+			this->Owner.ActiveClient = nullptr;
 
-					ClientWindowsAccessor->remove(&EventCast->ClientWindow);
-					this->Owner.SetClientRaised(EventCast->ClientWindow, false);
-					this->Owner.SetClientLowered(EventCast->ClientWindow, false);
-				}
+		if (this->Owner.WindowDecorator != nullptr)
+			this->Owner.WindowDecorator->DecorateWindow(*ClientRoot);
 
-				if (&EventCast->ClientWindow == this->Owner.ActiveClient)
-					this->Owner.ActiveClient = nullptr;
+		if (this->Owner.ModalMove == &EventCast->ClientWindow)
+			this->Owner.ModalMove = nullptr;
 
-				if (this->Owner.WindowDecorator != nullptr)
-					this->Owner.WindowDecorator->DecorateWindow(*ClientRoot);
+		if (this->Owner.ModalResize == &EventCast->ClientWindow)
+			this->Owner.ModalResize = nullptr;
 
-				if (ModalMove == &EventCast->ClientWindow)
-					ModalMove = nullptr;
+		if (this->Owner.TabbedTarget == &EventCast->ClientWindow)
+			this->Owner.TabbedTarget = nullptr;
 
-				if (ModalResize == &EventCast->ClientWindow)
-					ModalResize = nullptr;
+		delete &EventCast->ClientWindow;
+	}
+}
 
-				delete &EventCast->ClientWindow;
-			}
-		}
-		break;
 
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientGeometryChangeRequest(Glass::Event const *Event)
+{
+	ClientGeometryChangeRequest_Event const * const EventCast = static_cast<ClientGeometryChangeRequest_Event const *>(Event);
 
-	case Glass::Event::Type::CLIENT_GEOMETRY_CHANGE_REQUEST:
+	ClientDataContainer::iterator ClientData;
+	if ((ClientData = this->Owner.ClientData.find(EventCast->ClientWindow)) != this->Owner.ClientData.end())
+	{
+		if (!ClientData->second->Floating)
 		{
-			ClientGeometryChangeRequest_Event const * const EventCast = static_cast<ClientGeometryChangeRequest_Event const *>(Event);
+			EventCast->ClientWindow.SetGeometry(EventCast->ClientWindow.GetPosition(),
+												EventCast->ClientWindow.GetSize());
+		}
+		else
+		{
+			Vector const Position(EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::POSITION_X ? EventCast->Position.x : EventCast->ClientWindow.GetPosition().x,
+								  EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::POSITION_Y ? EventCast->Position.y : EventCast->ClientWindow.GetPosition().y);
 
-			ClientDataContainer::iterator ClientData;
-			if ((ClientData = this->Owner.ClientData.find(EventCast->ClientWindow)) != this->Owner.ClientData.end())
-			{
-				if (!ClientData->second->Floating)
-				{
-					EventCast->ClientWindow.SetGeometry(EventCast->ClientWindow.GetPosition(),
-														EventCast->ClientWindow.GetSize());
-				}
-				else
-				{
-					Vector const Position(EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::POSITION_X ? EventCast->Position.x : EventCast->ClientWindow.GetPosition().x,
-										  EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::POSITION_Y ? EventCast->Position.y : EventCast->ClientWindow.GetPosition().y);
-
-					Vector const Size(EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::SIZE_X ? EventCast->Size.x : EventCast->ClientWindow.GetSize().x,
-									  EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::SIZE_Y ? EventCast->Size.y : EventCast->ClientWindow.GetSize().y);
-
-					EventCast->ClientWindow.SetGeometry(Position, Size);
-				}
-			}
+			Vector const Size(EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::SIZE_X ? EventCast->Size.x : EventCast->ClientWindow.GetSize().x,
+							  EventCast->ValueMask & ClientGeometryChangeRequest_Event::Values::SIZE_Y ? EventCast->Size.y : EventCast->ClientWindow.GetSize().y);
+
+			EventCast->ClientWindow.SetGeometry(Position, Size);
 		}
-		break;
+	}
+}
 
 
-	case Glass::Event::Type::CLIENT_ICONIFIED_REQUEST:
-		{
-			ClientIconifiedRequest_Event const * const EventCast = static_cast<ClientIconifiedRequest_Event const *>(Event);
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientIconifiedRequest(Glass::Event const *Event)
+{
+	ClientIconifiedRequest_Event const * const EventCast = static_cast<ClientIconifiedRequest_Event const *>(Event);
 
-			if (EventCast->State == EventCast->ClientWindow.GetIconified())
-				break;
+	if (EventCast->State == EventCast->ClientWindow.GetIconified())
+		return;
 
-			TagManager::TagContainer * const TagContainer = this->Owner.RootTags[*EventCast->ClientWindow.GetRootWindow()];
+	TagManager::TagContainer * const TagContainer = this->Owner.RootTags[*EventCast->ClientWindow.GetRootWindow()];
 
-			if (EventCast->State == true)
-			{
-				TagContainer->RemoveClientWindow(EventCast->ClientWindow);
-
-				if (&EventCast->ClientWindow == this->Owner.ActiveClient)
-				{
-					ClientWindow * const NewActiveClient = TagContainer->GetActiveTag()->GetActiveClient();
-
-					if (NewActiveClient != nullptr)
-						this->Owner.ActivateClient(*NewActiveClient);
-					else
-					{
-						this->Owner.ActiveClient = nullptr;
-						EventCast->ClientWindow.GetRootWindow()->SetActiveClientWindow(nullptr);
-
-						if (this->Owner.WindowDecorator != nullptr)
-							this->Owner.WindowDecorator->DecorateWindow(*this->Owner.ActiveRoot);
-					}
-				}
-			}
+	if (EventCast->State == true)
+	{
+		TagContainer->RemoveClientWindow(EventCast->ClientWindow);
 
-			EventCast->ClientWindow.SetIconified(EventCast->State);
+		if (&EventCast->ClientWindow == this->Owner.ActiveClient)
+		{
+			ClientWindow * const NewActiveClient = TagContainer->GetActiveTag()->GetActiveClient();
 
-			if (EventCast->State == false)
+			if (NewActiveClient != nullptr)
+				this->Owner.ActivateClient(*NewActiveClient);
+			else
 			{
-				TagContainer->AddClientWindow(EventCast->ClientWindow, this->Owner.ClientData[EventCast->ClientWindow]->Floating);
-
-				// Activate the client only if the current active client isn't fullscreen
-				if ((this->Owner.ActiveClient != nullptr && this->Owner.ActiveClient->GetFullscreen() == false) ||
-					 this->Owner.ActiveClient == nullptr)
-				{
-					this->Owner.ActivateClient(EventCast->ClientWindow);
-				}
+				this->Owner.ActiveClient = nullptr;
+				EventCast->ClientWindow.GetRootWindow()->SetActiveClientWindow(nullptr);
+
+				if (this->Owner.WindowDecorator != nullptr)
+					this->Owner.WindowDecorator->DecorateWindow(*this->Owner.ActiveRoot);
 			}
 		}
-		break;
+	}
 
+	EventCast->ClientWindow.SetIconified(EventCast->State);
 
-	case Glass::Event::Type::CLIENT_URGENCY_CHANGE:
-		{
-			ClientUrgencyChange_Event const * const EventCast = static_cast<ClientUrgencyChange_Event const *>(Event);
+	if (EventCast->State == false)
+	{
+		TagContainer->AddClientWindow(EventCast->ClientWindow, this->Owner.ClientData[EventCast->ClientWindow]->Floating);
 
-			EventCast->ClientWindow.SetUrgent(EventCast->State);
+		// Activate the client only if the current active client isn't fullscreen
+		if ((this->Owner.ActiveClient != nullptr && this->Owner.ActiveClient->GetFullscreen() == false) ||
+			 this->Owner.ActiveClient == nullptr)
+		{
+			this->Owner.ActivateClient(EventCast->ClientWindow);
+		}
+	}
+}
 
-			if (EventCast->State == true && &EventCast->ClientWindow == this->Owner.ActiveClient)
-				EventCast->ClientWindow.SetUrgent(false);
 
-			if (this->Owner.WindowDecorator != nullptr)
-				this->Owner.WindowDecorator->DecorateWindow(EventCast->ClientWindow, this->Owner.GetDecorationHint(EventCast->ClientWindow));
-		}
-		break;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientUrgencyChange(Glass::Event const *Event)
+{
+	ClientUrgencyChange_Event const * const EventCast = static_cast<ClientUrgencyChange_Event const *>(Event);
 
+	EventCast->ClientWindow.SetUrgent(EventCast->State);
 
-	case Glass::Event::Type::CLIENT_FULLSCREEN_REQUEST:
-		{
-			ClientFullscreenRequest_Event const * const EventCast = static_cast<ClientFullscreenRequest_Event const *>(Event);
+	if (EventCast->State == true && &EventCast->ClientWindow == this->Owner.ActiveClient)
+		EventCast->ClientWindow.SetUrgent(false);
 
-			bool const Value = (EventCast->EventMode == ClientFullscreenRequest_Event::Mode::SET ?  true :
-							   (EventCast->EventMode == ClientFullscreenRequest_Event::Mode::UNSET ? false :
-																									 !EventCast->ClientWindow.GetFullscreen()));
+	if (this->Owner.WindowDecorator != nullptr)
+		this->Owner.WindowDecorator->DecorateWindow(EventCast->ClientWindow, this->Owner.GetDecorationHint(EventCast->ClientWindow));
+}
 
-			this->Owner.SetClientFullscreen(EventCast->ClientWindow, Value);
-		}
-		break;
 
+void Dynamic_WindowManager::Implementation::EventHandler::HandleClientFullscreenRequest(Glass::Event const *Event)
+{
+	ClientFullscreenRequest_Event const * const EventCast = static_cast<ClientFullscreenRequest_Event const *>(Event);
 
-	case Glass::Event::Type::PRIMARY_NAME_CHANGE:
-		{
-			PrimaryNameChange_Event const * const EventCast = static_cast<PrimaryNameChange_Event const *>(Event);
+	bool const Value = (EventCast->EventMode == ClientFullscreenRequest_Event::Mode::SET ?  true :
+					   (EventCast->EventMode == ClientFullscreenRequest_Event::Mode::UNSET ? false :
+																							 !EventCast->ClientWindow.GetFullscreen()));
 
-			if (EventCast->PrimaryWindow.GetName() == EventCast->NewName)
-				break;
+	this->Owner.SetClientFullscreen(EventCast->ClientWindow, Value);
+}
 
-			EventCast->PrimaryWindow.SetName(EventCast->NewName);
 
-			if (RootWindow * const WindowCast = dynamic_cast<RootWindow *>(&EventCast->PrimaryWindow))
-			{
-				if (this->Owner.WindowDecorator != nullptr)
-					this->Owner.WindowDecorator->DecorateWindow(*WindowCast);
-			}
-			else if (ClientWindow * const WindowCast = static_cast<ClientWindow *>(&EventCast->PrimaryWindow))
-			{
-				if (this->Owner.WindowDecorator != nullptr)
-				{
-					this->Owner.WindowDecorator->DecorateWindow(*WindowCast, this->Owner.GetDecorationHint(*WindowCast));
-					this->Owner.WindowDecorator->DecorateWindow(*WindowCast->GetRootWindow());
-				}
-			}
-		}
-		break;
+void Dynamic_WindowManager::Implementation::EventHandler::HandlePrimaryNameChange(Glass::Event const *Event)
+{
+	PrimaryNameChange_Event const * const EventCast = static_cast<PrimaryNameChange_Event const *>(Event);
 
+	if (EventCast->PrimaryWindow.GetName() == *EventCast->NewName)
+		return;
 
-	case Glass::Event::Type::POINTER_MOVE:
-		{
-			PointerMove_Event const * const EventCast = static_cast<PointerMove_Event const *>(Event);
+	EventCast->PrimaryWindow.SetName(*EventCast->NewName);
 
-			if (ModalMove)
-			{
-				Vector const PositionOffset = EventCast->Position - ModalOldPosition;
+	if (this->Owner.WindowDecorator == nullptr)
+		return;
 
-				if (!PositionOffset.IsZero())
-				{
-					if (!this->Owner.ClientData[*ModalMove]->Floating)
-						this->Owner.RootTags[*ModalMove->GetRootWindow()]->GetWindowLayout().MoveClientWindow(*ModalMove, ModalOldPosition, PositionOffset);
+	if (EventCast->PrimaryWindow.GetKind() == Window::Kind::ROOT)
+		this->Owner.WindowDecorator->DecorateWindow(static_cast<RootWindow &>(EventCast->PrimaryWindow));
+	else
+	{
+		ClientWindow &WindowCast = static_cast<ClientWindow &>(EventCast->PrimaryWindow);
 
-					ModalMove->SetPosition(EventCast->Position - ModalMove->GetSize() / 2);
+		this->Owner.WindowDecorator->DecorateWindow(WindowCast, this->Owner.GetDecorationHint(WindowCast));
+		this->Owner.WindowDecorator->DecorateWindow(*WindowCast.GetRootWindow());
+	}
+}
 
-					ModalOldPosition = EventCast->Position;
-				}
-			}
-			else if (ModalResize)
-			{
-				Vector const Offset = (EventCast->Position - ModalOldPosition) * ModalResizeMask;
 
-				bool const Floating = this->Owner.ClientData[*ModalResize]->Floating;
+void Dynamic_WindowManager::Implementation::EventHandler::HandlePointerMove(Glass::Event const *Event)
+{
+	PointerMove_Event const * const EventCast = static_cast<PointerMove_Event const *>(Event);
 
-				if (!Floating && (std::abs(Offset.x) >= 10 ||
-								  std::abs(Offset.y) >= 10))
-				{
-					Vector const RoundedOffset(RoundIntToNearest(Offset.x, 10),
-											   RoundIntToNearest(Offset.y, 10));
+	ClientWindow * const ModalMove = this->Owner.ModalMove;
+	ClientWindow * const ModalResize = this->Owner.ModalResize;
+	Vector const		 ModalResizeMask = this->Owner.ModalResizeMask;
 
-					this->Owner.RootTags[*ModalResize->GetRootWindow()]->GetWindowLayout().ResizeClientWindow(*ModalResize, ModalResizeMask, RoundedOffset);
+	if (ModalMove)
+	{
+		Vector const PositionOffset = EventCast->Position - this->Owner.ModalOldPosition;
 
-					ModalOldPosition += RoundedOffset * ModalResizeMask;
-				}
-				else if (Floating && !Offset.IsZero())
-				{
-					Vector const PositionOffset(ModalResizeMask.x < 0 ? -Offset.x : 0,
-												ModalResizeMask.y < 0 ? -Offset.y : 0);
+		if (!PositionOffset.IsZero())
+		{
+			if (!this->Owner.ClientData[*ModalMove]->Floating)
+				this->Owner.RootTags[*ModalMove->GetRootWindow()]->GetWindowLayout().MoveClientWindow(*ModalMove, this->Owner.ModalOldPosition, PositionOffset);
 
-					ModalResize->SetGeometry(ModalResize->GetPosition() + PositionOffset,
-											 ModalResize->GetSize() + Offset);
+			ModalMove->SetPosition(EventCast->Position - ModalMove->GetSize() / 2);
 
-					ModalOldPosition = EventCast->Position;
-				}
-			}
+			this->Owner.ModalOldPosition = EventCast->Position;
 		}
-		break;
+	}
+	else if (ModalResize)
+	{
+		Vector const Offset = (EventCast->Position - this->Owner.ModalOldPosition) * ModalResizeMask;
 
+		bool const Floating = this->Owner.ClientData[*ModalResize]->Floating;
 
-	case Glass::Event::Type::WINDOW_ENTER:
+		if (!Floating && (std::abs(Offset.x) >= 10 ||
+						  std::abs(Offset.y) >= 10))
 		{
-			WindowEnter_Event const * const EventCast = static_cast<WindowEnter_Event const *>(Event);
+			Vector const RoundedOffset(RoundIntToNearest(Offset.x, 10),
+									   RoundIntToNearest(Offset.y, 10));
 
-			if (ClientWindow * const WindowCast = dynamic_cast<ClientWindow *>(&EventCast->Window))
-			{
-				LOG_DEBUG_INFO << "  Client: " << WindowCast->GetPosition() << ", " << WindowCast->GetSize() << std::endl;
+			this->Owner.RootTags[*ModalResize->GetRootWindow()]->GetWindowLayout().ResizeClientWindow(*ModalResize, ModalResizeMask, RoundedOffset);
 
-				this->Owner.ActivateClient(*WindowCast);
-			}
-			else if (AuxiliaryWindow * const WindowCast = dynamic_cast<AuxiliaryWindow *>(&EventCast->Window))
-			{
-				LOG_DEBUG_INFO << "  Auxiliary: " << WindowCast->GetPosition() << ", " << WindowCast->GetSize() << std::endl;
+			this->Owner.ModalOldPosition += RoundedOffset * ModalResizeMask;
+		}
+		else if (Floating && !Offset.IsZero())
+		{
+			Vector const PositionOffset(ModalResizeMask.x < 0 ? -Offset.x : 0,
+										ModalResizeMask.y < 0 ? -Offset.y : 0);
 
-				if (ClientWindow * const PrimaryWindowCast = dynamic_cast<ClientWindow *>(&WindowCast->GetPrimaryWindow()))
-					this->Owner.ActivateClient(*PrimaryWindowCast);
-			}
-			else if (RootWindow * const WindowCast = static_cast<RootWindow *>(&EventCast->Window))
-			{
-				LOG_DEBUG_INFO << "  Root" << std::endl;
+			ModalResize->SetGeometry(ModalResize->GetPosition() + PositionOffset,
+									 ModalResize->GetSize() + Offset);
 
-				// Focus the root if there are no other clients
-				if (this->Owner.RootTags[*WindowCast]->GetActiveTag()->size() == 0)
-					WindowCast->Focus();
-			}
+			this->Owner.ModalOldPosition = EventCast->Position;
 		}
-		break;
+	}
+}
+
 
+void Dynamic_WindowManager::Implementation::EventHandler::HandleWindowEnter(Glass::Event const *Event)
+{
+	WindowEnter_Event const * const EventCast = static_cast<WindowEnter_Event const *>(Event);
 
-	case Glass::Event::Type::INPUT:
+	switch (EventCast->Window.GetKind())
+	{
+	case Window::Kind::CLIENT:
 		{
-			Input_Event const * const EventCast = static_cast<Input_Event const *>(Event);
+			ClientWindow &WindowCast = static_cast<ClientWindow &>(EventCast->Window);
+
+			LOG_DEBUG_INFO << "  Client: " << WindowCast.GetPosition() << ", " << WindowCast.GetSize() << std::endl;
 
-			if (AuxiliaryWindow * const WindowCast = dynamic_cast<AuxiliaryWindow *>(&EventCast->Window))
-				WindowCast->HandleEvent(*Event);
+			this->Owner.ActivateClient(WindowCast);
 		}
 		break;
 
-
-	case Glass::Event::Type::WINDOW_MOVE_MODAL:
+	case Window::Kind::FRAME:
+	case Window::Kind::UTILITY:
 		{
-			if (ModalResize || this->Owner.ActiveClient == nullptr || this->Owner.ActiveClient->GetFullscreen() == true)
-				break;
+			AuxiliaryWindow &WindowCast = static_cast<AuxiliaryWindow &>(EventCast->Window);
 
-			WindowMoveModal_Event const * const EventCast = static_cast<WindowMoveModal_Event const *>(Event);
+			LOG_DEBUG_INFO << "  Auxiliary: " << WindowCast.GetPosition() << ", " << WindowCast.GetSize() << std::endl;
 
-			if (EventCast->EventMode == WindowModal_Event::Mode::BEGIN && !ModalMove)
-			{
-				ModalMove = this->Owner.ActiveClient;
+			if (WindowCast.GetPrimaryWindow().GetKind() == Window::Kind::CLIENT)
+				this->Owner.ActivateClient(static_cast<ClientWindow &>(WindowCast.GetPrimaryWindow()));
+		}
+		break;
 
-				ModalOldPosition = ModalMove->GetPosition() + ModalMove->GetSize() / 2;
-				this->Owner.WindowManager.DisplayServer.SetMousePosition(ModalOldPosition);
+	case Window::Kind::ROOT:
+		{
+			RootWindow &WindowCast = static_cast<RootWindow &>(EventCast->Window);
 
-				if (!this->Owner.ClientData[*ModalMove]->Floating)
-				{
-					ModalMove->Raise();
-					this->Owner.RefreshStackingOrder();
-				}
-			}
-			else if (EventCast->EventMode == WindowModal_Event::Mode::END && ModalMove)
-			{
-				if (!this->Owner.ClientData[*ModalMove]->Floating)
-					this->Owner.RootTags[*ModalMove->GetRootWindow()]->GetWindowLayout().Refresh();
+			LOG_DEBUG_INFO << "  Root" << std::endl;
 
-				ModalMove = nullptr;
-			}
+			// Focus the root if there are no other clients
+			if (this->Owner.RootTags[WindowCast]->GetActiveTag()->size() == 0)
+				WindowCast.Focus();
 		}
 		break;
+	}
+}
 
 
-	case Glass::Event::Type::WINDOW_RESIZE_MODAL:
-		{
-			if (ModalMove || this->Owner.ActiveClient == nullptr || this->Owner.ActiveClient->GetFullscreen() == true)
-				break;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleInput(Glass::Event const *Event)
+{
+	Input_Event const * const EventCast = static_cast<Input_Event const *>(Event);
 
-			WindowResizeModal_Event const * const EventCast = static_cast<WindowResizeModal_Event const *>(Event);
+	if (EventCast->Window.GetKind() == Window::Kind::FRAME || EventCast->Window.GetKind() == Window::Kind::UTILITY)
+		static_cast<AuxiliaryWindow &>(EventCast->Window).HandleEvent(*Event);
+}
 
-			if (EventCast->EventMode == WindowModal_Event::Mode::BEGIN && !ModalResize)
-			{
-				ModalResize = this->Owner.ActiveClient;
 
-				Vector const StartPosition = this->Owner.WindowManager.DisplayServer.GetMousePosition();
-				ModalOldPosition = StartPosition;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleWindowMoveModal(Glass::Event const *Event)
+{
+	if (this->Owner.ModalResize || this->Owner.ActiveClient == nullptr || this->Owner.ActiveClient->GetFullscreen() == true)
+		return;
 
-				if (!this->Owner.ClientData[*ModalResize]->Floating)
-				{
-					ModalResize->Raise();
-					this->Owner.RefreshStackingOrder();
-				}
+	WindowMoveModal_Event const * const EventCast = static_cast<WindowMoveModal_Event const *>(Event);
 
-				Vector const WindowStartPosition = ModalResize->GetPosition();
-				Vector const WindowStartSize = ModalResize->GetSize();
+	if (EventCast->EventMode == WindowModal_Event::Mode::BEGIN && !this->Owner.ModalMove)
+	{
+		this->Owner.ModalMove = this->Owner.ActiveClient;
 
-				// The active border width is 30% of the smallest window dimension or 150 pixels; whichever is smaller.
-				short ActiveBorderWidth = (WindowStartSize.x < WindowStartSize.y ? WindowStartSize.x : WindowStartSize.y) * 0.3f;
+		this->Owner.ModalOldPosition = this->Owner.ModalMove->GetPosition() + this->Owner.ModalMove->GetSize() / 2;
+		this->Owner.WindowManager.DisplayServer.SetMousePosition(this->Owner.ModalOldPosition);
 
-				if (ActiveBorderWidth > 150)
-					ActiveBorderWidth = 150;
+		if (!this->Owner.ClientData[*this->Owner.ModalMove]->Floating)
+		{
+			this->Owner.ModalMove->Raise();
+			this->Owner.RefreshStackingOrder();
+		}
+	}
+	else if (EventCast->EventMode == WindowModal_Event::Mode::END && this->Owner.ModalMove)
+	{
+		if (!this->Owner.ClientData[*this->Owner.ModalMove]->Floating)
+			this->Owner.RootTags[*this->Owner.ModalMove->GetRootWindow()]->GetWindowLayout().Refresh();
 
-				Vector const ActiveBorder(ActiveBorderWidth, ActiveBorderWidth);
+		this->Owner.ModalMove = nullptr;
+	}
+}
 
-				Vector const InnerAreaULCorner = WindowStartPosition + ActiveBorder;
-				Vector const InnerAreaLRCorner = WindowStartPosition + WindowStartSize - ActiveBorder;
 
-				/*
-				  Based on where in the window the user clicked to start the resize, ResizeMask will be the following:
-					  -1, -1 | 0, -1 | 1, -1
-					  ----------------------
-					  -1, 0  | 0, 0  | 1, 0
-					  ----------------------
-					  -1, 1  | 0, 1  | 1, 1
-				*/
+void Dynamic_WindowManager::Implementation::EventHandler::HandleWindowResizeModal(Glass::Event const *Event)
+{
+	if (this->Owner.ModalMove || this->Owner.ActiveClient == nullptr || this->Owner.ActiveClient->GetFullscreen() == true)
+		return;
 
-				ModalResizeMask = Vector((StartPosition.x < InnerAreaULCorner.x || StartPosition.x > InnerAreaLRCorner.x) ?
-										 (StartPosition.x < InnerAreaULCorner.x ? -1 : 1) : 0,
-										 (StartPosition.y < InnerAreaULCorner.y || StartPosition.y > InnerAreaLRCorner.y) ?
-										 (StartPosition.y < InnerAreaULCorner.y ? -1 : 1) : 0);
+	WindowResizeModal_Event const * const EventCast = static_cast<WindowResizeModal_Event const *>(Event);
 
-				if (ModalResizeMask.IsZero())
-					ModalResize = nullptr;
-			}
-			else if (EventCast->EventMode == WindowModal_Event::Mode::END && ModalResize)
-				ModalResize = nullptr;
-		}
-		break;
+	if (EventCast->EventMode == WindowModal_Event::Mode::BEGIN && !this->Owner.ModalResize)
+	{
+		this->Owner.ModalResize = this->Owner.ActiveClient;
 
+		Vector const StartPosition = this->Owner.WindowManager.DisplayServer.GetMousePosition();
+		this->Owner.ModalOldPosition = StartPosition;
 
-	case Glass::Event::Type::WINDOW_CLOSE:
+		if (!this->Owner.ClientData[*this->Owner.ModalResize]->Floating)
 		{
-			if (this->Owner.ActiveClient != nullptr)
-				this->Owner.ActiveClient->Close();
+			this->Owner.ModalResize->Raise();
+			this->Owner.RefreshStackingOrder();
 		}
-		break;
 
+		Vector const WindowStartPosition = this->Owner.ModalResize->GetPosition();
+		Vector const WindowStartSize = this->Owner.ModalResize->GetSize();
 
-	case Glass::Event::Type::FLOATING_TOGGLE:
-		{
-			if (this->Owner.ActiveClient == nullptr)
-				break;
+		// The active border width is 30% of the smallest window dimension or 150 pixels; whichever is smaller.
+		short ActiveBorderWidth = (WindowStartSize.x < WindowStartSize.y ? WindowStartSize.x : WindowStartSize.y) * 0.3f;
 
-			this->Owner.SetClientFloating(*this->Owner.ActiveClient, !this->Owner.ClientData[*this->Owner.ActiveClient]->Floating);
-		}
-		break;
+		if (ActiveBorderWidth > 150)
+			ActiveBorderWidth = 150;
 
+		Vector const ActiveBorder(ActiveBorderWidth, ActiveBorderWidth);
 
-	case Glass::Event::Type::FLOATING_RAISE:
-		{
-			if (this->Owner.ActiveClient == nullptr)
-				break;
+		Vector const InnerAreaULCorner = WindowStartPosition + ActiveBorder;
+		Vector const InnerAreaLRCorner = WindowStartPosition + WindowStartSize - ActiveBorder;
 
-			if (this->Owner.ClientData[*this->Owner.ActiveClient]->Floating)
-				this->Owner.SetClientRaised(*this->Owner.ActiveClient, true);
-		}
-		break;
+		/*
+		  Based on where in the window the user clicked to start the resize, ResizeMask will be the following:
+			  -1, -1 | 0, -1 | 1, -1
+			  ----------------------
+			  -1, 0  | 0, 0  | 1, 0
+			  ----------------------
+			  -1, 1  | 0, 1  | 1, 1
+		*/
 
+		this->Owner.ModalResizeMask = Vector((StartPosition.x < InnerAreaULCorner.x || StartPosition.x > InnerAreaLRCorner.x) ?
+								 (StartPosition.x < InnerAreaULCorner.x ? -1 : 1) : 0,
+								 (StartPosition.y < InnerAreaULCorner.y || StartPosition.y > InnerAreaLRCorner.y) ?
+								 (StartPosition.y < InnerAreaULCorner.y ? -1 : 1) : 0);
 
-	case Glass::Event::Type::SWITCH_TABBED:
-		{
-			ClientWindow * const OldActiveClient = this->Owner.ActiveClient;
+		if (this->Owner.ModalResizeMask.IsZero())
+			this->Owner.ModalResize = nullptr;
+	}
+	else if (EventCast->EventMode == WindowModal_Event::Mode::END && this->Owner.ModalResize)
+		this->Owner.ModalResize = nullptr;
+}
 
-			if (TabbedTarget != nullptr &&
-				TabbedTarget != this->Owner.ActiveClient &&
-				this->Owner.ClientData.find(*TabbedTarget) != this->Owner.ClientData.end())
-			{
-				// Activate the first tag containing the client if none are activated already
-				auto const TagContainer = this->Owner.RootTags[*TabbedTarget->GetRootWindow()];
-				auto const ClientTagMask = TagContainer->GetClientWindowTagMask(*TabbedTarget);
 
-				if (!(TagContainer->GetActiveTagMask() & ClientTagMask))
-				{
-					TagManager::TagContainer::TagMask ActivateMask;
-					for (ActivateMask = 0x01; !(ActivateMask & ClientTagMask); ActivateMask <<= 1)
-					{ }
+void Dynamic_WindowManager::Implementation::EventHandler::HandleWindowClose(Glass::Event const *Event)
+{
+	if (this->Owner.ActiveClient != nullptr)
+		this->Owner.ActiveClient->Close();
+}
 
-					TagContainer->SetActiveTagMask(ActivateMask);
-				}
 
-				this->Owner.ActivateClient(*TabbedTarget);
-			}
-			else
-			{
-				auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
+void Dynamic_WindowManager::Implementation::EventHandler::HandleFloatingToggle(Glass::Event const *Event)
+{
+	if (this->Owner.ActiveClient == nullptr)
+		return;
 
-				if (TagContainer->GetActiveTag()->size() > 0)
-				{
-					auto NewActiveClient = TagContainer->GetActiveTag()->begin();
+	this->Owner.SetClientFloating(*this->Owner.ActiveClient, !this->Owner.ClientData[*this->Owner.ActiveClient]->Floating);
+}
 
-					if (*NewActiveClient == this->Owner.ActiveClient)
-						++NewActiveClient;
 
-					if (NewActiveClient != TagContainer->GetActiveTag()->end())
-						this->Owner.ActivateClient(**NewActiveClient);
-				}
-			}
+void Dynamic_WindowManager::Implementation::EventHandler::HandleFloatingRaise(Glass::Event const *Event)
+{
+	if (this->Owner.ActiveClient == nullptr)
+		return;
+
+	if (this->Owner.ClientData[*this->Owner.ActiveClient]->Floating)
+		this->Owner.SetClientRaised(*this->Owner.ActiveClient, true);
+}
+
+
+void Dynamic_WindowManager::Implementation::EventHandler::HandleSwitchTabbed(Glass::Event const *Event)
+{
+	ClientWindow * const OldActiveClient = this->Owner.ActiveClient;
+
+	if (this->Owner.TabbedTarget != nullptr &&
+		this->Owner.TabbedTarget != this->Owner.ActiveClient &&
+		this->Owner.ClientData.find(*this->Owner.TabbedTarget) != this->Owner.ClientData.end())
+	{
+		// Activate the first tag containing the client if none are activated already
+		auto const TagContainer = this->Owner.RootTags[*this->Owner.TabbedTarget->GetRootWindow()];
+		auto const ClientTagMask = TagContainer->GetClientWindowTagMask(*this->Owner.TabbedTarget);
 
-			if (OldActiveClient != nullptr)
-				TabbedTarget = OldActiveClient;
+		if (!(TagContainer->GetActiveTagMask() & ClientTagMask))
+		{
+			TagManager::TagContainer::TagMask ActivateMask;
+			for (ActivateMask = 0x01; !(ActivateMask & ClientTagMask); ActivateMask <<= 1)
+			{ }
+
+			TagContainer->SetActiveTagMask(ActivateMask);
 		}
-		break;
 
+		this->Owner.ActivateClient(*this->Owner.TabbedTarget);
+	}
+	else
+	{
+		auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
 
-	case Glass::Event::Type::FOCUS_CYCLE:
+		if (TagContainer->GetActiveTag()->size() > 0)
 		{
-			FocusCycle_Event const * const EventCast = static_cast<FocusCycle_Event const *>(Event);
+			auto NewActiveClient = TagContainer->GetActiveTag()->begin();
 
-			auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
-			auto	   Tag = TagContainer->GetActiveTag();
+			if (*NewActiveClient == this->Owner.ActiveClient)
+				++NewActiveClient;
 
-			if (Tag->size() <= 1)
-				break;
+			if (NewActiveClient != TagContainer->GetActiveTag()->end())
+				this->Owner.ActivateClient(**NewActiveClient);
+		}
+	}
 
-			ClientWindowList const TagOrder(Tag->rbegin(), Tag->rend());
+	if (OldActiveClient != nullptr)
+		this->Owner.TabbedTarget = OldActiveClient;
+}
 
-			auto CurrentPosition = (this->Owner.ActiveClient != nullptr ? Tag->find(*this->Owner.ActiveClient) :
-																		  Tag->begin());
 
-			if (EventCast->CycleDirection == FocusCycle_Event::Direction::LEFT)
-			{
-				if (CurrentPosition == Tag->begin())
-				{
-					CurrentPosition = Tag->end();
-					std::advance(CurrentPosition, -1);
-				}
-				else
-					--CurrentPosition;
-			}
-			else
-			{
-				if (CurrentPosition == Tag->end())
-					CurrentPosition = Tag->begin();
-				else
-				{
-					++CurrentPosition;
-
-					if (CurrentPosition == Tag->end())
-						CurrentPosition = Tag->begin();
-				}
-			}
+void Dynamic_WindowManager::Implementation::EventHandler::HandleFocusCycle(Glass::Event const *Event)
+{
+	FocusCycle_Event const * const EventCast = static_cast<FocusCycle_Event const *>(Event);
 
-			this->Owner.ActivateClient(**CurrentPosition);
+	auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
+	auto	   Tag = TagContainer->GetActiveTag();
 
-			// Restore tag order
-			for (auto Client : TagOrder)
-				Tag->SetActiveClient(*Client);
-		}
-		break;
+	if (Tag->size() <= 1)
+		return;
 
+	ClientWindowList const TagOrder(Tag->rbegin(), Tag->rend());
 
-	case Glass::Event::Type::LEVEL_TOGGLE:
-		{
-			if (this->Owner.ActiveClient == nullptr)
-				break;
+	auto CurrentPosition = (this->Owner.ActiveClient != nullptr ? Tag->find(*this->Owner.ActiveClient) :
+																  Tag->begin());
 
-			LevelToggle_Event const * const EventCast = static_cast<LevelToggle_Event const *>(Event);
+	if (EventCast->CycleDirection == FocusCycle_Event::Direction::LEFT)
+	{
+		if (CurrentPosition == Tag->begin())
+		{
+			CurrentPosition = Tag->end();
+			std::advance(CurrentPosition, -1);
+		}
+		else
+			--CurrentPosition;
+	}
+	else
+	{
+		if (CurrentPosition == Tag->end())
+			CurrentPosition = Tag->begin();
+		else
+		{
+			++CurrentPosition;
 
-			if (EventCast->EventMode == LevelToggle_Event::Mode::RAISE)
-			{
-				this->Owner.SetClientRaised(*this->Owner.ActiveClient, !this->Owner.IsClientRaised(*this->Owner.ActiveClient));
-			}
-			else
-			{
-				this->Owner.SetClientLowered(*this->Owner.ActiveClient, !this->Owner.IsClientLowered(*this->Owner.ActiveClient));
-			}
+			if (CurrentPosition == Tag->end())
+				CurrentPosition = Tag->begin();
 		}
-		break;
+	}
 
+	this->Owner.ActivateClient(**CurrentPosition);
 
-	case Glass::Event::Type::LAYOUT_CYCLE:
-		{
-			LayoutCycle_Event const * const EventCast = static_cast<LayoutCycle_Event const *>(Event);
+	// Restore tag order
+	for (auto Client : TagOrder)
+		Tag->SetActiveClient(*Client);
+}
 
-			auto TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
 
-			TagContainer->CycleTagLayouts((TagManager::TagContainer::LayoutCycle)EventCast->CycleDirection);
-		}
-		break;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleLevelToggle(Glass::Event const *Event)
+{
+	if (this->Owner.ActiveClient == nullptr)
+		return;
 
+	LevelToggle_Event const * const EventCast = static_cast<LevelToggle_Event const *>(Event);
 
-	case Glass::Event::Type::SPAWN_COMMAND:
-		{
-			SpawnCommand_Event const * const EventCast = static_cast<SpawnCommand_Event const *>(Event);
+	if (EventCast->EventMode == LevelToggle_Event::Mode::RAISE)
+	{
+		this->Owner.SetClientRaised(*this->Owner.ActiveClient, !this->Owner.IsClientRaised(*this->Owner.ActiveClient));
+	}
+	else
+	{
+		this->Owner.SetClientLowered(*this->Owner.ActiveClient, !this->Owner.IsClientLowered(*this->Owner.ActiveClient));
+	}
+}
 
-			if (fork() == 0)
-			{
-				setsid();
 
-				char *Command[EventCast->Command.size() + 1];
-				int Index = 0;
-				for (auto const &Argument : EventCast->Command)
-					Command[Index++] = const_cast<char *>(Argument.c_str());
-				Command[Index] = nullptr;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleLayoutCycle(Glass::Event const *Event)
+{
+	LayoutCycle_Event const * const EventCast = static_cast<LayoutCycle_Event const *>(Event);
 
-				// Replace the process image with that of the command we want to spawn
-				execvp(Command[0], Command);
+	auto TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
 
-				// If we get here, something went wrong
-				LOG_ERROR << "Unable to spawn command '" << EventCast->Command[0];
+	TagContainer->CycleTagLayouts((TagManager::TagContainer::LayoutCycle)EventCast->CycleDirection);
+}
 
-				for (unsigned int Index = 1; Index < EventCast->Command.size(); Index++)
-					LOG_ERROR_NOHEADER << " " << EventCast->Command[Index];
 
-				LOG_ERROR_NOHEADER << "'!" << std::endl;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleSpawnCommand(Glass::Event const *Event)
+{
+	SpawnCommand_Event const * const EventCast = static_cast<SpawnCommand_Event const *>(Event);
 
-				exit(EXIT_SUCCESS);
-			}
-		}
-		break;
+	if (fork() == 0)
+	{
+		setsid();
 
+		char *Command[EventCast->Command->size() + 1];
+		int Index = 0;
+		for (auto const &Argument : *EventCast->Command)
+			Command[Index++] = const_cast<char *>(Argument.c_str());
+		Command[Index] = nullptr;
 
-	case Glass::Event::Type::FULLSCREEN_TOGGLE:
-		{
-			if (this->Owner.ActiveClient == nullptr)
-				break;
+		// Replace the process image with that of the command we want to spawn
+		execvp(Command[0], Command);
 
-			this->Owner.SetClientFullscreen(*this->Owner.ActiveClient, !this->Owner.ActiveClient->GetFullscreen());
-		}
-		break;
+		// If we get here, something went wrong
+		LOG_ERROR << "Unable to spawn command '" << (*EventCast->Command)[0];
 
+		for (unsigned int Index = 1; Index < EventCast->Command->size(); Index++)
+			LOG_ERROR_NOHEADER << " " << (*EventCast->Command)[Index];
 
-	case Glass::Event::Type::TAG_DISPLAY:
-		{
-			TagDisplay_Event const * const EventCast = static_cast<TagDisplay_Event const *>(Event);
+		LOG_ERROR_NOHEADER << "'!" << std::endl;
 
-			auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
+		exit(EXIT_SUCCESS);
+	}
+}
 
-			if (EventCast->EventTarget == TagDisplay_Event::Target::ROOT)
-			{
-				TagManager::TagContainer::TagMask NewMask = 0x00;
 
-				if (EventCast->EventMode == TagDisplay_Event::Mode::SET)
-					NewMask = EventCast->EventTagMask;
-				else
-					NewMask = TagContainer->GetActiveTagMask() ^ EventCast->EventTagMask;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleFullscreenToggle(Glass::Event const *Event)
+{
+	if (this->Owner.ActiveClient == nullptr)
+		return;
 
-				LOG_DEBUG_INFO << "New Root Mask: " << NewMask << std::endl;
+	this->Owner.SetClientFullscreen(*this->Owner.ActiveClient, !this->Owner.ActiveClient->GetFullscreen());
+}
 
-				TagContainer->SetActiveTagMask(NewMask);
-			}
-			else if (EventCast->EventTarget == TagDisplay_Event::Target::CLIENT && this->Owner.ActiveClient != nullptr)
-			{
-				TagManager::TagContainer::TagMask NewMask = 0x00;
 
-				if (EventCast->EventMode == TagDisplay_Event::Mode::SET)
-					NewMask = EventCast->EventTagMask;
-				else
-					NewMask = TagContainer->GetClientWindowTagMask(*this->Owner.ActiveClient) ^ EventCast->EventTagMask;
+void Dynamic_WindowManager::Implementation::EventHandler::HandleTagDisplay(Glass::Event const *Event)
+{
+	TagDisplay_Event const * const EventCast = static_cast<TagDisplay_Event const *>(Event);
 
-				LOG_DEBUG_INFO << "New Client Mask: " << NewMask << std::endl;
+	auto const TagContainer = this->Owner.RootTags[*this->Owner.ActiveRoot];
 
-				TagContainer->SetClientWindowTagMask(*this->Owner.ActiveClient, NewMask);
-			}
+	if (EventCast->EventTarget == TagDisplay_Event::Target::ROOT)
+	{
+		TagManager::TagContainer::TagMask NewMask = 0x00;
 
-			// If there is no active client, or it's no longer visible, pick a new one
-			TagManager::TagContainer::TagMask const ClientTagMask = (this->Owner.ActiveClient == nullptr ? 0x00 :
-																										   TagContainer->GetClientWindowTagMask(*this->Owner.ActiveClient));
-			if (!(ClientTagMask & TagContainer->GetActiveTagMask()))
-			{
-				ClientWindow * const NewActiveClient = TagContainer->GetActiveTag()->GetActiveClient();
-
-				if (NewActiveClient != nullptr)
-					this->Owner.ActivateClient(*NewActiveClient);
-				else
-				{
-					this->Owner.ActiveClient = nullptr;
-					this->Owner.ActiveRoot->SetActiveClientWindow(nullptr);
-				}
-			}
+		if (EventCast->EventMode == TagDisplay_Event::Mode::SET)
+			NewMask = EventCast->EventTagMask;
+		else
+			NewMask = TagContainer->GetActiveTagMask() ^ EventCast->EventTagMask;
 
-			if (this->Owner.WindowDecorator != nullptr)
-				this->Owner.WindowDecorator->DecorateWindow(*this->Owner.ActiveRoot);
-		}
-		break;
+		LOG_DEBUG_INFO << "New Root Mask: " << NewMask << std::endl;
+
+		TagContainer->SetActiveTagMask(NewMask);
+	}
+	else if (EventCast->EventTarget == TagDisplay_Event::Target::CLIENT && this->Owner.ActiveClient != nullptr)
+	{
+		TagManager::TagContainer::TagMask NewMask = 0x00;
 
+		if (EventCast->EventMode == TagDisplay_Event::Mode::SET)
+			NewMask = EventCast->EventTagMask;
+		else
+			NewMask = TagContainer->GetClientWindowTagMask(*this->Owner.ActiveClient) ^ EventCast->EventTagMask;
 
-	case Glass::Event::Type::MANAGER_QUIT:
-		this->Owner.Quit = true;
-		break;
+		LOG_DEBUG_INFO << "New Client Mask: " << NewMask << std::endl;
+
+		TagContainer->SetClientWindowTagMask(*this->Owner.ActiveClient, NewMask);
 	}
 
-	this->Owner.WindowManager.DisplayServer.Sync();
+	// If there is no active client, or it's no longer visible, pick a new one
+	TagManager::TagContainer::TagMask const ClientTagMask = (this->Owner.ActiveClient == nullptr ? 0x00 :
+																								   TagContainer->GetClientWindowTagMask(*this->Owner.ActiveClient));
+	if (!(ClientTagMask & TagContainer->GetActiveTagMask()))
+	{
+		ClientWindow * const NewActiveClient = TagContainer->GetActiveTag()->GetActiveClient();
+
+		if (NewActiveClient != nullptr)
+			this->Owner.ActivateClient(*NewActiveClient);
+		else
+		{
+			this->Owner.ActiveClient = nullptr;
+			this->Owner.ActiveRoot->SetActiveClientWindow(nullptr);
+		}
+	}
+
+	if (this->Owner.WindowDecorator != nullptr)
+		this->Owner.WindowDecorator->DecorateWindow(*this->Owner.ActiveRoot);
+}
+
+
+void Dynamic_WindowManager::Implementation::EventHandler::HandleManagerQuit(Glass::Event const *Event)
+{
+	this->Owner.Quit = true;
 }
@@ -25,8 +25,6 @@
 
 namespace Glass
 {
-	class Event;
-
 	class Dynamic_WindowManager::Implementation::EventHandler
 	{
 	public:
@@ -34,10 +32,85 @@ namespace Glass
 
 		void Listen();
 
+		// Counts of events handled between display server syncs
+		struct BatchStatistics
+		{
+			unsigned long Batches;
+			unsigned long Events;
+			unsigned long LargestBatch;
+			unsigned long BatchSizes[8]; // Batches of 1, 2-3, 4-7, ..., and 128 or more events
+		};
+
+		BatchStatistics const &GetBatchStatistics() const;
+
+		LatencyHistogram const &GetLatency(Event::Type Type, Dynamic_WindowManager::LatencyStage Stage) const;
+		LatencyHistogram const &GetSyncDuration() const;
+
 	private:
 		void Handle(Glass::Event const *Event);
+		void EndBatch(EventRecord const *Events, size_t EventCount, uint64_t DequeueTime);
+
+		void HandleRootCreate(Glass::Event const *Event);
+		void HandleClientCreate(Glass::Event const *Event);
+		void HandleClientDestroy(Glass::Event const *Event);
+		void HandleClientGeometryChangeRequest(Glass::Event const *Event);
+		void HandleClientIconifiedRequest(Glass::Event const *Event);
+		void HandleClientUrgencyChange(Glass::Event const *Event);
+		void HandleClientFullscreenRequest(Glass::Event const *Event);
+		void HandlePrimaryNameChange(Glass::Event const *Event);
+		void HandlePointerMove(Glass::Event const *Event);
+		void HandleWindowEnter(Glass::Event const *Event);
+		void HandleInput(Glass::Event const *Event);
+		void HandleWindowMoveModal(Glass::Event const *Event);
+		void HandleWindowResizeModal(Glass::Event const *Event);
+		void HandleWindowClose(Glass::Event const *Event);
+		void HandleFloatingToggle(Glass::Event const *Event);
+		void HandleFloatingRaise(Glass::Event const *Event);
+		void HandleSwitchTabbed(Glass::Event const *Event);
+		void HandleFocusCycle(Glass::Event const *Event);
+		void HandleLevelToggle(Glass::Event const *Event);
+		void HandleLayoutCycle(Glass::Event const *Event);
+		void HandleSpawnCommand(Glass::Event const *Event);
+		void HandleFullscreenToggle(Glass::Event const *Event);
+		void HandleTagDisplay(Glass::Event const *Event);
+		void HandleManagerQuit(Glass::Event const *Event);
+
+		// Indexed by Event::Type, in the order the types are declared
+		typedef void (EventHandler::*HandlerFunction)(Glass::Event const *Event);
+
+		static constexpr HandlerFunction Handlers[] = { &EventHandler::HandleRootCreate,
+														&EventHandler::HandleClientCreate,
+														&EventHandler::HandleClientDestroy,
+														&EventHandler::HandleClientGeometryChangeRequest,
+														&EventHandler::HandleClientIconifiedRequest,
+														&EventHandler::HandleClientUrgencyChange,
+														&EventHandler::HandleClientFullscreenRequest,
+														&EventHandler::HandlePrimaryNameChange,
+														&EventHandler::HandlePointerMove,
+														&EventHandler::HandleWindowEnter,
+														&EventHandler::HandleInput,
+														&EventHandler::HandleWindowMoveModal,
+														&EventHandler::HandleWindowResizeModal,
+														&EventHandler::HandleWindowClose,
+														&EventHandler::HandleFloatingToggle,
+														&EventHandler::HandleFloatingRaise,
+														&EventHandler::HandleSwitchTabbed,
+														&EventHandler::HandleFocusCycle,
+														&EventHandler::HandleLevelToggle,
+														&EventHandler::HandleLayoutCycle,
+														&EventHandler::HandleSpawnCommand,
+														&EventHandler::HandleFullscreenToggle,
+														&EventHandler::HandleTagDisplay,
+														&EventHandler::HandleManagerQuit };
+
+		static_assert(sizeof(Handlers) / sizeof(Handlers[0]) == Event::TypeCount, "Every event type needs a handler");
 
 		Dynamic_WindowManager::Implementation &Owner;
+
+		BatchStatistics Statistics;
+
+		LatencyHistogram Latencies[Event::TypeCount][Dynamic_WindowManager::LatencyStageCount];
+		LatencyHistogram SyncDurations;
 	};
 }
 
@@ -18,7 +18,10 @@
 */
 
 #include <algorithm>
+#include <signal.h>
+#include <sstream>
 
+#include "glass/core/Log.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/Implementation.hpp"
 
 using namespace Glass;
@@ -26,6 +29,10 @@ using namespace Glass;
 Dynamic_WindowManager::Implementation::Implementation(Dynamic_WindowManager &WindowManager) :
 	WindowManager(WindowManager),
 	Quit(false),
+	ModalMove(nullptr),
+	ModalResize(nullptr),
+	TabbedTarget(nullptr),
+	SignalThreadQuit(false),
 	ActiveRoot(nullptr),
 	ActiveClient(nullptr)
 {
@@ -39,6 +46,23 @@ Dynamic_WindowManager::Implementation::~Implementation()
 }
 
 
+void Dynamic_WindowManager::Implementation::WaitForSignals()
+{
+	sigset_t Signals;
+	sigemptyset(&Signals);
+	sigaddset(&Signals, SIGUSR1);
+
+	int Signal;
+	while (sigwait(&Signals, &Signal) == 0 && !this->SignalThreadQuit)
+	{
+		std::ostringstream Dump;
+		this->WindowManager.DumpLatencies(Dump);
+
+		LOG_INFO << Dump.str();
+	}
+}
+
+
 void Dynamic_WindowManager::Implementation::ActivateClient(ClientWindow &ClientWindow)
 {
 	// Is the window already the active client?
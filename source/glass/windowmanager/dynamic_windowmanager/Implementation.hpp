@@ -20,6 +20,9 @@
 #ifndef GLASS_DYNAMIC_WINDOWMANAGER_IMPLEMENTATION
 #define GLASS_DYNAMIC_WINDOWMANAGER_IMPLEMENTATION
 
+#include <atomic>
+#include <thread>
+
 #include "glass/core/WindowDecorator.hpp"
 #include "glass/windowmanager/Dynamic_WindowManager.hpp"
 #include "glass/windowmanager/dynamic_windowmanager/ClientData.hpp"
@@ -41,6 +44,22 @@ namespace Glass
 
 		bool Quit;
 
+		// Modal move and resize
+		ClientWindow *ModalMove;
+		ClientWindow *ModalResize;
+		Vector		  ModalOldPosition;
+		Vector		  ModalResizeMask;
+
+		// The client SWITCH_TABBED goes back to
+		ClientWindow *TabbedTarget;
+
+
+		// Latency dumps on SIGUSR1
+		std::thread		 SignalThread;
+		std::atomic_bool SignalThreadQuit;
+
+		void WaitForSignals();
+
 
 		// Window decoration
 		Glass::WindowDecorator *WindowDecorator;
@@ -17,15 +17,40 @@
 * Copyright 2014-2015 Chris Foster
 */
 
+#include <pthread.h>
+#include <signal.h>
+
 #include "config.hpp"
 #include "glass/core/EventQueue.hpp"
+#include "glass/core/FlightRecorder.hpp"
 
 int main()
 {
+	// Only the thread waiting for it should see SIGUSR1, which asks for a statistics dump.  New threads inherit this.
+	sigset_t BlockedSignals;
+	sigemptyset(&BlockedSignals);
+	sigaddset(&BlockedSignals, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &BlockedSignals, nullptr);
+
 	Glass::EventQueue EventQueue;
 
+	Glass::FlightRecorder *FlightRecorder = nullptr;
+	std::string const FlightRecorderPath = Glass::FlightRecorder::ResolvePath(Config::FlightRecorderPath);
+	if (!FlightRecorderPath.empty())
+	{
+		FlightRecorder = new Glass::FlightRecorder(FlightRecorderPath, Config::FlightRecorderCapacity);
+		EventQueue.SetRecorder(FlightRecorder);
+	}
+
+	// Only one connection can grab the bindings, so the listener stands down when the display server handles them
+	bool ListenForInput = Config::InputListener != nullptr;
+	#ifdef GLASS_DISPLAYSERVER_X11XCB_DISPLAYSERVER
+		if (Config::DisplayServerInputBindings)
+			ListenForInput = false;
+	#endif
+
 	Glass::DisplayServer *DisplayServer = Config::DisplayServer(EventQueue);
-	Glass::InputListener *InputListener = Config::InputListener(EventQueue);
+	Glass::InputListener *InputListener = ListenForInput ? Config::InputListener(EventQueue) : nullptr;
 	Glass::WindowManager *WindowManager = Config::WindowManager(*DisplayServer, EventQueue);
 
 	WindowManager->Run();
@@ -34,5 +59,8 @@ int main()
 	delete InputListener;
 	delete DisplayServer;
 
+	EventQueue.SetRecorder(nullptr);
+	delete FlightRecorder;
+
 	return 0;
 }
@@ -0,0 +1,364 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <pthread.h>
+#include <signal.h>
+#include <sstream>
+#include <string.h> // strcmp
+#include <thread>
+#include <vector>
+
+#include "glass/core/Event.hpp"
+#include "glass/core/EventQueue.hpp"
+#include "glass/core/FlightRecorder.hpp"
+#include "glass/core/Log.hpp"
+#include "glass/displayserver/Dummy_DisplayServer.hpp"
+#include "glass/windowmanager/Dynamic_WindowManager.hpp"
+
+using namespace Glass;
+
+// Plays a flight recorder file back through Dynamic_WindowManager, against a display server that isn't connected to anything.
+// Windows are recreated from the recording as they appear in it.  Spawn commands are skipped.
+
+struct ReplayWindows
+{
+	std::map<uint64_t, RootWindow *>	RootWindows;
+	std::map<uint64_t, ClientWindow *>	ClientWindows;
+};
+
+
+PrimaryWindow *FindPrimaryWindow(ReplayWindows const &Windows, uint64_t ID)
+{
+	auto RootWindow = Windows.RootWindows.find(ID);
+	if (RootWindow != Windows.RootWindows.end())
+		return RootWindow->second;
+
+	auto ClientWindow = Windows.ClientWindows.find(ID);
+	if (ClientWindow != Windows.ClientWindows.end())
+		return ClientWindow->second;
+
+	return nullptr;
+}
+
+
+// Auxiliary windows are made by the window decorator, so look for one of the same kind on the same primary window
+Window *FindWindow(ReplayWindows const &Windows, FlightRecorder::Record const &Record)
+{
+	if (Record.TargetKind != FlightRecorder::WindowKind::FRAME && Record.TargetKind != FlightRecorder::WindowKind::UTILITY)
+		return FindPrimaryWindow(Windows, Record.Window);
+
+	PrimaryWindow * const PrimaryWindow = FindPrimaryWindow(Windows, Record.RelatedWindow);
+	if (PrimaryWindow == nullptr)
+		return nullptr;
+
+	auto AuxiliaryWindowsAccessor = static_cast<Glass::PrimaryWindow const *>(PrimaryWindow)->GetAuxiliaryWindows();
+
+	for (auto AuxiliaryWindow : *AuxiliaryWindowsAccessor)
+	{
+		if (Record.TargetKind == FlightRecorder::WindowKind::FRAME && dynamic_cast<FrameWindow *>(AuxiliaryWindow) != nullptr)
+			return AuxiliaryWindow;
+		if (Record.TargetKind == FlightRecorder::WindowKind::UTILITY && dynamic_cast<UtilityWindow *>(AuxiliaryWindow) != nullptr)
+			return AuxiliaryWindow;
+	}
+
+	// The decorator hasn't gotten to it yet
+	return PrimaryWindow;
+}
+
+
+void Replay(std::vector<FlightRecorder::Record> const &Records, Dummy_DisplayServer &DisplayServer, EventQueue &EventQueue, bool RealTime,
+			size_t &ReplayedCount, size_t &SkippedCount)
+{
+	ReplayWindows Windows;
+
+	auto const ReplayStart = std::chrono::steady_clock::now();
+	uint64_t RecordingStart = 0;
+
+	for (auto const &Record : Records)
+	{
+		if (Record.Kind != FlightRecorder::RecordKind::ENQUEUED)
+			continue;
+
+		if (RealTime)
+		{
+			if (RecordingStart == 0)
+				RecordingStart = Record.Time;
+
+			std::this_thread::sleep_until(ReplayStart + std::chrono::nanoseconds(Record.Time - RecordingStart));
+		}
+
+		// The recording may have wrapped around before the roots were created
+		if (Windows.RootWindows.empty() && static_cast<Event::Type>(Record.EventType) != Event::Type::ROOT_CREATE)
+		{
+			LOG_WARNING << "The recording doesn't start with a root window; making one up" << std::endl;
+
+			RootWindow * const NewRootWindow = DisplayServer.CreateRootWindow(Vector(0, 0), Vector(1920, 1080));
+			Windows.RootWindows[0] = NewRootWindow;
+			EventQueue.AddEvent(RootCreate_Event(*NewRootWindow));
+		}
+
+		Vector const Position(Record.Position[0], Record.Position[1]);
+		Vector const Size(Record.Size[0], Record.Size[1]);
+
+		Window * const Target = Record.Window != 0 ? FindWindow(Windows, Record) : nullptr;
+		ClientWindow * const Client = Record.TargetKind == FlightRecorder::WindowKind::CLIENT ? dynamic_cast<ClientWindow *>(Target) : nullptr;
+
+		bool Skipped = false;
+
+		switch (static_cast<Event::Type>(Record.EventType))
+		{
+		case Event::Type::ROOT_CREATE:
+			{
+				RootWindow * const NewRootWindow = DisplayServer.CreateRootWindow(Position, Size);
+				Windows.RootWindows[Record.Window] = NewRootWindow;
+				EventQueue.AddEvent(RootCreate_Event(*NewRootWindow));
+			}
+			break;
+
+		case Event::Type::CLIENT_CREATE:
+			{
+				std::ostringstream Name;
+				Name << "Client " << Windows.ClientWindows.size();
+
+				auto TransientFor = Windows.ClientWindows.find(Record.RelatedWindow);
+
+				ClientWindow * const NewClientWindow = DisplayServer.CreateClientWindow(Name.str(), static_cast<ClientWindow::Type>(Record.Value), Position, Size,
+																						Record.Flags & FlightRecorder::CLIENT_FULLSCREEN,
+																						Record.Flags & FlightRecorder::CLIENT_URGENT,
+																						TransientFor != Windows.ClientWindows.end() ? TransientFor->second : nullptr,
+																						Record.Flags & FlightRecorder::CLIENT_VISIBLE);
+				Windows.ClientWindows[Record.Window] = NewClientWindow;
+				EventQueue.AddEvent(ClientCreate_Event(*NewClientWindow));
+			}
+			break;
+
+		case Event::Type::CLIENT_DESTROY:
+			if ((Skipped = Client == nullptr))
+				break;
+
+			// The window manager deletes the window once it handles this, so forget about it now
+			Windows.ClientWindows.erase(Record.Window);
+			EventQueue.AddEvent(ClientDestroy_Event(*Client));
+			break;
+
+		case Event::Type::CLIENT_GEOMETRY_CHANGE_REQUEST:
+			if (!(Skipped = Client == nullptr))
+				EventQueue.AddEvent(ClientGeometryChangeRequest_Event(*Client, Record.Value, Position, Size));
+			break;
+
+		case Event::Type::CLIENT_ICONIFIED_REQUEST:
+			if (!(Skipped = Client == nullptr))
+				EventQueue.AddEvent(ClientIconifiedRequest_Event(*Client, Record.Value));
+			break;
+
+		case Event::Type::CLIENT_URGENCY_CHANGE:
+			if (!(Skipped = Client == nullptr))
+				EventQueue.AddEvent(ClientUrgencyChange_Event(*Client, Record.Value));
+			break;
+
+		case Event::Type::CLIENT_FULLSCREEN_REQUEST:
+			if (!(Skipped = Client == nullptr))
+				EventQueue.AddEvent(ClientFullscreenRequest_Event(*Client, static_cast<ClientFullscreenRequest_Event::Mode>(Record.Value)));
+			break;
+
+		case Event::Type::PRIMARY_NAME_CHANGE:
+			if (PrimaryWindow * const TargetCast = dynamic_cast<PrimaryWindow *>(Target))
+			{
+				std::ostringstream Name;
+				Name << "Name " << std::hex << Record.Value;
+
+				EventQueue.AddEvent(PrimaryNameChange_Event(*TargetCast, Name.str()));
+			}
+			else
+				Skipped = true;
+			break;
+
+		case Event::Type::POINTER_MOVE:
+			DisplayServer.SetMousePosition(Position);
+			EventQueue.AddEvent(PointerMove_Event(Position));
+			break;
+
+		case Event::Type::WINDOW_ENTER:
+			if (!(Skipped = Target == nullptr))
+			{
+				DisplayServer.SetMousePosition(Position);
+				EventQueue.AddEvent(WindowEnter_Event(*Target, Position));
+			}
+			break;
+
+		case Event::Type::INPUT:
+			if (!(Skipped = Target == nullptr))
+			{
+				Input const RecordedInput(Record.Flags & FlightRecorder::INPUT_KEYBOARD ? Input::Type::KEYBOARD : Input::Type::MOUSE,
+										  static_cast<Input::Value>(Record.Value & 0xFFFF),
+										  (Record.Value >> 16) & 0xFF,
+										  Record.Flags & FlightRecorder::INPUT_RELEASED ? Input::State::RELEASED : Input::State::PRESSED);
+
+				DisplayServer.SetMousePosition(Position);
+				EventQueue.AddEvent(Input_Event(*Target, RecordedInput, Position));
+			}
+			break;
+
+		case Event::Type::WINDOW_MOVE_MODAL:
+			EventQueue.AddEvent(WindowMoveModal_Event(static_cast<WindowModal_Event::Mode>(Record.Value)));
+			break;
+
+		case Event::Type::WINDOW_RESIZE_MODAL:
+			EventQueue.AddEvent(WindowResizeModal_Event(static_cast<WindowModal_Event::Mode>(Record.Value)));
+			break;
+
+		case Event::Type::WINDOW_CLOSE:
+			EventQueue.AddEvent(WindowClose_Event());
+			break;
+
+		case Event::Type::FLOATING_TOGGLE:
+			EventQueue.AddEvent(FloatingToggle_Event());
+			break;
+
+		case Event::Type::FLOATING_RAISE:
+			EventQueue.AddEvent(FloatingRaise_Event());
+			break;
+
+		case Event::Type::SWITCH_TABBED:
+			EventQueue.AddEvent(SwitchTabbed_Event());
+			break;
+
+		case Event::Type::FOCUS_CYCLE:
+			EventQueue.AddEvent(FocusCycle_Event(static_cast<FocusCycle_Event::Direction>(Record.Value)));
+			break;
+
+		case Event::Type::LEVEL_TOGGLE:
+			EventQueue.AddEvent(LevelToggle_Event(static_cast<LevelToggle_Event::Mode>(Record.Value)));
+			break;
+
+		case Event::Type::LAYOUT_CYCLE:
+			EventQueue.AddEvent(LayoutCycle_Event(static_cast<LayoutCycle_Event::Direction>(Record.Value)));
+			break;
+
+		case Event::Type::SPAWN_COMMAND:
+			// Don't start programs on a display that isn't there
+			Skipped = true;
+			break;
+
+		case Event::Type::FULLSCREEN_TOGGLE:
+			EventQueue.AddEvent(FullscreenToggle_Event());
+			break;
+
+		case Event::Type::TAG_DISPLAY:
+			EventQueue.AddEvent(TagDisplay_Event(Record.Flags & FlightRecorder::TAG_CLIENT ? TagDisplay_Event::Target::CLIENT : TagDisplay_Event::Target::ROOT,
+												 Record.Flags & FlightRecorder::TAG_TOGGLE ? TagDisplay_Event::Mode::TOGGLE : TagDisplay_Event::Mode::SET,
+												 Record.Value));
+			break;
+
+		case Event::Type::MANAGER_QUIT:
+			ReplayedCount++;
+			EventQueue.AddEvent(ManagerQuit_Event());
+			return;
+
+		default:
+			Skipped = true;
+		}
+
+		if (Skipped)
+			SkippedCount++;
+		else
+			ReplayedCount++;
+	}
+
+	EventQueue.AddEvent(ManagerQuit_Event());
+}
+
+
+int main(int argc, char *argv[])
+{
+	bool RealTime = false;
+	char const *InputPath = nullptr;
+	char const *OutputPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--real-time") == 0)
+			RealTime = true;
+		else if (InputPath == nullptr)
+			InputPath = argv[i];
+		else
+			OutputPath = argv[i];
+	}
+
+	if (InputPath == nullptr)
+	{
+		LOG_INFO_NOHEADER << "Usage: " << argv[0] << " [--real-time] <recording> [output recording]" << std::endl;
+		LOG_INFO_NOHEADER << "  --real-time  Keep the recorded time between events, instead of replaying as fast as possible" << std::endl;
+		return 1;
+	}
+
+	std::vector<FlightRecorder::Record> Records;
+	if (!FlightRecorder::Read(InputPath, Records))
+	{
+		LOG_FATAL << "Could not read the recording \"" << InputPath << "\"!" << std::endl;
+		return 1;
+	}
+
+	// As in glass-wm, SIGUSR1 dumps the window manager's latencies
+	sigset_t BlockedSignals;
+	sigemptyset(&BlockedSignals);
+	sigaddset(&BlockedSignals, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &BlockedSignals, nullptr);
+
+	Glass::EventQueue EventQueue;
+
+	// Record the replay too, so its handling times can be compared with the original's
+	Glass::FlightRecorder *FlightRecorder = nullptr;
+	if (OutputPath != nullptr)
+	{
+		FlightRecorder = new Glass::FlightRecorder(OutputPath, Records.size() + 1);
+		EventQueue.SetRecorder(FlightRecorder);
+	}
+
+	Glass::Dummy_DisplayServer *DisplayServer = new Glass::Dummy_DisplayServer(EventQueue);
+	Glass::Dynamic_WindowManager *WindowManager = new Glass::Dynamic_WindowManager(*DisplayServer, EventQueue);
+
+	size_t ReplayedCount = 0;
+	size_t SkippedCount = 0;
+
+	auto const Start = std::chrono::steady_clock::now();
+
+	std::thread ReplayThread(Replay, std::cref(Records), std::ref(*DisplayServer), std::ref(EventQueue), RealTime,
+							 std::ref(ReplayedCount), std::ref(SkippedCount));
+
+	WindowManager->Run();
+	ReplayThread.join();
+
+	auto const Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start);
+
+	LOG_INFO << "Replayed " << ReplayedCount << " events in " << Elapsed.count() / 1000.0 << " ms, skipping " << SkippedCount << std::endl;
+
+	WindowManager->DumpLatencies(LOG_INFO_NOHEADER);
+
+	delete WindowManager;
+	delete DisplayServer;
+
+	EventQueue.SetRecorder(nullptr);
+	delete FlightRecorder;
+
+	return 0;
+}
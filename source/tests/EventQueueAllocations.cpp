@@ -0,0 +1,101 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "glass/core/Event.hpp"
+#include "glass/core/EventQueue.hpp"
+
+using namespace Glass;
+
+// Every allocation in the program goes through here, so the test can tell whether a stretch of code allocated
+static std::atomic<unsigned long> Allocations(0);
+
+
+void *operator new(std::size_t Size)
+{
+	Allocations++;
+
+	if (void * const Memory = std::malloc(Size != 0 ? Size : 1))
+		return Memory;
+
+	throw std::bad_alloc();
+}
+
+
+void operator delete(void *Memory) noexcept
+{
+	std::free(Memory);
+}
+
+
+bool Check(bool Condition, char const *Description)
+{
+	std::cout << (Condition ? "ok      " : "FAILED  ") << Description << std::endl;
+
+	return Condition;
+}
+
+
+int main()
+{
+	EventQueue Queue;
+	std::vector<EventRecord> Events(64);
+
+	// Events holding shared values allocate once, when they're made, just like the input bindings in the configuration
+	EventRecord const Command = SpawnCommand_Event({ "xterm", "-e", "top" });
+	std::shared_ptr<std::vector<std::string> const> const &CommandValue = static_cast<SpawnCommand_Event const &>(*Command).Command;
+
+	// Let the queue settle, in case anything it uses allocates the first time
+	Queue.AddEvent(PointerMove_Event(Vector(0, 0)));
+	Queue.DrainEvents(Events.data(), Events.size());
+
+	unsigned long const Before = Allocations;
+
+	for (int Round = 0; Round < 10000; Round++)
+	{
+		Queue.AddEvent(PointerMove_Event(Vector(Round % 1000, Round % 700)));
+		Queue.AddEvent(PointerMove_Event(Vector(Round % 900, Round % 600)));
+		Queue.AddEvent(FocusCycle_Event(FocusCycle_Event::Direction::RIGHT));
+		Queue.AddEvent(TagDisplay_Event(TagDisplay_Event::Target::ROOT, TagDisplay_Event::Mode::SET, 1 << (Round % 9)));
+		Queue.AddEvent(Command);
+
+		Queue.DrainEvents(Events.data(), Events.size());
+	}
+
+	unsigned long const During = Allocations - Before;
+
+	bool Passed = true;
+	Passed &= Check(During == 0, "Adding and draining events doesn't allocate");
+
+	// Once drained, the queue must not keep shared values alive
+	for (auto &Event : Events)
+		Event = EventRecord();
+
+	Passed &= Check(CommandValue.use_count() == 1, "Shared event values are released once every record holding them is gone");
+
+	if (!Passed)
+		std::cout << During << " allocations while queueing" << std::endl;
+
+	return Passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
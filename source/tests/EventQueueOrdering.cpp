@@ -0,0 +1,102 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "glass/core/Event.hpp"
+#include "glass/core/EventQueue.hpp"
+#include "glass/displayserver/Dummy_DisplayServer.hpp"
+
+using namespace Glass;
+
+bool Check(bool Condition, char const *Description)
+{
+	std::cout << (Condition ? "ok      " : "FAILED  ") << Description << std::endl;
+
+	return Condition;
+}
+
+
+// Drains the queue and returns the types of the events, in the order they came out
+std::vector<Event::Type> Drain(EventQueue &Queue)
+{
+	std::vector<Event::Type> Types;
+	EventRecord Event;
+
+	while (Queue.PollForEvent(Event))
+		Types.push_back(Event->GetType());
+
+	return Types;
+}
+
+
+int main()
+{
+	EventQueue Queue;
+	Dummy_DisplayServer DisplayServer(Queue);
+
+	RootWindow &Root = *DisplayServer.CreateRootWindow(Vector(0, 0), Vector(1920, 1080));
+	ClientWindow &Client = *DisplayServer.CreateClientWindow("Client", ClientWindow::Type::NORMAL, Vector(0, 0), Vector(100, 100),
+															 false, false, nullptr, true);
+
+	bool Passed = true;
+
+	// A later barrier must not hide an earlier one
+	{
+		Queue.AddEvent(WindowEnter_Event(Root, Vector(0, 0)));
+		Queue.AddEvent(FocusCycle_Event(FocusCycle_Event::Direction::RIGHT));
+		Queue.AddEvent(WindowEnter_Event(Client, Vector(0, 0)));
+
+		std::vector<Event::Type> const Expected = { Event::Type::WINDOW_ENTER, Event::Type::FOCUS_CYCLE, Event::Type::WINDOW_ENTER };
+		Passed &= Check(Drain(Queue) == Expected, "Commands wait for the enters queued before them, and only those");
+	}
+
+	// Bookkeeping ahead of a barrier in the normal lane doesn't let a command past it
+	{
+		Queue.AddEvent(PrimaryNameChange_Event(Client, "Renamed"));
+		Queue.AddEvent(WindowEnter_Event(Client, Vector(0, 0)));
+		Queue.AddEvent(WindowClose_Event());
+
+		std::vector<Event::Type> const Expected = { Event::Type::PRIMARY_NAME_CHANGE, Event::Type::WINDOW_ENTER, Event::Type::WINDOW_CLOSE };
+		Passed &= Check(Drain(Queue) == Expected, "Commands wait for enters queued behind other normal events");
+	}
+
+	// Nothing holds up a command with no barrier before it
+	{
+		Queue.AddEvent(ClientUrgencyChange_Event(Client, true));
+		Queue.AddEvent(WindowClose_Event());
+		Queue.AddEvent(ClientCreate_Event(Client));
+
+		std::vector<Event::Type> const Expected = { Event::Type::WINDOW_CLOSE, Event::Type::CLIENT_URGENCY_CHANGE, Event::Type::CLIENT_CREATE };
+		Passed &= Check(Drain(Queue) == Expected, "Commands go ahead of bookkeeping and of later barriers");
+	}
+
+	// A window isn't freed before the events queued ahead of its destruction
+	{
+		Queue.AddEvent(Input_Event(Client, Input(Input::Type::MOUSE, Input::Value::BUTTON_1), Vector(0, 0)));
+		Queue.AddEvent(ClientDestroy_Event(Client));
+
+		std::vector<Event::Type> const Expected = { Event::Type::INPUT, Event::Type::CLIENT_DESTROY };
+		Passed &= Check(Drain(Queue) == Expected, "Destruction doesn't overtake input queued before it");
+	}
+
+	return Passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
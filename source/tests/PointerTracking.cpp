@@ -0,0 +1,148 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string.h> // memset
+
+#include <xcb/xcb.h>
+
+#include "glass/displayserver/x11xcb_displayserver/PointerTracker.hpp"
+
+using namespace Glass;
+
+// Feeds PointerTracker the events the display server and the input listener see around a modal resize, and checks
+// whether GetMousePosition could answer without asking the server
+
+bool Check(bool Condition, char const *Description)
+{
+	std::cout << (Condition ? "ok      " : "FAILED  ") << Description << std::endl;
+
+	return Condition;
+}
+
+
+// Key and button events share a layout
+void NoteInput(uint8_t Type, uint8_t Detail, uint16_t State, int16_t x, int16_t y)
+{
+	xcb_button_press_event_t Event;
+	memset(&Event, 0, sizeof(Event));
+
+	Event.response_type = Type;
+	Event.detail = Detail;
+	Event.state = State;
+	Event.root_x = x;
+	Event.root_y = y;
+
+	PointerTracker::NoteInput((xcb_generic_event_t const *)&Event);
+}
+
+
+// What GetMousePosition would answer, or false if it would have to query the server
+bool Answer(Vector &Position)
+{
+	Position = PointerTracker::GetPosition();
+
+	return PointerTracker::IsTrusted();
+}
+
+
+int main()
+{
+	bool Passed = true;
+
+	// The default setup: the input listener grabs the modifier and button, with the pointer over a client in its frame
+	{
+		size_t const Resizes = 100;
+		size_t Fallbacks = 0;
+		bool Positioned = true;
+
+		for (size_t Resize = 0; Resize < Resizes; Resize++)
+		{
+			int16_t const x = 100 + Resize;
+			int16_t const y = 200 + Resize;
+
+			// Display server: the pointer crosses into the frame and straight on into the client
+			PointerTracker::Set(x - 10, y - 10, false);
+
+			// Input listener: the press starts the grab.  Display server: the grab takes the pointer from our windows.
+			NoteInput(XCB_BUTTON_PRESS, 3, XCB_MOD_MASK_4, x, y);
+			PointerTracker::Untrack();
+
+			// Window manager: the resize starts where the button was pressed
+			Vector Position;
+			if (!Answer(Position))
+				Fallbacks++;
+			else
+				Positioned &= Position == Vector(x, y);
+
+			// Input listener: the drag, then the release ends the grab
+			PointerTracker::Set(x + 50, y + 40);
+			NoteInput(XCB_BUTTON_RELEASE, 3, XCB_MOD_MASK_4 | XCB_BUTTON_MASK_3, x + 50, y + 40);
+
+			// Display server: the pointer comes back into the client, which doesn't report its motion to us
+			PointerTracker::Set(x + 50, y + 40, false);
+		}
+
+		std::cout << "GetMousePosition fell back to the server " << Fallbacks << " times in " << Resizes << " modal resizes" << std::endl;
+
+		Passed &= Check(Fallbacks == 0, "Resizes started by a grabbed button don't query the server");
+		Passed &= Check(Positioned, "They start where the button was pressed");
+		Passed &= Check(!PointerTracker::IsTrusted(), "The position isn't trusted once the grab ends over a client");
+	}
+
+	// The grab lasts until the last button is released
+	{
+		NoteInput(XCB_BUTTON_PRESS, 1, XCB_MOD_MASK_4, 10, 10);
+		NoteInput(XCB_BUTTON_PRESS, 3, XCB_MOD_MASK_4 | XCB_BUTTON_MASK_1, 10, 10);
+		NoteInput(XCB_BUTTON_RELEASE, 1, XCB_MOD_MASK_4 | XCB_BUTTON_MASK_1 | XCB_BUTTON_MASK_3, 20, 20);
+
+		Passed &= Check(PointerTracker::IsTrusted(), "Releasing one of two buttons keeps the grab");
+
+		NoteInput(XCB_BUTTON_RELEASE, 3, XCB_MOD_MASK_4 | XCB_BUTTON_MASK_3, 30, 30);
+
+		Passed &= Check(!PointerTracker::IsTrusted(), "Releasing the last button ends it");
+	}
+
+	// Keys don't grab the pointer, but still say where it is
+	{
+		NoteInput(XCB_KEY_PRESS, 40, XCB_MOD_MASK_4, 50, 60);
+
+		Vector Position;
+		bool const Trusted = Answer(Position);
+
+		Passed &= Check(!Trusted && Position == Vector(50, 60), "A key press updates the position without vouching for it");
+	}
+
+	// Over one of our own windows, its motion keeps the position current
+	{
+		PointerTracker::Set(70, 80, true);
+
+		Vector Position;
+		bool const Trusted = Answer(Position);
+
+		Passed &= Check(Trusted && Position == Vector(70, 80), "A tracked crossing is trusted");
+
+		PointerTracker::Untrack();
+
+		Passed &= Check(!PointerTracker::IsTrusted(), "Another client's grab stops the tracking");
+	}
+
+	return Passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
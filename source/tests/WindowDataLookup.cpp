@@ -0,0 +1,146 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "glass/core/EventQueue.hpp"
+#include "glass/displayserver/Dummy_DisplayServer.hpp"
+#include "glass/displayserver/x11xcb_displayserver/WindowData.hpp"
+
+using namespace Glass;
+
+// Compares WindowDataContainer lookups against the pair of std::maps it replaced, at a few window counts
+
+// Keeps the optimizer from dropping lookups whose results aren't otherwise used
+static WindowData * volatile Sink;
+
+
+template <typename LookupFunction>
+double TimeLookups(size_t Rounds, LookupFunction Lookup)
+{
+	std::chrono::steady_clock::time_point const Start = std::chrono::steady_clock::now();
+
+	for (size_t Round = 0; Round < Rounds; Round++)
+		Lookup(Round);
+
+	std::chrono::steady_clock::time_point const End = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(End - Start).count() / Rounds;
+}
+
+
+// The lookups, each in the way its container does them
+struct ContainerByWindow
+{
+	WindowDataContainer const &Container;
+	std::vector<ClientWindow *> const &Windows;
+
+	void operator()(size_t Round) const { Sink = *this->Container.find(this->Windows[(Round * 7919) % this->Windows.size()]); }
+};
+
+
+struct ContainerByID
+{
+	WindowDataContainer const &Container;
+	std::vector<xcb_window_t> const &IDs;
+
+	void operator()(size_t Round) const { Sink = *this->Container.find(this->IDs[(Round * 7919) % this->IDs.size()]); }
+};
+
+
+struct MapByWindow
+{
+	std::map<Window const *, WindowData *> const &Map;
+	std::vector<ClientWindow *> const &Windows;
+
+	void operator()(size_t Round) const { Sink = this->Map.find(this->Windows[(Round * 7919) % this->Windows.size()])->second; }
+};
+
+
+struct MapByID
+{
+	std::map<xcb_window_t, WindowData *> const &Map;
+	std::vector<xcb_window_t> const &IDs;
+
+	void operator()(size_t Round) const { Sink = this->Map.find(this->IDs[(Round * 7919) % this->IDs.size()])->second; }
+};
+
+
+int main()
+{
+	EventQueue Queue;
+	Dummy_DisplayServer DisplayServer(Queue);
+
+	size_t const Rounds = 4000000;
+	size_t const WindowCounts[] = { 10, 100, 1000 };
+
+	std::cout << "Nanoseconds per lookup" << std::endl;
+	std::cout << std::setw(8) << "Windows" << std::setw(14) << "map/Window" << std::setw(14) << "hash/Window"
+			  << std::setw(14) << "map/ID" << std::setw(14) << "hash/ID" << std::endl;
+
+	for (size_t WindowCount : WindowCounts)
+	{
+		std::vector<ClientWindow *> Windows;
+		std::vector<xcb_window_t> IDs;
+
+		WindowDataContainer Container;
+		std::map<Window const *, WindowData *> WindowToData;
+		std::map<xcb_window_t, WindowData *> IDToData;
+
+		for (size_t Index = 0; Index < WindowCount; Index++)
+		{
+			ClientWindow * const Window = new ClientWindow("", "", ClientWindow::Type::NORMAL, Vector(0, 0), false, false, false, nullptr,
+														   DisplayServer, Vector(0, 0), Vector(100, 100), true);
+
+			// IDs the way the server hands them out, a client's resource base plus a small counter
+			xcb_window_t const ID = 0x00400000 + (Index / 8) * 0x00200000 + (Index % 8) * 7 + 1;
+
+			WindowData * const Data = new ClientWindowData(*Window, ID, 0, false, 0, 0, false);
+
+			Windows.push_back(Window);
+			IDs.push_back(ID);
+
+			Container.push_back(Data);
+			WindowToData[Window] = Data;
+			IDToData[ID] = Data;
+		}
+
+		double const MapWindow = TimeLookups(Rounds, MapByWindow{ WindowToData, Windows });
+		double const HashWindow = TimeLookups(Rounds, ContainerByWindow{ Container, Windows });
+		double const MapID = TimeLookups(Rounds, MapByID{ IDToData, IDs });
+		double const HashID = TimeLookups(Rounds, ContainerByID{ Container, IDs });
+
+		std::cout << std::fixed << std::setprecision(2)
+				  << std::setw(8) << WindowCount << std::setw(14) << MapWindow << std::setw(14) << HashWindow
+				  << std::setw(14) << MapID << std::setw(14) << HashID << std::endl;
+
+		// The container owns the data, so only the windows are left
+		Container.erase(Container.begin(), Container.end());
+
+		for (auto Window : Windows)
+			delete Window;
+	}
+
+	return EXIT_SUCCESS;
+}
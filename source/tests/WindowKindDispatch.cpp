@@ -0,0 +1,225 @@
+/*
+* This file is part of Glass.
+*
+* Glass is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* Glass is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Glass. If not, see <http://www.gnu.org/licenses/>.
+*
+* Copyright 2014-2015 Chris Foster
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "glass/core/EventQueue.hpp"
+#include "glass/displayserver/Dummy_DisplayServer.hpp"
+#include "glass/displayserver/x11xcb_displayserver/WindowData.hpp"
+
+using namespace Glass;
+
+// Times how the X11XCB display server tells its windows apart on the way from a geometry change to the server, before
+// and after the kind tags, with 100 framed clients moved every Sync.  Each window takes three decisions:
+//  - X11XCB_DisplayServer::SetWindowGeometry skips fullscreen clients.
+//  - Implementation::SetWindowGeometry records frames, utility windows and clients differently.
+//  - Sync applies a client's change to its frame as well.  The frames' own changes are dropped in favour of their clients'.
+// The branches are copied from both versions.  Where the code goes on to do the same work either way, or sends requests
+// to the server, it only adds to Work here.
+
+// Keeps the optimizer from dropping work whose results aren't otherwise used
+static unsigned long volatile Sink;
+
+
+unsigned long SetGeometryByCast(Window &Window, WindowData *WindowData)
+{
+	unsigned long Work = 0;
+
+	{
+		ClientWindow * const WindowCast = dynamic_cast<ClientWindow *>(&Window);
+
+		if (WindowCast != nullptr && WindowCast->GetFullscreen() == true)
+			return Work;
+	}
+
+	if (AuxiliaryWindowData * const WindowDataCast = dynamic_cast<AuxiliaryWindowData *>(WindowData))
+	{
+		if (dynamic_cast<FrameWindow *>(&WindowDataCast->Window))
+			Work += WindowDataCast->PrimaryWindowData->ID;
+		else
+			Work += WindowDataCast->ID;
+	}
+	else if (ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData)) // A client is the only other possibility
+		Work += WindowDataCast->ParentID + WindowDataCast->ID;
+
+	return Work;
+}
+
+
+unsigned long SetGeometryByKind(Window &Window, WindowData *WindowData)
+{
+	unsigned long Work = 0;
+
+	if (Window.GetKind() == Window::Kind::CLIENT && static_cast<ClientWindow &>(Window).GetFullscreen() == true)
+		return Work;
+
+	if (WindowData->Kind == Window::Kind::FRAME || WindowData->Kind == Window::Kind::UTILITY)
+	{
+		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData);
+
+		if (WindowDataCast->Kind == Window::Kind::FRAME)
+			Work += WindowDataCast->PrimaryWindowData->ID;
+		else
+			Work += WindowDataCast->ID;
+	}
+	else if (WindowData->Kind == Window::Kind::CLIENT)
+	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		Work += WindowDataCast->ParentID + WindowDataCast->ID;
+	}
+
+	return Work;
+}
+
+
+unsigned long SyncByCast(WindowData *WindowData)
+{
+	unsigned long Work = 0;
+
+	if (ClientWindowData * const WindowDataCast = dynamic_cast<ClientWindowData *>(WindowData))
+	{
+		if (WindowDataCast->ParentID != XCB_NONE)
+			Work += static_cast<AuxiliaryWindowData *>(WindowDataCast->FrameData)->ID;
+		else
+			Work += WindowDataCast->ID;
+	}
+	else if (AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData))
+	{
+		if (WindowDataCast->Window.GetKind() == Window::Kind::FRAME)
+			Work += static_cast<ClientWindowData *>(WindowDataCast->PrimaryWindowData)->ParentID;
+		else
+			Work += WindowDataCast->RootID;
+	}
+
+	return Work;
+}
+
+
+unsigned long SyncByKind(WindowData *WindowData)
+{
+	unsigned long Work = 0;
+
+	if (WindowData->Kind == Window::Kind::CLIENT)
+	{
+		ClientWindowData * const WindowDataCast = static_cast<ClientWindowData *>(WindowData);
+
+		if (WindowDataCast->ParentID != XCB_NONE)
+			Work += static_cast<AuxiliaryWindowData *>(WindowDataCast->FrameData)->ID;
+		else
+			Work += WindowDataCast->ID;
+	}
+	else if (WindowData->Kind == Window::Kind::FRAME || WindowData->Kind == Window::Kind::UTILITY)
+	{
+		AuxiliaryWindowData * const WindowDataCast = static_cast<AuxiliaryWindowData *>(WindowData);
+
+		if (WindowDataCast->Kind == Window::Kind::FRAME)
+			Work += static_cast<ClientWindowData *>(WindowDataCast->PrimaryWindowData)->ParentID;
+		else
+			Work += WindowDataCast->RootID;
+	}
+
+	return Work;
+}
+
+
+struct Moved
+{
+	Glass::Window	*Window;
+	WindowData	*Data;
+};
+
+
+double TimeSyncs(size_t Rounds, std::vector<Moved> const &Moves, std::vector<WindowData *> const &Changes,
+				 unsigned long (*SetGeometry)(Window &, WindowData *), unsigned long (*Sync)(WindowData *))
+{
+	std::chrono::steady_clock::time_point const Start = std::chrono::steady_clock::now();
+
+	for (size_t Round = 0; Round < Rounds; Round++)
+	{
+		unsigned long Work = 0;
+
+		for (auto const &Move : Moves)
+			Work += SetGeometry(*Move.Window, Move.Data);
+
+		for (auto Data : Changes)
+			Work += Sync(Data);
+
+		Sink = Work;
+	}
+
+	std::chrono::steady_clock::time_point const End = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(End - Start).count() / Rounds;
+}
+
+
+int main()
+{
+	EventQueue Queue;
+	Dummy_DisplayServer DisplayServer(Queue);
+
+	size_t const ClientCount = 100;
+	size_t const Rounds = 200000;
+
+	std::vector<FrameWindow *> Frames;
+	std::vector<WindowData *> Data;
+	std::vector<Moved> Moves;
+	std::vector<WindowData *> Changes;
+
+	for (size_t Index = 0; Index < ClientCount; Index++)
+	{
+		ClientWindow * const Client = DisplayServer.CreateClientWindow("", ClientWindow::Type::NORMAL, Vector(0, 0), Vector(100, 100),
+																	   false, false, nullptr, true);
+		FrameWindow * const Frame = new FrameWindow(*Client, "", DisplayServer, Vector(-2, -20), Vector(2, 2), true);
+
+		ClientWindowData * const ClientData = new ClientWindowData(*Client, 2 * Index + 1, 0, false, 0, 2 * Index + 2, false);
+		AuxiliaryWindowData * const FrameData = new AuxiliaryWindowData(*Frame, 2 * Index + 2, 0, ClientData, 0, XCB_NONE, nullptr, 0, XCB_NONE, "");
+		ClientData->FrameData = FrameData;
+
+		Frames.push_back(Frame);
+		Data.push_back(ClientData);
+		Data.push_back(FrameData);
+
+		// Moving a framed client moves its frame along with it, but only the client's change reaches Sync
+		Moves.push_back({ Client, ClientData });
+		Moves.push_back({ Frame, FrameData });
+		Changes.push_back(ClientData);
+	}
+
+	double const ByCast = TimeSyncs(Rounds, Moves, Changes, SetGeometryByCast, SyncByCast);
+	double const ByKind = TimeSyncs(Rounds, Moves, Changes, SetGeometryByKind, SyncByKind);
+
+	std::cout << "Nanoseconds of window kind dispatch per Sync of " << ClientCount << " moved framed clients" << std::endl;
+	std::cout << std::fixed << std::setprecision(2)
+			  << "  dynamic_cast: " << ByCast << std::endl
+			  << "  kind tag:     " << ByKind << std::endl;
+
+	for (auto WindowData : Data)
+		delete WindowData;
+
+	for (auto Frame : Frames)
+		delete Frame;
+
+	return EXIT_SUCCESS;
+}
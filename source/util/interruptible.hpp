@@ -24,6 +24,8 @@
 #include <exception>
 #include <functional>
 #include <thread>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 class interrupted_exception : public virtual std::exception
 {
@@ -39,26 +41,61 @@ public:
 	template <typename F, typename... A>
 	interruptible(F&& Function, A&&... Arguments) :
 		Interrupted(false),
+		WakeDescriptor(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
 		Thread(
 			[](typename std::decay<F>::type&& Function, typename std::decay<A>::type&&... Arguments,
-			   std::atomic_bool *Interrupted)
+			   std::atomic_bool *Interrupted, int WakeDescriptor)
 			{
 				LocalInterrupted = Interrupted;
+				LocalWakeDescriptor = WakeDescriptor;
 
 				std::function<void(A...)> Callable(Function);
 				Callable(std::move(Arguments)...);
 			},
 			std::forward<F>(Function),
 			std::forward<A>(Arguments)...,
-			&this->Interrupted
+			&this->Interrupted,
+			this->WakeDescriptor
 		)
 	{ }
 
 
-	void interrupt()			{ this->Interrupted = true; }
+	// The thread must have been joined by now
+	~interruptible()
+	{
+		if (this->WakeDescriptor != -1)
+			close(this->WakeDescriptor);
+	}
+
+
+	void interrupt()
+	{
+		this->Interrupted = true;
+
+		// Wake the thread if it's waiting on wake_descriptor()
+		if (this->WakeDescriptor != -1)
+		{
+			uint64_t const Count = 1;
+			ssize_t const Written = write(this->WakeDescriptor, &Count, sizeof(Count));
+			(void)Written;
+		}
+	}
+
 	bool interrupted() const	{ return this->Interrupted; }
 
 
+	// Wakes the thread if it's waiting on wake_descriptor(), without interrupting it.  The thread calls clear_wake() once awake.
+	void wake()
+	{
+		if (this->WakeDescriptor != -1)
+		{
+			uint64_t const Count = 1;
+			ssize_t const Written = write(this->WakeDescriptor, &Count, sizeof(Count));
+			(void)Written;
+		}
+	}
+
+
 	T *operator->()				{ return &this->Thread; }
 
 
@@ -73,14 +110,40 @@ public:
 		throw interrupted_exception();
 	}
 
+
+	// Becomes readable once the calling thread is interrupted, so it can sleep on this and its other descriptors
+	// instead of waking up to check().  -1 outside of an interruptible thread.
+	static inline int wake_descriptor() noexcept
+	{
+		return interruptible::LocalWakeDescriptor;
+	}
+
+
+	// Makes wake_descriptor() unreadable again.  An interrupt is still seen by check().
+	static inline void clear_wake() noexcept
+	{
+		uint64_t Count;
+
+		if (interruptible::LocalWakeDescriptor != -1)
+		{
+			ssize_t const Read = read(interruptible::LocalWakeDescriptor, &Count, sizeof(Count));
+			(void)Read;
+		}
+	}
+
 private:
 	static thread_local std::atomic_bool *LocalInterrupted;
+	static thread_local int				  LocalWakeDescriptor;
 
 	std::atomic_bool	Interrupted;
+	int const			WakeDescriptor;
 	T					Thread;
 };
 
 template <typename T>
 thread_local std::atomic_bool *interruptible<T>::LocalInterrupted = nullptr;
 
+template <typename T>
+thread_local int interruptible<T>::LocalWakeDescriptor = -1;
+
 #endif